@@ -87,6 +87,37 @@ def addCommonOptions(parser):
                       Only used if multiple programs are specified. If true,
                       then the number of threads per cpu is same as the
                       number of programs.""")
+    parser.add_option("--host-profile", action="store_true",
+                      help="""Account host time per SimObject and event type.
+                      The results are written as host_profile stats and as
+                      folded stacks for flamegraph.pl.""")
+    parser.add_option("--stat-sample", type="string", default="",
+                      help="""Comma separated stats to sample into a ring
+                      buffer, a name ending in '*' selects all stats with that
+                      prefix. The samples are written to stat_samples.txt at
+                      exit, and around --injectTime when injecting.""")
+    parser.add_option("--stat-sample-period", type="int", default=1000000,
+                      help="Stat sampling period in ticks")
+    parser.add_option("--stat-sample-capacity", type="int", default=1024,
+                      help="Number of stat samples kept")
+    parser.add_option("--stat-sample-dump", type="string", default="",
+                      help="Comma separated ticks to dump the stat samples at")
+    parser.add_option("--fi-window", type="int", default=0, metavar="CYCLES",
+                      help="""Sample MinorCPU timing stats every cycle and
+                      write their changes in the CYCLES cycles before and after
+                      the fault injection and the first read of the corrupted
+                      register to --fi-window-file""")
+    parser.add_option("--fi-window-file", type="string",
+                      default="fi_window.txt",
+                      help="Output file of --fi-window")
+    parser.add_option("--inst-pb-trace", type="string", default="",
+                      metavar="FILE",
+                      help="""Write the committed instructions to FILE with
+                      InstPBTrace, compressed if FILE ends with .gz""")
+    parser.add_option("--inst-pb-trace-format", type="choice",
+                      default="protobuf", choices=["protobuf", "raw"],
+                      help="""Format of --inst-pb-trace, raw is the fastest
+                      and is decoded by util/decode_inst_trace.py""")
     parser.add_option("--elastic-trace-en", action="store_true",
                       help="""Enable capture of data dependency and instruction
                       fetch traces using elastic trace probe.""")
@@ -158,9 +189,35 @@ def addCommonOptions(parser):
                       help = "Want to correct register data after injection? - Default: No correction")
     parser.add_option("--correctTime", type="int", default="0",
                       help = "Time to correct fault in RF")
+    parser.add_option("--rfParity", action="store_true",
+                      help = "Model parity protection of the register file "
+                      "(rfParity* stats)")
+    parser.add_option("--shadowCheck", action="store_true",
+                      help = "Check MinorCPU commits against a golden shadow "
+                      "from injectTime (shadow* stats)")
+    parser.add_option("--shadowDetectOnly", action="store_true",
+                      help = "End the simulation at the first difference "
+                      "found by the shadow checker")
+    parser.add_option("--dupOpClasses", type="string", default="",
+                      help = "Comma separated op classes (e.g. IntAlu,IntMult)"
+                      " of the instructions MinorCPU duplicates (dup* stats)")
+    parser.add_option("--dupDetectExit", action="store_true",
+                      help = "End the simulation at the first failed "
+                      "duplication check")
+    parser.add_option("--cacheEcc", action="store_true",
+                      help = "Model ECC protection of the caches (ecc_* stats)")
     # JONGHO
     parser.add_option('--injectComp', type='string', default='NO_INJECTION',
                       help='The component you want to inject fault into')
+    parser.add_option("--injectAddr", type="int", default="0",
+                      help = "Start of the physical address range targeted "
+                      "by DMA fault injection (--injectComp=dma)")
+    parser.add_option("--injectLen", type="int", default="0",
+                      help = "Size of the physical address range targeted "
+                      "by DMA fault injection, 0 for any transfer")
+    parser.add_option("--injectMaskedExit", action="store_true",
+                      help = "Stop the simulation once the corrupted DMA "
+                      "data or GPU state is overwritten without being read")
 
     # dist-gem5 options
     parser.add_option("--dist", action="store_true",
@@ -180,10 +237,18 @@ def addCommonOptions(parser):
                       default=2200,
                       action="store", type="int",
                       help="Message server listen port\nDEFAULT: 2200")
+    parser.add_option("--dist-transport", type="choice", default="tcp",
+                      choices=["tcp", "shm"],
+                      help="Message transport among dist-gem5 processes "\
+                      "(shm requires all processes on the same host)\n"\
+                      "DEFAULT: tcp")
     parser.add_option("--dist-sync-repeat",
                       default="0us",
                       action="store", type="string",
                       help="Repeat interval for synchronisation barriers among dist-gem5 processes\nDEFAULT: --ethernet-linkdelay")
+    parser.add_option("--dist-sync-adaptive", action="store_true",
+                      help="Skip dist synchronisation barriers while no "\
+                      "dist-gem5 process can send a packet")
     parser.add_option("--dist-sync-start",
                       default="5200000000000t",
                       action="store", type="string",
@@ -590,6 +590,56 @@ def run(options, root, testsys, cpu_class):
     if options.take_simpoint_checkpoints != None:
         simpoints, interval_length = parseSimpointAnalysisFile(options, testsys)
 
+    if options.host_profile:
+        root.host_profile = True
+
+    if options.stat_sample:
+        dump_ticks = [int(t) for t in options.stat_sample_dump.split(',') if t]
+        # Center the sample history on the fault injection
+        if options.injectTime:
+            dump_ticks.append(options.injectTime + options.stat_sample_period *
+                              options.stat_sample_capacity // 2)
+        root.stat_sampler = StatSampler(
+            stats=options.stat_sample.split(','),
+            period='%dt' % options.stat_sample_period,
+            capacity=options.stat_sample_capacity,
+            dump_ticks=dump_ticks)
+
+    if options.inst_pb_trace:
+        # Committed instruction trace of every CPU, switched ones included,
+        # into a single file. InstPBTrace only records with ExecEnable set.
+        if 'InstPBTrace' not in globals():
+            fatal("--inst-pb-trace needs a gem5 built with protobuf")
+        for obj in testsys.descendants():
+            if isinstance(obj, BaseCPU):
+                obj.tracer = InstPBTrace(
+                    file_name=options.inst_pb_trace,
+                    format=options.inst_pb_trace_format)
+        from m5 import debug
+        debug.flags['ExecEnable'].enable()
+
+    if options.fi_window:
+        # Timing impact of the fault, sampled every cycle from the first
+        # cycle of the window before the injection
+        for c in testsys.cpu:
+            if isinstance(c, MinorCPU):
+                c.timingStats = True
+        cpu = testsys.cpu[0].path()
+        stats = [cpu + '.' + s for s in
+                 ['numCycles', 'committedInsts', 'executeOccupancy',
+                  'lsqOccupancy', 'scoreboardStalls', 'fetchRedirects',
+                  'icache.overall_misses*', 'dcache.overall_misses*']]
+        stats.append(testsys.path() + '.l2.overall_misses*')
+        root.fi_window = StatSampler(
+            stats=stats,
+            period=testsys.cpu_clk_domain.clock[0],
+            capacity=2 * options.fi_window + 1,
+            window=options.fi_window,
+            start=options.injectTime,
+            deltas=True,
+            dump_at_exit=False,
+            output=options.fi_window_file)
+
     checkpoint_dir = None
     if options.checkpoint_restore:
         cpt_starttick, checkpoint_dir = findCptDir(options, cptdir, testsys)
@@ -55,6 +55,8 @@ def build_switch(options):
                                       server_port = options.dist_server_port,
                                       sync_start = options.dist_sync_start,
                                       sync_repeat = options.dist_sync_repeat,
+                                      adaptive_sync = options.dist_sync_adaptive,
+                                      transport = options.dist_transport,
                                       is_switch = True,
                                       num_nodes = options.dist_size)
                        for i in xrange(options.dist_size)]
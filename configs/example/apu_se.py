@@ -131,6 +131,9 @@ parser.add_option("--gpu-voltage", action="store", type="string",
                   help = """CPU  voltage domain""")
 parser.add_option("--CUExecPolicy", type="string", default="OLDEST-FIRST",
                   help="WF exec policy (OLDEST-FIRST, ROUND-ROBIN)")
+parser.add_option("--injectCu", type="int", default=0,
+                  help="CU targeted by GPU fault injection "\
+                  "(--injectComp=vrf|lds|crf)")
 parser.add_option("--xact-cas-mode", action="store_true",
                   help="enable load_compare mode (transactional CAS)")
 parser.add_option("--SegFaultDebug",action="store_true",
@@ -268,6 +271,17 @@ for i in xrange(n_cu):
     compute_units[-1].ldsPort = compute_units[-1].ldsBus.slave
     compute_units[-1].ldsBus.master = compute_units[-1].localDataStore.cuPort
 
+# Fault injection into the vector registers, the LDS or the condition
+# registers of one CU
+if options.injectComp in ("vrf", "lds", "crf"):
+    if options.injectCu >= n_cu:
+        fatal("--injectCu should be smaller than the number of CUs")
+    inj_cu = compute_units[options.injectCu]
+    inj_cu.injectComp = options.injectComp
+    inj_cu.injectTime = options.injectTime
+    inj_cu.injectLoc = options.injectLoc
+    inj_cu.injectMaskedExit = options.injectMaskedExit
+
 # Attach compute units to GPU
 shader.CUs = compute_units
 
@@ -231,6 +231,17 @@ def build_test_system(np):
 
         MemConfig.config_mem(options, test_sys)
 
+    # Fault injection into the DMA transfers of the I/O devices
+    if options.injectComp == "dma":
+        for dev in test_sys.descendants():
+            if isinstance(dev, DmaDevice):
+                dev.injectFaultDma = True
+                dev.injectTime = options.injectTime
+                dev.injectLoc = options.injectLoc
+                dev.injectAddr = options.injectAddr
+                dev.injectLen = options.injectLen
+                dev.injectMaskedExit = options.injectMaskedExit
+
     return test_sys
 
 def build_drive_system(np):
@@ -353,7 +364,9 @@ elif len(bm) == 1 and options.dist:
                         options.dist_sync_start,
                         options.ethernet_linkspeed,
                         options.ethernet_linkdelay,
-                        options.etherdump);
+                        options.etherdump,
+                        options.dist_transport,
+                        options.dist_sync_adaptive);
 elif len(bm) == 1:
     root = Root(full_system=True, system=test_sys)
 else:
@@ -99,6 +99,9 @@ parser.add_option("--progress", type="int", default=100000,
                   metavar="NLOADS",
                   help="Progress message interval "
                   "[default: %default]")
+parser.add_option("--check-threads", type="int", default=0,
+                  help="Threads verifying the responses, 0 verifies them "
+                  "on the simulation thread [default: %default]")
 parser.add_option("--sys-clock", action="store", type="string",
                   default='1GHz',
                   help = """Top-level clock for blocks running at system
@@ -214,7 +217,8 @@ for scale in cachespec[:-1]:
 proto_tester = MemTest(max_loads = options.maxloads,
                        percent_functional = options.functional,
                        percent_uncacheable = options.uncacheable,
-                       progress_interval = options.progress)
+                       progress_interval = options.progress,
+                       check_threads = options.check_threads)
 
 # Set up the system along with a simple memory and reference memory
 system = System(physmem = SimpleMemory(),
@@ -56,6 +56,9 @@ parser.add_option("--progress", type="int", default=1000,
 parser.add_option("--num-dmas", type="int", default=0, help="# of dma testers")
 parser.add_option("--functional", type="int", default=0,
                   help="percentage of accesses that should be functional")
+parser.add_option("--check-threads", type="int", default=0,
+                  help="Threads verifying the responses, 0 verifies them "
+                  "on the simulation thread [default: %default]")
 parser.add_option("--suppress-func-warnings", action="store_true",
                   help="suppress warnings when functional accesses fail")
 
@@ -101,6 +104,7 @@ cpus = [ MemTest(atomic = False,
                  percent_functional = options.functional,
                  percent_uncacheable = 0,
                  progress_interval = options.progress,
+                 check_threads = options.check_threads,
                  suppress_func_warnings = options.suppress_func_warnings) \
          for i in xrange(options.num_cpus) ]
 
@@ -117,6 +121,7 @@ if options.num_dmas > 0:
                      percent_functional = 0,
                      percent_uncacheable = 0,
                      progress_interval = options.progress,
+                     check_threads = options.check_threads,
                      suppress_func_warnings =
                                         not options.suppress_func_warnings) \
              for i in xrange(options.num_dmas) ]
@@ -52,6 +52,9 @@ parser.add_option("--maxloads", metavar="N", default=100,
                   help="Stop after N loads")
 parser.add_option("-f", "--wakeup_freq", metavar="N", default=10,
                   help="Wakeup every N cycles")
+parser.add_option("--check-threads", type="int", default=0,
+                  help="Threads verifying the checks, 0 verifies them on "
+                  "the simulation thread")
 
 #
 # Add the ruby specific and protocol specific options
@@ -90,7 +93,8 @@ if buildEnv['PROTOCOL'] == 'MOESI_hammer':
 
 tester = RubyTester(check_flush = check_flush,
                     checks_to_complete = options.maxloads,
-                    wakeup_frequency = options.wakeup_freq)
+                    wakeup_frequency = options.wakeup_freq,
+                    check_threads = options.check_threads)
 
 #
 # Create the M5 system.  Note that the Memory Object isn't
@@ -267,6 +267,14 @@ for i in xrange(np):
     if options.correctRf == "YES":
         system.cpu[i].correctRf = True
     system.cpu[i].correctTime = options.correctTime
+    system.cpu[i].rfParity = bool(options.rfParity)
+    system.cpu[i].shadowCheck = bool(options.shadowCheck or
+                                     options.shadowDetectOnly)
+    system.cpu[i].shadowDetectOnly = bool(options.shadowDetectOnly)
+    if options.dupOpClasses:
+        system.cpu[i].dupOpClasses = minorMakeOpClassSet(
+            options.dupOpClasses.split(','))
+    system.cpu[i].dupDetectExit = bool(options.dupDetectExit)
 
     system.cpu[i].createThreads()
 
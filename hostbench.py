@@ -0,0 +1,282 @@
+from __future__ import print_function
+
+import argparse
+import json
+import math
+import os
+import random
+import shutil
+import subprocess
+import sys
+
+from run import BENCH_BINARY, BENCH_OPTION, ExpManager
+
+#  Absolute Path to *THIS* Script
+WHERE_AM_I = os.path.dirname(os.path.realpath(__file__))
+
+##
+#  Host-performance benchmarks of the simulator itself.
+#
+#  Every benchmark is run several times for each CPU model and memory
+#  system, and the host throughput (host seconds, MIPS, events/s) is
+#  reported with its variance. Results can be stored as JSON and compared
+#  against an earlier run to catch host-performance regressions.
+#
+
+GEM5_SCRIPT = os.path.abspath(WHERE_AM_I + '/configs/example/se.py')
+
+#  gem5 binaries: Ruby needs a build with the MESI_Two_Level protocol
+GEM5_BINARY = ExpManager.GEM5_BINARY
+GEM5_RUBY_BINARY = os.path.abspath(WHERE_AM_I + '/build/ARM_MESI_Two_Level/gem5.opt')
+
+#  Benchmarks: the regression test program and the MiBench kernels used by
+#  the FI campaigns (see run.py). Missing binaries are skipped.
+BENCHMARKS = dict(BENCH_BINARY)
+BENCHMARKS['test-hello'] = os.path.abspath(WHERE_AM_I + '/tests/test-progs/hello/bin/arm/linux/hello')
+
+DEFAULT_BENCHMARKS = ['test-hello', 'stringsearch', 'qsort', 'bitcount', 'dijkstra']
+
+CPU_TYPES = {
+    'atomic': 'AtomicSimpleCPU',
+    'timing': 'TimingSimpleCPU',
+    'minor': 'MinorCPU',
+    'o3': 'DerivO3CPU'
+}
+
+MEM_SYSTEMS = {
+    'classic': '--caches --l2cache',
+    'ruby': '--ruby',
+    'garnet': '--ruby --garnet-network=fixed --topology=Crossbar'
+}
+
+#  Stats collected from every run
+STATS = ['host_seconds', 'host_inst_rate', 'host_event_rate', 'host_events', 'sim_insts', 'sim_ticks']
+
+
+def read_stats(stats_file):
+    ##
+    #  First dump of the host_* and sim_* stats of a run
+    #
+    stats = {}
+    if not os.path.isfile(stats_file):
+        return stats
+    with open(stats_file, 'r') as stat_read:
+        for line in stat_read:
+            if 'End Simulation Statistics' in line:
+                break
+            words = line.split()
+            if len(words) >= 2 and words[0] in STATS:
+                stats[words[0]] = float(words[1])
+    return stats
+
+
+def summarize(values):
+    ##
+    #  Mean, sample standard deviation and coefficient of variation
+    #
+    n = len(values)
+    if n == 0:
+        return None
+    mean = sum(values) / n
+    stdev = math.sqrt(sum((v - mean) ** 2 for v in values) / (n - 1)) if n > 1 else 0.0
+    return {
+        'n': n,
+        'mean': mean,
+        'stdev': stdev,
+        'cv': stdev / mean if mean else 0.0,
+        'min': min(values),
+        'max': max(values)
+    }
+
+
+def bench_option(bench_name, outdir):
+    option = BENCH_OPTION.get(bench_name, '')
+    if not option:
+        return ''
+    option = str(option).replace('$BENCH_NAME/$COMP_INFO/result_$IDX', os.path.join(outdir, 'result'))
+    return '-o "' + option + '"'
+
+
+def gem5_command(gem5, outdir, bench_name, script_option):
+    gem5_option = ' '.join(['-re', '--outdir=' + outdir])
+    bench = '-c ' + BENCHMARKS[bench_name]
+    output = '--output=' + os.path.join(outdir, 'result_out')
+    return ' '.join([gem5, gem5_option, GEM5_SCRIPT, bench, bench_option(bench_name, outdir), output, script_option])
+
+
+def run_one(gem5, outdir, bench_name, script_option):
+    ##
+    #  One gem5 run, returns its stats (empty if gem5 failed)
+    #
+    if os.path.isdir(outdir):
+        shutil.rmtree(outdir)
+    os.makedirs(outdir)
+    command = gem5_command(gem5, outdir, bench_name, script_option)
+    with open(os.devnull, 'w') as devnull:
+        status = subprocess.call(command, shell=True, stdout=devnull, stderr=devnull)
+    if status != 0:
+        print('  gem5 exited with status %d: %s' % (status, command), file=sys.stderr)
+        return {}
+    return read_stats(os.path.join(outdir, 'stats.txt'))
+
+
+def run_config(args, bench_name, cpu, mem):
+    ##
+    #  Repeated runs of one benchmark/CPU/memory system combination
+    #
+    gem5 = args.ruby_gem5 if mem != 'classic' else args.gem5
+    script_option = ' '.join(['--cpu-type=' + CPU_TYPES[cpu], MEM_SYSTEMS[mem], '-n 1'])
+    if args.maxinsts:
+        script_option += ' -I %d' % args.maxinsts
+
+    samples = {}
+    for i in range(args.warmup + args.repeat):
+        outdir = os.path.join(args.outdir, bench_name, cpu + '-' + mem, str(i))
+        stats = run_one(gem5, outdir, bench_name, script_option)
+        if 'host_seconds' not in stats:
+            return None
+        if i < args.warmup:
+            continue
+        for name, value in stats.items():
+            samples.setdefault(name, []).append(value)
+
+    #  MIPS is derived per run so that its variance is meaningful
+    samples['mips'] = [rate / 1e6 for rate in samples.get('host_inst_rate', [])]
+    return dict((name, summarize(values)) for name, values in samples.items())
+
+
+def run_fi_campaign(args, bench_name):
+    ##
+    #  Short MinorCPU fault injection campaign, measures the host time per
+    #  injection run. Injection times and bits come from a fixed seed so
+    #  that every campaign runs the same experiments.
+    #
+    rng = random.Random(args.seed)
+    script_option = '--cpu-type=MinorCPU --caches -n 1'
+
+    golden_dir = os.path.join(args.outdir, bench_name, 'fi', 'golden')
+    golden = run_one(args.gem5, golden_dir, bench_name, script_option)
+    if 'sim_ticks' not in golden:
+        return None
+
+    runtime = int(golden['sim_ticks'])
+    host_seconds = []
+    for idx in range(args.fi):
+        comp = rng.choice(sorted(ExpManager.BIT_LENGTH))
+        inj_time = rng.randrange(1, runtime)
+        inj_bit = rng.randrange(0, ExpManager.BIT_LENGTH[comp])
+        inj_info = ' '.join(['--injectTime=%d' % inj_time, '--injectLoc=%d' % inj_bit,
+                             '--injectArch=PipeReg', '--injectComp=' + comp,
+                             '-m %d' % (2 * runtime)])
+        outdir = os.path.join(args.outdir, bench_name, 'fi', str(idx))
+        stats = run_one(args.gem5, outdir, bench_name, ' '.join([script_option, inj_info]))
+        #  Runs that crash leave no stats behind and only show up as
+        #  the difference between 'runs' and 'completed'
+        if 'host_seconds' in stats:
+            host_seconds.append(stats['host_seconds'])
+
+    return {
+        'golden_host_seconds': golden['host_seconds'],
+        'runs': args.fi,
+        'completed': len(host_seconds),
+        'host_seconds': summarize(host_seconds)
+    }
+
+
+def report(results, baseline, threshold):
+    ##
+    #  Print a table of the results, flag slowdowns against the baseline.
+    #  Returns the number of regressions.
+    #
+    print('%-14s %-8s %-8s %10s %8s %10s %8s %10s %8s' % (
+        'benchmark', 'cpu', 'mem', 'host_s', 'cv%', 'MIPS', 'cv%', 'events/s', 'cv%'))
+    regressions = 0
+    for key in sorted(results['configs']):
+        r = results['configs'][key]
+        bench_name, cpu, mem = key.split('/')
+        if r is None:
+            print('%-14s %-8s %-8s %10s' % (bench_name, cpu, mem, 'FAILED'))
+            continue
+
+        def col(name, scale=1.0):
+            s = r.get(name)
+            if not s:
+                return '%10s %8s' % ('-', '-')
+            return '%10.3f %8.2f' % (s['mean'] * scale, s['cv'] * 100)
+
+        line = '%-14s %-8s %-8s %s %s %s' % (bench_name, cpu, mem, col('host_seconds'), col('mips'), col('host_event_rate'))
+
+        #  A regression is a slowdown larger than the threshold and larger
+        #  than the noise of both runs
+        base = baseline.get('configs', {}).get(key) if baseline else None
+        if base and base.get('host_seconds'):
+            old = base['host_seconds']
+            new = r['host_seconds']
+            change = new['mean'] / old['mean'] - 1.0
+            noise = 2 * (new['cv'] + old['cv'])
+            line += ' %+7.1f%%' % (change * 100)
+            if change > max(threshold, noise):
+                line += ' REGRESSION'
+                regressions += 1
+        print(line)
+
+    for bench_name, fi in sorted(results.get('fi', {}).items()):
+        if fi is None or not fi['host_seconds']:
+            print('%-14s FI campaign FAILED' % bench_name)
+            continue
+        s = fi['host_seconds']
+        print('%-14s FI campaign: %d/%d runs, %.3f host s/run (cv %.2f%%), golden %.3f host s' % (
+            bench_name, fi['completed'], fi['runs'], s['mean'], s['cv'] * 100, fi['golden_host_seconds']))
+
+    return regressions
+
+
+if __name__ == '__main__':
+    # Argument Format
+    parser = argparse.ArgumentParser(description='Measure the host performance of gem5')
+    parser.add_argument('--gem5', default=GEM5_BINARY, help='gem5 binary for classic memory runs')
+    parser.add_argument('--ruby-gem5', default=GEM5_RUBY_BINARY, help='gem5 binary built with MESI_Two_Level for Ruby and Garnet runs')
+    parser.add_argument('-b', '--bench', nargs='*', default=DEFAULT_BENCHMARKS, choices=sorted(BENCHMARKS), help='Benchmarks to run')
+    parser.add_argument('--cpu', nargs='*', default=sorted(CPU_TYPES), choices=sorted(CPU_TYPES), help='CPU models')
+    parser.add_argument('--mem', nargs='*', default=sorted(MEM_SYSTEMS), choices=sorted(MEM_SYSTEMS), help='Memory systems')
+    parser.add_argument('-r', '--repeat', type=int, default=5, help='Measured runs per configuration')
+    parser.add_argument('-w', '--warmup', type=int, default=1, help='Unmeasured runs per configuration (file cache warmup)')
+    parser.add_argument('-I', '--maxinsts', type=int, default=0, help='Instructions to simulate per run, 0 to run to completion')
+    parser.add_argument('--fi', type=int, default=0, metavar='N', help='Also run an N injection MinorCPU campaign per benchmark')
+    parser.add_argument('--seed', type=int, default=1, help='Seed of the FI campaign')
+    parser.add_argument('-d', '--outdir', default='hostbench', help='Work directory')
+    parser.add_argument('-o', '--output', help='Store the results as JSON')
+    parser.add_argument('--baseline', help='Compare against the JSON results of an earlier run')
+    parser.add_argument('--threshold', type=float, default=0.05, help='Relative slowdown reported as a regression')
+
+    ##
+    #  End parsing & Run benchmarks
+    args = parser.parse_args()
+
+    baseline = None
+    if args.baseline:
+        with open(args.baseline, 'r') as baseline_read:
+            baseline = json.load(baseline_read)
+
+    results = {'configs': {}, 'fi': {}}
+    for bench_name in args.bench:
+        if not os.path.isfile(BENCHMARKS[bench_name]):
+            print('Skipping %s: %s not found' % (bench_name, BENCHMARKS[bench_name]), file=sys.stderr)
+            continue
+        for cpu in args.cpu:
+            for mem in args.mem:
+                #  Ruby doesn't support atomic accesses
+                if mem != 'classic' and cpu == 'atomic':
+                    continue
+                key = '/'.join([bench_name, cpu, mem])
+                print('Running %s...' % key)
+                results['configs'][key] = run_config(args, bench_name, cpu, mem)
+        if args.fi:
+            print('Running %s FI campaign...' % bench_name)
+            results['fi'][bench_name] = run_fi_campaign(args, bench_name)
+
+    if args.output:
+        with open(args.output, 'w') as result_write:
+            json.dump(results, result_write, indent=1, sort_keys=True)
+
+    sys.exit(1 if report(results, baseline, args.threshold) else 0)
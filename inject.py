@@ -121,7 +121,24 @@ class ExpManager:
                             failure = True
                         digest.write('\t' + str(runtime_100) + '%')
 
-            if failure:
+            ##
+            #  Runs stopped early because the injected fault got masked
+            #  (--injectMaskedExit) are non-failures. gem5 also reports
+            #  whether the corrupted data was used at all
+            #
+            masked = False
+            consumed = False
+            simout = outdir + '/' + 'simout_' + str(idx)
+            if os.path.isfile(simout):
+                with open(simout) as simout_read:
+                    simout_text = simout_read.read()
+                    masked = 'because fault masked' in simout_text
+                    consumed = 'Fault consumed' in simout_text
+
+            if masked:
+                digest.write('\tMasked')
+                failure = False
+            elif failure:
                 digest.write('\tSys-halt')
             else:
                 ##
@@ -137,6 +154,9 @@ class ExpManager:
                 else:
                     failure = True
 
+            if consumed:
+                digest.write('(Consumed)')
+
             ##
             #  Log failure as "FF", non-failure as "NF"
             #
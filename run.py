@@ -64,7 +64,58 @@ class ExpManager:
     }
 
     @staticmethod
-    def run_golden(bench_name, flag):
+    def energy(stats_file):
+        ##
+        #  Energy of a run: dynamic and static energy of the top-level
+        #  power models, i.e. those of objects without an ancestor with a
+        #  power model. None if no power model is configured.
+        #
+        energy = {}
+        with open(stats_file, 'r') as stat_read:
+            for line in stat_read:
+                words = line.split()
+                if len(words) < 2:
+                    continue
+                m = re.match(r'(.*)\.power_model\.(dynamic|static)_energy$', words[0])
+                if m:
+                    # The last dump wins
+                    energy[m.groups()] = float(words[1])
+        if not energy:
+            return None
+        objs = set(obj for obj, kind in energy)
+        return sum(value for (obj, kind), value in energy.items()
+                   if not any(obj.startswith(other + '.') for other in objs))
+
+    @staticmethod
+    def detected(stats_file):
+        ##
+        #  Was the fault detected by the duplication checks (or the shadow
+        #  checker) of a run? None if the run left no stats.
+        #
+        if not os.path.isfile(stats_file):
+            return None
+        with open(stats_file, 'r') as stat_read:
+            for line in stat_read:
+                words = line.split()
+                if len(words) >= 2 and re.match(r'.*\.(dup|shadow)Detections$', words[0]):
+                    if float(words[1]) > 0:
+                        return True
+        return False
+
+    @staticmethod
+    def dup_option(dup):
+        #  Instruction duplication: comma separated op classes, '' for none
+        return '--dupOpClasses=' + dup if dup else ''
+
+    @staticmethod
+    def window_option(window, idx):
+        #  Timing stats around the injection, one record per run
+        if not window:
+            return ''
+        return ' '.join(['--fi-window=' + str(window), '--fi-window-file=fi_window_' + str(idx)])
+
+    @staticmethod
+    def run_golden(bench_name, flag, dup=''):
         #  gem5 option
         redirection = '-re'
         outdir = '--outdir=' + bench_name + '/golden'
@@ -89,14 +140,14 @@ class ExpManager:
             bench_option = bench_option.replace('$COMP_INFO', 'golden')
 
         output = '--output=' + bench_name + '/golden/result_golden'
-        gem5_script_option = ' '.join([env, bench_binary, bench_option, output])
+        gem5_script_option = ' '.join([env, bench_binary, bench_option, output, ExpManager.dup_option(dup)])
 
         #  gem5 command
         gem5_command = ' '.join([ExpManager.GEM5_BINARY, gem5_option, ExpManager.GEM5_SCRIPT, gem5_script_option])
         subprocess.call(gem5_command, shell=True)
 
     @staticmethod
-    def inject_single(inj_time, inj_bit, inj_comp1, inj_comp2, idx=0, bench_name='stringsearch', flag=['FI']):
+    def inject_single(inj_time, inj_bit, inj_comp1, inj_comp2, idx=0, bench_name='stringsearch', flag=['FI'], dup='', window=0):
         ##
         #  One fault injected per each experiment
         #
@@ -134,14 +185,15 @@ class ExpManager:
         injectComp = '--injectComp=' + inj_comp2
         runtime_limit = ' '.join(['-m', str(2 * GOLDEN_RUNTIME[bench_name])])
         inj_info = ' '.join([injectTime, injectLoc, injectArch, injectComp, runtime_limit])
-        gem5_script_option = ' '.join([env, bench_binary, bench_option, output, inj_info])
+        gem5_script_option = ' '.join([env, bench_binary, bench_option, output, inj_info, ExpManager.dup_option(dup),
+                                       ExpManager.window_option(window, idx)])
 
         #  gem5 command
         gem5_command = ' '.join([ExpManager.GEM5_BINARY, gem5_option, ExpManager.GEM5_SCRIPT, gem5_script_option])
         subprocess.call(gem5_command, shell=True)
 
     @staticmethod
-    def inject_random(inj_comp1, inj_comp2, start_idx=1, end_idx=1000, bench_name='stringsearch', flag=['FI']):
+    def inject_random(inj_comp1, inj_comp2, start_idx=1, end_idx=1000, bench_name='stringsearch', flag=['FI'], dup='', window=0):
         runtime = GOLDEN_RUNTIME[bench_name]
 
         #  Digest - All stat & log files are too large to store
@@ -151,9 +203,16 @@ class ExpManager:
         digest = open(bench_name + '/' + 'digest_' + exp_info + '.txt', 'w')
 
         #  Write headline of digest
-        digest.write('\t'.join(['exp#', 'time', 'bit', 'F/NF', 'comp2', 'runtime', 'benchmark', 'exec?', 'actual?', 'etc']) + '\n')
+        digest.write('\t'.join(['exp#', 'time', 'bit', 'F/NF', 'comp2', 'runtime', 'benchmark', 'exec?', 'actual?', 'energy(J)', 'detected?', 'etc']) + '\n')
         digest.write('-' * 80 + '\n')
 
+        #  Campaign summary
+        num_runs = 0
+        num_failures = 0
+        num_detected_failures = 0
+        num_detected = 0
+        energies = []
+
         #  Iterating several experiments
         for idx in range(int(start_idx), int(end_idx)+1):
             #  Pick random numbers
@@ -161,7 +220,7 @@ class ExpManager:
             rand_bit = str(random.randrange(0, ExpManager.BIT_LENGTH[inj_comp2]))
 
             #  Do single experiment
-            ExpManager.inject_single(rand_time, rand_bit, inj_comp1, inj_comp2, idx, bench_name, flag)
+            ExpManager.inject_single(rand_time, rand_bit, inj_comp1, inj_comp2, idx, bench_name, flag, dup, window)
             
             # <index> <inj time> <inj loc>
             para1 = '\t'.join([str(idx), rand_time, rand_bit])
@@ -174,6 +233,8 @@ class ExpManager:
             failure = True
             outdir = bench_name + '/' + comp_info
             runtime_100 = 'failure'
+            energy = ExpManager.energy(outdir + '/' + 'stats_' + str(idx))
+            detected = ExpManager.detected(outdir + '/' + 'stats_' + str(idx))
             with open(outdir + '/' + 'stats_' + str(idx), 'r') as stat_read:
                 for line in stat_read:
                     pattern = re.compile(r'\s+')
@@ -200,6 +261,16 @@ class ExpManager:
                 # Log non-failure as "NF"
                 isFailure = 'NF'
 
+            num_runs += 1
+            if failure:
+                num_failures += 1
+            if detected:
+                num_detected += 1
+                if failure:
+                    num_detected_failures += 1
+            if energy is not None:
+                energies.append(energy)
+
             ##
             #  Read debug file
             #
@@ -217,11 +288,26 @@ class ExpManager:
                         etc = line.split(':')[-2].split()[-1] + line.split(':')[-1].strip()
                         
             # <F/NF> <stage> <inst> <target> <runtime> <bench name>
-            para2 = '\t'.join([isFailure, inj_comp2, '', runtime_100, bench_name, executed, str(actual_inject), etc])
+            energy_info = '-' if energy is None else '%.6g' % energy
+            detected_info = '-' if detected is None else ('D' if detected else 'ND')
+            para2 = '\t'.join([isFailure, inj_comp2, '', runtime_100, bench_name, executed, str(actual_inject), energy_info, detected_info, etc])
             
             # Write one line to digest file
             digest.write('\t'.join([para1, para2]) + '\n')
 
+        #  Failure rate and energy per run of the whole campaign
+        digest.write('-' * 80 + '\n')
+        if num_runs:
+            digest.write('failure rate:\t%d/%d (%.2f%%)\n' % (num_failures, num_runs, 100.0 * num_failures / num_runs))
+        if dup:
+            #  Detected failures are caught by the hardening, undetected
+            #  ones are silent; detections without failure are benign faults
+            digest.write('detected failures:\t%d/%d\n' % (num_detected_failures, num_failures))
+            digest.write('undetected failures:\t%d/%d\n' % (num_failures - num_detected_failures, num_failures))
+            digest.write('detected non-failures:\t%d/%d\n' % (num_detected - num_detected_failures, num_runs - num_failures))
+        if energies:
+            digest.write('energy per run:\t%.6g J (%d runs with power models)\n' % (sum(energies) / len(energies), len(energies)))
+
         digest.close()
 
 
@@ -234,6 +320,8 @@ if __name__ == '__main__':
     parser.add_argument('-f', '--flag', action='store', nargs='*', help='All gem5 debug flags')
     parser.add_argument('--inject', action='store', nargs=2, help='Injection <time> <location>')
     parser.add_argument('--comp2', action='store', default='f2ToD', help='Injection to: f1ToF2 | f2ToD | dToE | f2ToF1 | eToF1')
+    parser.add_argument('--dup', action='store', default='', help='Duplicate instructions of these comma separated op classes (e.g. IntAlu,IntMult), use the same for the golden run')
+    parser.add_argument('--window', action='store', type=int, default=0, help='Record the timing stats in this many cycles around the injection (fi_window_<exp#>)')
 
     ##
     #  End parsing & Run gem5
@@ -241,9 +329,9 @@ if __name__ == '__main__':
 
     if args.golden:
         # Golden Run
-        ExpManager.run_golden(args.bench_name, args.flag)
+        ExpManager.run_golden(args.bench_name, args.flag, args.dup)
     elif args.inject:
         # Non-random Fault Injection
-        ExpManager.inject_single(args.inject[0], args.inject[1], 'PipeReg', args.comp2, 'inject', args.bench_name, args.flag)
+        ExpManager.inject_single(args.inject[0], args.inject[1], 'PipeReg', args.comp2, 'inject', args.bench_name, args.flag, args.dup, args.window)
     else:
-        ExpManager.inject_random('PipeReg', args.comp2, args.index[0], args.index[1], args.bench_name, args.flag)
+        ExpManager.inject_random('PipeReg', args.comp2, args.index[0], args.index[1], args.bench_name, args.flag, args.dup, args.window)
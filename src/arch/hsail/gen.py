@@ -277,24 +277,39 @@ $class_name<DataType>::execute(GPUDynInstPtr gpuDynInst)
 
     const VectorMask &mask = w->getPred();
 
+    // Operands are read and written for all lanes at once, as whole
+    // registers, leaving only the computation in the per-lane loop
+    CType dest_lanes[MaxWfSize];
+    CType src_lanes[$num_srcs][MaxWfSize];
+
+    if ($dest_is_src_flag) {
+        this->dest.template getLanes<CType>(w, dest_lanes);
+    }
+
+    for (int i = 0; i < $num_srcs; ++i) {
+        this->src[i].template getLanes<CType>(w, src_lanes[i]);
+    }
+
     for (int lane = 0; lane < w->computeUnit->wfSize(); ++lane) {
         if (mask[lane]) {
             CType dest_val;
             if ($dest_is_src_flag) {
-                dest_val = this->dest.template get<CType>(w, lane);
+                dest_val = dest_lanes[lane];
             }
 
             CType src_val[$num_srcs];
 
             for (int i = 0; i < $num_srcs; ++i) {
-                src_val[i] = this->src[i].template get<CType>(w, lane);
+                src_val[i] = src_lanes[i][lane];
             }
 
             dest_val = (CType)($expr);
 
-            this->dest.set(w, lane, dest_val);
+            dest_lanes[lane] = dest_val;
         }
     }
+
+    this->dest.setLanes(w, dest_lanes, mask);
 }
 
 '''
@@ -401,20 +416,27 @@ $class_name<DestDataType, SrcDataType>::execute(GPUDynInstPtr gpuDynInst)
 
     const VectorMask &mask = w->getPred();
 
+    // Access the operands of all lanes at once, as whole registers
+    DestCType dest_lanes[MaxWfSize];
+    SrcCType src_lanes[$num_srcs][MaxWfSize];
+
+    for (int i = 0; i < $num_srcs; ++i) {
+        this->src[i].template getLanes<SrcCType>(w, src_lanes[i]);
+    }
+
     for (int lane = 0; lane < w->computeUnit->wfSize(); ++lane) {
         if (mask[lane]) {
-            DestCType dest_val;
             SrcCType src_val[$num_srcs];
 
             for (int i = 0; i < $num_srcs; ++i) {
-                src_val[i] = this->src[i].template get<SrcCType>(w, lane);
+                src_val[i] = src_lanes[i][lane];
             }
 
-            dest_val = $expr;
-
-            this->dest.set(w, lane, dest_val);
+            dest_lanes[lane] = $expr;
         }
     }
+
+    this->dest.setLanes(w, dest_lanes, mask);
 }
 
 '''
@@ -42,8 +42,10 @@
  *  Defines classes encapsulating HSAIL instruction operands.
  */
 
+#include <algorithm>
 #include <limits>
 #include <string>
+#include <type_traits>
 
 #include "arch/hsail/Brig.h"
 #include "base/trace.hh"
@@ -185,6 +187,28 @@ class SRegOperand : public BaseRegOperand
         return (OperandType)ret;
     }
 
+    // Read the operand of all lanes at once, see get()
+    template<typename OperandType>
+    void
+    getLanes(Wavefront *w, OperandType *vals)
+    {
+        assert(sizeof(OperandType) <= sizeof(uint32_t));
+        assert(regIdx < w->maxSpVgprs);
+        uint32_t vgprIdx = w->remap(regIdx, sizeof(OperandType), 1);
+        VectorRegisterFile *vrf = w->computeUnit->vrf[w->simdId];
+
+        if (sizeof(OperandType) == sizeof(uint32_t)) {
+            vrf->readLanes<OperandType>(vgprIdx, vals);
+        } else {
+            // if OperandType is smaller than 32-bit, we truncate the value
+            uint32_t regs[MaxWfSize];
+            vrf->readLanes<uint32_t>(vgprIdx, regs);
+            for (int lane = 0; lane < w->computeUnit->wfSize(); ++lane) {
+                vals[lane] = (OperandType)regs[lane];
+            }
+        }
+    }
+
     // special get method for compatibility with LabelOperand
     uint32_t
     getTarget(Wavefront *w, int lane)
@@ -194,6 +218,40 @@ class SRegOperand : public BaseRegOperand
 
     template<typename OperandType>
     void set(Wavefront *w, int lane, OperandType &val);
+
+    // Write the operand of the lanes set in mask at once, see set()
+    template<typename OperandType>
+    void
+    setLanes(Wavefront *w, const OperandType *vals, const VectorMask &mask)
+    {
+        if (DTRACE(GPUReg)) {
+            for (int lane = 0; lane < w->computeUnit->wfSize(); ++lane) {
+                if (mask[lane]) {
+                    DPRINTF(GPUReg, "CU%d, WF[%d][%d], lane %d: $s%d <- %d\n",
+                            w->computeUnit->cu_id, w->simdId, w->wfSlotId,
+                            lane, regIdx, vals[lane]);
+                }
+            }
+        }
+
+        assert(sizeof(OperandType) == sizeof(uint32_t) ||
+               (std::is_same<OperandType, uint64_t>::value));
+        assert(regIdx < w->maxSpVgprs);
+        uint32_t vgprIdx = w->remap(regIdx, sizeof(uint32_t), 1);
+        VectorRegisterFile *vrf = w->computeUnit->vrf[w->simdId];
+
+        if (sizeof(OperandType) == sizeof(uint32_t)) {
+            vrf->writeLanes<OperandType>(vgprIdx, vals, mask);
+        } else {
+            // 64-bit values are truncated to the 32-bit register
+            uint32_t regs[MaxWfSize];
+            for (int lane = 0; lane < w->computeUnit->wfSize(); ++lane) {
+                regs[lane] = (uint32_t)vals[lane];
+            }
+            vrf->writeLanes<uint32_t>(vgprIdx, regs, mask);
+        }
+    }
+
     std::string disassemble();
 };
 
@@ -268,6 +326,19 @@ class DRegOperand : public BaseRegOperand
         return w->computeUnit->vrf[w->simdId]->read<OperandType>(vgprIdx,lane);
     }
 
+    // Read the operand of all lanes at once, see get()
+    template<typename OperandType>
+    void
+    getLanes(Wavefront *w, OperandType *vals)
+    {
+        assert(sizeof(OperandType) <= sizeof(uint64_t));
+        // TODO: this check is valid only for HSAIL
+        assert(regIdx < w->maxDpVgprs);
+        uint32_t vgprIdx = w->remap(regIdx, sizeof(OperandType), 1);
+
+        w->computeUnit->vrf[w->simdId]->readLanes<OperandType>(vgprIdx, vals);
+    }
+
     template<typename OperandType>
     void
     set(Wavefront *w, int lane, OperandType &val)
@@ -283,6 +354,29 @@ class DRegOperand : public BaseRegOperand
         w->computeUnit->vrf[w->simdId]->write<OperandType>(vgprIdx,val,lane);
     }
 
+    // Write the operand of the lanes set in mask at once, see set()
+    template<typename OperandType>
+    void
+    setLanes(Wavefront *w, const OperandType *vals, const VectorMask &mask)
+    {
+        if (DTRACE(GPUReg)) {
+            for (int lane = 0; lane < w->computeUnit->wfSize(); ++lane) {
+                if (mask[lane]) {
+                    DPRINTF(GPUReg, "CU%d, WF[%d][%d], lane %d: $d%d <- %d\n",
+                            w->computeUnit->cu_id, w->simdId, w->wfSlotId,
+                            lane, regIdx, vals[lane]);
+                }
+            }
+        }
+
+        assert(sizeof(OperandType) <= sizeof(uint64_t));
+        // TODO: this check is valid only for HSAIL
+        assert(regIdx < w->maxDpVgprs);
+        uint32_t vgprIdx = w->remap(regIdx, sizeof(OperandType), 1);
+        w->computeUnit->vrf[w->simdId]->writeLanes<OperandType>(vgprIdx, vals,
+                                                                mask);
+    }
+
     std::string disassemble();
 };
 
@@ -341,6 +435,30 @@ class CRegOperand : public BaseRegOperand
         w->condRegState->write<OperandType>(regIdx,lane,val);
     }
 
+    // Condition registers are bit vectors, so there is no benefit in
+    // accessing all lanes at once; these are provided for use by the
+    // same instruction templates as the vector register operands
+    template<typename OperandType>
+    void
+    getLanes(Wavefront *w, OperandType *vals)
+    {
+        for (int lane = 0; lane < w->computeUnit->wfSize(); ++lane) {
+            vals[lane] = get<OperandType>(w, lane);
+        }
+    }
+
+    template<typename OperandType>
+    void
+    setLanes(Wavefront *w, const OperandType *vals, const VectorMask &mask)
+    {
+        for (int lane = 0; lane < w->computeUnit->wfSize(); ++lane) {
+            if (mask[lane]) {
+                OperandType val = vals[lane];
+                set(w, lane, val);
+            }
+        }
+    }
+
     std::string disassemble();
 };
 
@@ -383,6 +501,15 @@ class ImmOperand : public BaseOperand
     {
         return get<OperandType>(w);
     }
+
+    // Broadcast the immediate to all lanes
+    template<typename OperandType>
+    void
+    getLanes(Wavefront *w, OperandType *vals)
+    {
+        std::fill(vals, vals + w->computeUnit->wfSize(),
+                  get<OperandType>(w));
+    }
 };
 
 template<typename T>
@@ -477,6 +604,17 @@ class RegOrImmOperand : public BaseOperand
                          reg_op.template get<OperandType>(w, lane);
     }
 
+    template<typename OperandType>
+    void
+    getLanes(Wavefront *w, OperandType *vals)
+    {
+        if (is_imm) {
+            imm_op.template getLanes<OperandType>(w, vals);
+        } else {
+            reg_op.template getLanes<OperandType>(w, vals);
+        }
+    }
+
     uint32_t
     opSize()
     {
@@ -0,0 +1,205 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_ASYNC_CHECKER_HH__
+#define __BASE_ASYNC_CHECKER_HH__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/misc.hh"
+
+/**
+ * Validate records on helper threads instead of the simulation thread.
+ *
+ * Each record is routed by a key (e.g. its address) to one of the
+ * workers. Every worker consumes its own lock-free single-producer
+ * single-consumer ring, so the records of a key are checked in the order
+ * they were pushed, and any state sharded by worker (e.g. a reference
+ * model) needs no locking.
+ *
+ * The check function returns an empty string for a good record and an
+ * error message otherwise. Only the first error is kept. The simulation
+ * thread polls failed() to fail fast, and calls flush() before declaring
+ * a test passed.
+ */
+template <class Record>
+class AsyncChecker
+{
+  public:
+    /** Check a record on the worker of a shard, "" if it is good */
+    typedef std::function<std::string(unsigned, const Record &)> CheckFunc;
+
+    AsyncChecker(unsigned num_shards, CheckFunc check_func,
+                 unsigned ring_size = 1 << 16)
+        : checkFunc(check_func), ringMask(ring_size - 1),
+          failedFlag(false), stop(false)
+    {
+        fatal_if(!num_shards, "an AsyncChecker needs at least one worker");
+        fatal_if(ring_size & ringMask, "ring size must be a power of 2");
+
+        for (unsigned i = 0; i < num_shards; ++i) {
+            shards.emplace_back(new Shard(ring_size));
+        }
+        for (unsigned i = 0; i < num_shards; ++i) {
+            shards[i]->thread = std::thread(&AsyncChecker::work, this, i);
+        }
+    }
+
+    /** Check everything still queued, then stop the workers */
+    ~AsyncChecker()
+    {
+        stop.store(true, std::memory_order_release);
+        for (auto &shard : shards) {
+            shard->thread.join();
+        }
+    }
+
+    unsigned numShards() const { return shards.size(); }
+
+    /** The shard checking the records of a key */
+    unsigned
+    shardOf(uint64_t key) const
+    {
+        // Fibonacci hashing spreads strided keys over the workers
+        return ((key * 0x9e3779b97f4a7c15ULL) >> 32) % shards.size();
+    }
+
+    /** Queue a record, waits while the ring of its worker is full */
+    void
+    push(uint64_t key, const Record &record)
+    {
+        Shard &shard = *shards[shardOf(key)];
+        const uint64_t tail = shard.tail.load(std::memory_order_relaxed);
+
+        while (tail - shard.head.load(std::memory_order_acquire) > ringMask)
+            std::this_thread::yield();
+
+        shard.ring[tail & ringMask] = record;
+        shard.tail.store(tail + 1, std::memory_order_release);
+    }
+
+    /** Wait until all the queued records are checked */
+    void
+    flush()
+    {
+        for (auto &shard : shards) {
+            const uint64_t tail = shard->tail.load(std::memory_order_relaxed);
+            while (shard->head.load(std::memory_order_acquire) != tail)
+                std::this_thread::yield();
+        }
+    }
+
+    bool
+    failed() const
+    {
+        return failedFlag.load(std::memory_order_acquire);
+    }
+
+    /** The message of the first failed check, valid once failed() */
+    const std::string &error() const { return firstError; }
+
+  private:
+    struct Shard
+    {
+        Shard(unsigned ring_size)
+            : ring(ring_size), head(0), tail(0)
+        { }
+
+        std::vector<Record> ring;
+        /**
+         * Next record to check, only written by the worker. The
+         * counters are padded apart by hand rather than with alignas,
+         * new does not honour over-alignment before C++17.
+         */
+        std::atomic<uint64_t> head;
+        char headPad[64 - sizeof(std::atomic<uint64_t>)];
+        /** Next free slot, only written by the simulation thread */
+        std::atomic<uint64_t> tail;
+        char tailPad[64 - sizeof(std::atomic<uint64_t>)];
+        std::thread thread;
+    };
+
+    void
+    work(unsigned idx)
+    {
+        Shard &shard = *shards[idx];
+        unsigned idle = 0;
+
+        while (true) {
+            const uint64_t head = shard.head.load(std::memory_order_relaxed);
+            if (head == shard.tail.load(std::memory_order_acquire)) {
+                // Only leave once the ring is drained
+                if (stop.load(std::memory_order_acquire) &&
+                    head == shard.tail.load(std::memory_order_acquire)) {
+                    return;
+                }
+                // Back off while there is no work, sleeping only after
+                // a while so that bursts are picked up quickly
+                if (++idle < 1024) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(
+                        std::chrono::microseconds(50));
+                }
+                continue;
+            }
+            idle = 0;
+
+            if (!failed()) {
+                const Record &record = shard.ring[head & ringMask];
+                std::string error = checkFunc(idx, record);
+                if (!error.empty()) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!failed()) {
+                        firstError = error;
+                        failedFlag.store(true, std::memory_order_release);
+                    }
+                }
+            }
+            shard.head.store(head + 1, std::memory_order_release);
+        }
+    }
+
+    const CheckFunc checkFunc;
+    const uint64_t ringMask;
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    std::atomic<bool> failedFlag;
+    std::mutex errorMutex;
+    std::string firstError;
+
+    std::atomic<bool> stop;
+};
+
+#endif // __BASE_ASYNC_CHECKER_HH__
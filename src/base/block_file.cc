@@ -0,0 +1,142 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/block_file.hh"
+
+namespace
+{
+
+const uint32_t byteOrder = 0x01020304;
+
+template <class T>
+void
+writeRaw(std::ostream &os, const T &value)
+{
+    os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+}
+
+BlockFile::BlockFile(const std::string &name, const Format &_format,
+    size_t max_pending) :
+    fileName(name),
+    format(_format),
+    maxPending(max_pending),
+    output(simout.create(name, true)),
+    stop(false),
+    offset(0)
+{
+    std::ostream &os = *output->stream();
+    os.write(format.fileMagic, sizeof(format.fileMagic));
+    writeRaw(os, format.version);
+    writeRaw(os, byteOrder);
+    offset = sizeof(format.fileMagic) + sizeof(format.version) +
+        sizeof(byteOrder);
+
+    writer = std::thread(&BlockFile::writeBlocks, this);
+}
+
+BlockFile::~BlockFile()
+{
+    if (output)
+        close();
+}
+
+void
+BlockFile::write(Block &block, size_t reserve_size)
+{
+    if (block.empty())
+        return;
+
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [this] { return pending.size() < maxPending; });
+        pending.push_back(std::move(block));
+    }
+    cond.notify_all();
+
+    block = Block();
+    block.body.reserve(reserve_size);
+}
+
+void
+BlockFile::writeBlocks()
+{
+    std::ostream &os = *output->stream();
+    std::unique_lock<std::mutex> guard(lock);
+
+    while (true) {
+        cond.wait(guard, [this] { return stop || !pending.empty(); });
+        if (pending.empty())
+            break;
+
+        Block block = std::move(pending.front());
+        pending.pop_front();
+        guard.unlock();
+        cond.notify_all();
+
+        IndexEntry entry = { block.firstTick, block.lastTick, offset };
+        index.push_back(entry);
+
+        uint32_t size = block.body.size();
+        uint32_t reserved = 0;
+        writeRaw(os, format.blockMagic);
+        writeRaw(os, size);
+        writeRaw(os, entry.firstTick);
+        writeRaw(os, entry.lastTick);
+        writeRaw(os, block.records);
+        writeRaw(os, reserved);
+        os.write(block.body.data(), size);
+        offset += 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t) + size;
+
+        guard.lock();
+    }
+}
+
+void
+BlockFile::close()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    cond.notify_all();
+    writer.join();
+
+    std::ostream &os = *output->stream();
+    uint64_t index_offset = offset;
+    uint64_t blocks = index.size();
+    writeRaw(os, blocks);
+    for (const auto &entry : index) {
+        writeRaw(os, entry.firstTick);
+        writeRaw(os, entry.lastTick);
+        writeRaw(os, entry.offset);
+    }
+    writeRaw(os, index_offset);
+    os.write(format.indexMagic, sizeof(format.indexMagic));
+
+    simout.close(output);
+    output = NULL;
+}
@@ -0,0 +1,183 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *
+ *  Writer for binary trace files made of self-contained blocks with a
+ *  tick index, for traces that are too big or too slow to write as
+ *  debug output text. The layout (native byte order) is:
+ *
+ *  header:  8 byte file magic, uint32 version, uint32 0x01020304
+ *  block:   uint32 block magic, uint32 body size, uint64 first tick,
+ *           uint64 last tick, uint32 records, uint32 0, body
+ *  index:   uint64 blocks, blocks * (uint64 first tick,
+ *           uint64 last tick, uint64 block offset)
+ *  trailer: uint64 index offset, 8 byte index magic
+ *
+ *  The encoding of the body is up to the user, who should make each
+ *  block decodable on its own so that readers can seek with the
+ *  index. The index is only written by close(), a reader of a file
+ *  from a run that didn't exit cleanly can walk the block headers
+ *  instead.
+ *
+ *  Blocks are written by a helper thread so that the simulation only
+ *  pays for encoding the records.
+ */
+
+#ifndef __BASE_BLOCK_FILE_HH__
+#define __BASE_BLOCK_FILE_HH__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/types.hh"
+
+class BlockFile
+{
+  public:
+    /** Magic numbers and version of a file format */
+    struct Format
+    {
+        char fileMagic[8];
+        uint32_t version;
+        /** Four characters, first one in the low byte */
+        uint32_t blockMagic;
+        char indexMagic[8];
+    };
+
+    /** A block of records being filled by the user */
+    class Block
+    {
+      public:
+        std::vector<char> body;
+        Tick firstTick;
+        Tick lastTick;
+        uint32_t records;
+
+        Block() : firstTick(0), lastTick(0), records(0) { }
+
+        /** Note a record at tick, returns the tick of the previous
+         *  record (tick itself for the first record) */
+        Tick
+        addRecord(Tick tick)
+        {
+            if (records == 0)
+                firstTick = lastTick = tick;
+            Tick last = lastTick;
+            lastTick = tick;
+            records++;
+            return last;
+        }
+
+        /** Append value as a LEB128 varint */
+        void
+        putVarint(uint64_t value)
+        {
+            while (value >= 0x80) {
+                body.push_back(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            body.push_back(static_cast<char>(value));
+        }
+
+        /** Append a varint length and the bytes of a string */
+        void
+        putString(const char *data, size_t size)
+        {
+            putVarint(size);
+            body.insert(body.end(), data, data + size);
+        }
+
+        /** Append the raw bytes of value */
+        template <class T>
+        void
+        putRaw(const T &value)
+        {
+            const char *data = reinterpret_cast<const char *>(&value);
+            body.insert(body.end(), data, data + sizeof(value));
+        }
+
+        bool empty() const { return records == 0; }
+    };
+
+    /**
+     * Create the file in the output directory and start the writer.
+     * @param max_pending Blocks queued for the writer before write()
+     *        waits for it
+     */
+    BlockFile(const std::string &name, const Format &format,
+        size_t max_pending = 16);
+
+    /** Closes the file if close() wasn't called */
+    ~BlockFile();
+
+    const std::string &name() const { return fileName; }
+
+    /**
+     * Queue a block for writing. Its contents are moved to the
+     * writer, block is left empty with capacity reserved for
+     * reserve_size bytes. Empty blocks aren't written.
+     */
+    void write(Block &block, size_t reserve_size = 0);
+
+    /** Wait for the writer and write the index. No writes after this */
+    void close();
+
+  private:
+    struct IndexEntry
+    {
+        uint64_t firstTick;
+        uint64_t lastTick;
+        uint64_t offset;
+    };
+
+    std::string fileName;
+    Format format;
+    size_t maxPending;
+    OutputStream *output;
+
+    /** Blocks to write, protected by lock */
+    std::deque<Block> pending;
+    bool stop;
+    std::mutex lock;
+    std::condition_variable cond;
+    std::thread writer;
+
+    /** Owned by the writer thread until it is joined */
+    std::vector<IndexEntry> index;
+    uint64_t offset;
+
+    /** Main loop of the writer thread */
+    void writeBlocks();
+};
+
+#endif /* __BASE_BLOCK_FILE_HH__ */
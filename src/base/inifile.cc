@@ -29,9 +29,17 @@
  *          Steve Reinhardt
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -40,33 +48,106 @@
 
 using namespace std;
 
+const size_t IniFile::arenaBlockSize;
+
+IniFile::StrRef
+IniFile::StrRef::trimmed() const
+{
+    size_t begin = 0;
+    while (begin < len && ptr[begin] == ' ')
+        ++begin;
+
+    if (begin == len)
+        return *this;
+
+    size_t end = len;
+    while (ptr[end - 1] == ' ')
+        --end;
+
+    return sub(begin, end - begin);
+}
+
+size_t
+IniFile::StrRefHash::operator()(const StrRef &s) const
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < s.size(); ++i) {
+        hash ^= (unsigned char)s[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
 IniFile::IniFile()
+    : arenaFree(NULL), arenaLeft(0), lastSection(NULL)
 {}
 
 IniFile::~IniFile()
 {
-    SectionTable::iterator i = table.begin();
-    SectionTable::iterator end = table.end();
+    for (auto &mapping : mappings)
+        munmap(mapping.first, mapping.second);
+}
 
-    while (i != end) {
-        delete (*i).second;
-        ++i;
+IniFile::StrRef
+IniFile::save(const char *s, size_t len)
+{
+    if (len > arenaLeft) {
+        size_t size = max(len, arenaBlockSize);
+        arena.emplace_back(new char[size]);
+        arenaFree = arena.back().get();
+        arenaLeft = size;
     }
+
+    char *copy = arenaFree;
+    memcpy(copy, s, len);
+    arenaFree += len;
+    arenaLeft -= len;
+
+    return StrRef(copy, len);
 }
 
 bool
 IniFile::load(const string &file)
 {
-    ifstream f(file.c_str());
+    int fd = open(file.c_str(), O_RDONLY);
 
-    if (!f.is_open())
+    if (fd < 0)
         return false;
 
-    return load(f);
+    struct stat sb;
+    if (fstat(fd, &sb) < 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t len = sb.st_size;
+    if (len == 0) {
+        close(fd);
+        return true;
+    }
+
+    void *text = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (text == MAP_FAILED) {
+        // not mappable (e.g. a pipe), read it instead
+        ifstream f(file.c_str());
+
+        if (!f.is_open())
+            return false;
+
+        return load(f);
+    }
+
+    mappings.push_back(make_pair(text, len));
+
+    return parse((const char *)text, len);
 }
 
 
-const string &
+const IniFile::StrRef &
 IniFile::Entry::getValue() const
 {
     referenced = true;
@@ -75,85 +156,92 @@ IniFile::Entry::getValue() const
 
 
 void
-IniFile::Section::addEntry(const std::string &entryName,
-                           const std::string &value,
-                           bool append)
+IniFile::Entry::appendValue(IniFile &ini, const StrRef &v)
+{
+    string joined = value.str() + " " + v.str();
+    value = ini.save(joined.data(), joined.size());
+}
+
+
+void
+IniFile::Section::addEntry(IniFile &ini, const StrRef &entryName,
+                           const StrRef &value, bool append)
 {
     EntryTable::iterator ei = table.find(entryName);
 
     if (ei == table.end()) {
         // new entry
-        table[entryName] = new Entry(value);
+        table.emplace(entryName, Entry(value));
     }
     else if (append) {
         // append new reult to old entry
-        ei->second->appendValue(value);
+        ei->second.appendValue(ini, value);
     }
     else {
         // override old entry
-        ei->second->setValue(value);
+        ei->second.setValue(value);
     }
 }
 
 
 bool
-IniFile::Section::add(const std::string &assignment)
+IniFile::Section::add(IniFile &ini, const StrRef &assignment)
 {
-    string::size_type offset = assignment.find('=');
-    if (offset == string::npos) {
+    const char *eq = (const char *)memchr(assignment.data(), '=',
+                                          assignment.size());
+    if (eq == NULL) {
         // no '=' found
         cerr << "Can't parse .ini line " << assignment << endl;
         return false;
     }
+    size_t offset = eq - assignment.data();
 
     // if "+=" rather than just "=" then append value
-    bool append = (assignment[offset-1] == '+');
-
-    string entryName = assignment.substr(0, append ? offset-1 : offset);
-    string value = assignment.substr(offset + 1);
+    bool append = (offset > 0 && assignment[offset-1] == '+');
 
-    eat_white(entryName);
-    eat_white(value);
+    StrRef entryName = assignment.sub(0, append ? offset-1 : offset);
+    StrRef value = assignment.sub(offset + 1,
+                                  assignment.size() - offset - 1);
 
-    addEntry(entryName, value, append);
+    addEntry(ini, entryName.trimmed(), value.trimmed(), append);
     return true;
 }
 
 
-IniFile::Entry *
-IniFile::Section::findEntry(const std::string &entryName) const
+const IniFile::Entry *
+IniFile::Section::findEntry(const StrRef &entryName) const
 {
     referenced = true;
 
     EntryTable::const_iterator ei = table.find(entryName);
 
-    return (ei == table.end()) ? NULL : ei->second;
+    return (ei == table.end()) ? NULL : &ei->second;
 }
 
 
 IniFile::Section *
-IniFile::addSection(const string &sectionName)
+IniFile::addSection(const StrRef &sectionName)
 {
-    SectionTable::iterator i = table.find(sectionName);
-
-    if (i != table.end()) {
-        return i->second;
-    }
-    else {
-        // new entry
-        Section *sec = new Section();
-        table[sectionName] = sec;
-        return sec;
-    }
+    // a new section is default constructed
+    return &table[sectionName];
 }
 
 
-IniFile::Section *
-IniFile::findSection(const string &sectionName) const
+const IniFile::Section *
+IniFile::findSection(const StrRef &sectionName) const
 {
+    if (lastSection && sectionName == lastSectionName)
+        return lastSection;
+
     SectionTable::const_iterator i = table.find(sectionName);
 
-    return (i == table.end()) ? NULL : i->second;
+    if (i == table.end())
+        return NULL;
+
+    lastSection = &i->second;
+    lastSectionName = i->first;
+
+    return lastSection;
 }
 
 
@@ -167,45 +255,61 @@ IniFile::add(const string &str)
     if (offset == string::npos)  // no ':' found
         return false;
 
-    string sectionName = str.substr(0, offset);
-    string rest = str.substr(offset + 1);
+    StrRef text = save(str.data(), str.size());
+    StrRef sectionName = text.sub(0, offset);
+    StrRef rest = text.sub(offset + 1, text.size() - offset - 1);
 
-    eat_white(sectionName);
-    Section *s = addSection(sectionName);
+    Section *s = addSection(sectionName.trimmed());
 
-    return s->add(rest);
+    return s->add(*this, rest);
 }
 
 bool
 IniFile::load(istream &f)
 {
+    string text((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+    StrRef saved = save(text.data(), text.size());
+
+    return parse(saved.data(), saved.size());
+}
+
+bool
+IniFile::parse(const char *text, size_t len)
+{
+    const char *pos = text;
+    const char *end = text + len;
     Section *section = NULL;
 
-    while (!f.eof()) {
-        f >> ws; // Eat whitespace
-        if (f.eof()) {
-            break;
+    while (pos != end) {
+        // Eat whitespace
+        if (isspace((unsigned char)*pos)) {
+            ++pos;
+            continue;
         }
 
-        string line;
-        getline(f, line);
-        if (line.size() == 0)
-            continue;
+        const char *eol = (const char *)memchr(pos, '\n', end - pos);
+        if (eol == NULL)
+            eol = end;
+
+        // the line starts with a non-space so it has one to end with
+        StrRef line(pos, eol - pos);
+        pos = (eol == end) ? end : eol + 1;
 
-        eat_end_white(line);
-        int last = line.size() - 1;
+        size_t last = line.size() - 1;
+        while (line[last] == ' ')
+            --last;
+        line = line.sub(0, last + 1);
 
         if (line[0] == '[' && line[last] == ']') {
-            string sectionName = line.substr(1, last - 1);
-            eat_white(sectionName);
-            section = addSection(sectionName);
+            StrRef sectionName = line.sub(1, last - 1);
+            section = addSection(sectionName.trimmed());
             continue;
         }
 
         if (section == NULL)
             continue;
 
-        if (!section->add(line))
+        if (!section->add(*this, line))
             return false;
     }
 
@@ -216,15 +320,16 @@ bool
 IniFile::find(const string &sectionName, const string &entryName,
               string &value) const
 {
-    Section *section = findSection(sectionName);
+    const Section *section = findSection(sectionName);
     if (section == NULL)
         return false;
 
-    Entry *entry = section->findEntry(entryName);
+    const Entry *entry = section->findEntry(entryName);
     if (entry == NULL)
         return false;
 
-    value = entry->getValue();
+    const StrRef &v = entry->getValue();
+    value.assign(v.data(), v.size());
 
     return true;
 }
@@ -237,15 +342,15 @@ IniFile::sectionExists(const string &sectionName) const
 
 
 bool
-IniFile::Section::printUnreferenced(const string &sectionName)
+IniFile::Section::printUnreferenced(const StrRef &sectionName)
 {
     bool unref = false;
     bool search_unref_entries = false;
     vector<string> unref_ok_entries;
 
-    Entry *entry = findEntry("unref_entries_ok");
+    const Entry *entry = findEntry("unref_entries_ok");
     if (entry != NULL) {
-        tokenize(unref_ok_entries, entry->getValue(), ' ');
+        tokenize(unref_ok_entries, entry->getValue().str(), ' ');
         if (unref_ok_entries.size()) {
             search_unref_entries = true;
         }
@@ -253,8 +358,8 @@ IniFile::Section::printUnreferenced(const string &sectionName)
 
     for (EntryTable::iterator ei = table.begin();
          ei != table.end(); ++ei) {
-        const string &entryName = ei->first;
-        entry = ei->second;
+        const StrRef &entryName = ei->first;
+        entry = &ei->second;
 
         if (entryName == "unref_section_ok" ||
             entryName == "unref_entries_ok")
@@ -265,7 +370,7 @@ IniFile::Section::printUnreferenced(const string &sectionName)
         if (!entry->isReferenced()) {
             if (search_unref_entries &&
                 (std::find(unref_ok_entries.begin(), unref_ok_entries.end(),
-                           entryName) != unref_ok_entries.end()))
+                           entryName.str()) != unref_ok_entries.end()))
             {
                 continue;
             }
@@ -286,7 +391,7 @@ IniFile::getSectionNames(vector<string> &list) const
     for (SectionTable::const_iterator i = table.begin();
          i != table.end(); ++i)
     {
-        list.push_back((*i).first);
+        list.push_back((*i).first.str());
     }
 }
 
@@ -297,8 +402,8 @@ IniFile::printUnreferenced()
 
     for (SectionTable::iterator i = table.begin();
          i != table.end(); ++i) {
-        const string &sectionName = i->first;
-        Section *section = i->second;
+        const StrRef &sectionName = i->first;
+        Section *section = &i->second;
 
         if (!section->isReferenced()) {
             if (section->findEntry("unref_section_ok") == NULL) {
@@ -319,12 +424,12 @@ IniFile::printUnreferenced()
 
 
 void
-IniFile::Section::dump(const string &sectionName)
+IniFile::Section::dump(const StrRef &sectionName)
 {
     for (EntryTable::iterator ei = table.begin();
          ei != table.end(); ++ei) {
         cout << sectionName << ": " << (*ei).first << " => "
-             << (*ei).second->getValue() << "\n";
+             << (*ei).second.getValue() << "\n";
     }
 }
 
@@ -333,6 +438,6 @@ IniFile::dump()
 {
     for (SectionTable::iterator i = table.begin();
          i != table.end(); ++i) {
-        i->second->dump(i->first);
+        i->second.dump(i->first);
     }
 }
@@ -32,10 +32,14 @@
 #ifndef __INIFILE_HH__
 #define __INIFILE_HH__
 
+#include <cstring>
 #include <fstream>
 #include <list>
+#include <memory>
+#include <ostream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 /**
@@ -51,40 +55,94 @@
 /// where each section is a set of key/value pairs.  Section names,
 /// keys, and values are all uninterpreted strings.
 ///
+/// Files are memory mapped and parsed in place: names and values refer
+/// to the text of the file, or to copies in an arena owned by the
+/// IniFile for strings from elsewhere, instead of being allocated one
+/// by one.  This keeps loading large checkpoints cheap.
+///
 class IniFile
 {
   protected:
 
+    ///
+    /// A string in the text of a loaded file or in the arena.  The
+    /// characters aren't owned, they live as long as the IniFile.
+    ///
+    class StrRef
+    {
+        const char      *ptr;           ///< First character.
+        size_t          len;            ///< Number of characters.
+
+      public:
+        StrRef() : ptr(""), len(0) {}
+        StrRef(const char *p, size_t l) : ptr(p), len(l) {}
+        StrRef(const char *p) : ptr(p), len(std::strlen(p)) {}
+        StrRef(const std::string &s) : ptr(s.data()), len(s.size()) {}
+
+        const char *data() const { return ptr; }
+        size_t size() const { return len; }
+        bool empty() const { return len == 0; }
+        char operator[](size_t i) const { return ptr[i]; }
+
+        /// Characters [pos, pos + n) of this string.
+        StrRef sub(size_t pos, size_t n) const { return StrRef(ptr + pos, n); }
+
+        /// Copy to a std::string.
+        std::string str() const { return std::string(ptr, len); }
+
+        /// The same string without leading and trailing spaces.  Like
+        /// eat_white(), a string of only spaces is left alone.
+        StrRef trimmed() const;
+
+        bool
+        operator==(const StrRef &other) const
+        {
+            return len == other.len && std::memcmp(ptr, other.ptr, len) == 0;
+        }
+
+        friend std::ostream &
+        operator<<(std::ostream &os, const StrRef &s)
+        {
+            return os.write(s.ptr, s.len);
+        }
+    };
+
+    /// FNV-1a hash of a StrRef.
+    struct StrRefHash
+    {
+        size_t operator()(const StrRef &s) const;
+    };
+
     ///
     /// A single key/value pair.
     ///
     class Entry
     {
-        std::string     value;          ///< The entry value.
+        StrRef          value;          ///< The entry value.
         mutable bool    referenced;     ///< Has this entry been used?
 
       public:
         /// Constructor.
-        Entry(const std::string &v)
+        Entry(const StrRef &v)
             : value(v), referenced(false)
         {
         }
 
         /// Has this entry been used?
-        bool isReferenced() { return referenced; }
+        bool isReferenced() const { return referenced; }
 
         /// Fetch the value.
-        const std::string &getValue() const;
+        const StrRef &getValue() const;
 
         /// Set the value.
-        void setValue(const std::string &v) { value = v; }
+        void setValue(const StrRef &v) { value = v; }
 
         /// Append the given string to the value.  A space is inserted
         /// between the existing value and the new value.  Since this
         /// operation is typically used with values that are
         /// space-separated lists of tokens, this keeps the tokens
         /// separate.
-        void appendValue(const std::string &v) { value += " "; value += v; }
+        void appendValue(IniFile &ini, const StrRef &v);
     };
 
     ///
@@ -92,8 +150,8 @@ class IniFile
     ///
     class Section
     {
-        /// EntryTable type.  Map of strings to Entry object pointers.
-        typedef std::unordered_map<std::string, Entry *> EntryTable;
+        /// EntryTable type.  Map of names to entries.
+        typedef std::unordered_map<StrRef, Entry, StrRefHash> EntryTable;
 
         EntryTable      table;          ///< Table of entries.
         mutable bool    referenced;     ///< Has this section been used?
@@ -111,47 +169,76 @@ class IniFile
         /// Add an entry to the table.  If an entry with the same name
         /// already exists, the 'append' parameter is checked If true,
         /// the new value will be appended to the existing entry.  If
-        /// false, the new value will replace the existing entry.
-        void addEntry(const std::string &entryName, const std::string &value,
-                      bool append);
+        /// false, the new value will replace the existing entry.  The
+        /// name and value must live as long as the IniFile.
+        void addEntry(IniFile &ini, const StrRef &entryName,
+                      const StrRef &value, bool append);
 
         /// Add an entry to the table given a string assigment.
         /// Assignment should be of the form "param=value" or
         /// "param+=value" (for append).  This funciton parses the
         /// assignment statment and calls addEntry().
         /// @retval True for success, false if parse error.
-        bool add(const std::string &assignment);
+        bool add(IniFile &ini, const StrRef &assignment);
 
         /// Find the entry with the given name.
         /// @retval Pointer to the entry object, or NULL if none.
-        Entry *findEntry(const std::string &entryName) const;
+        const Entry *findEntry(const StrRef &entryName) const;
 
         /// Print the unreferenced entries in this section to cerr.
         /// Messages can be suppressed using "unref_section_ok" and
         /// "unref_entries_ok".
         /// @param sectionName Name of this section, for use in output message.
         /// @retval True if any entries were printed.
-        bool printUnreferenced(const std::string &sectionName);
+        bool printUnreferenced(const StrRef &sectionName);
 
         /// Print the contents of this section to cout (for debugging).
-        void dump(const std::string &sectionName);
+        void dump(const StrRef &sectionName);
     };
 
-    /// SectionTable type.  Map of strings to Section object pointers.
-    typedef std::unordered_map<std::string, Section *> SectionTable;
+    /// SectionTable type.  Map of names to sections.
+    typedef std::unordered_map<StrRef, Section, StrRefHash> SectionTable;
+
+    /// Size of the arena blocks strings are copied into.
+    static const size_t arenaBlockSize = 64 * 1024;
 
   protected:
-    /// Hash of section names to Section object pointers.
+    /// Hash of section names to sections.
     SectionTable table;
 
+    /// Memory mapped files (address, size), unmapped by the destructor.
+    std::vector<std::pair<void *, size_t>> mappings;
+
+    /// Arena blocks holding the text not in a mapped file.
+    std::vector<std::unique_ptr<char[]>> arena;
+
+    /// Unused part of the last arena block.
+    char *arenaFree;
+    size_t arenaLeft;
+
+    /// The last section found: lookups, like the paramIn()s of a
+    /// SimObject's checkpoint section, come in runs on one section.
+    mutable const Section *lastSection;
+    mutable StrRef lastSectionName;
+
+    /// Copy the given characters into the arena.
+    /// @retval The copy.
+    StrRef save(const char *s, size_t len);
+
+    /// Parse the text of a file.  The text must live as long as the
+    /// IniFile.
+    /// @retval True if successful, false if errors were encountered.
+    bool parse(const char *text, size_t len);
+
     /// Look up section with the given name, creating a new section if
-    /// not found.
+    /// not found.  A new section's name must live as long as the
+    /// IniFile.
     /// @retval Pointer to section object.
-    Section *addSection(const std::string &sectionName);
+    Section *addSection(const StrRef &sectionName);
 
     /// Look up section with the given name.
     /// @retval Pointer to section object, or NULL if not found.
-    Section *findSection(const std::string &sectionName) const;
+    const Section *findSection(const StrRef &sectionName) const;
 
   public:
     /// Constructor.
@@ -1,5 +1,13 @@
 #include "base/softerror.hh"
+
+#include <unordered_map>
+
+#include "base/callback.hh"
+#include "base/misc.hh"
+#include "base/trace.hh"
 #include "cpu/minor/dyn_inst.hh"
+#include "debug/FI.hh"
+#include "sim/sim_exit.hh"
 
 namespace SoftError
 {
@@ -8,16 +16,52 @@ namespace SoftError
     bool injDone = false;
     bool faulty_inst_id_tracked = false;
     bool faulty_inst_id_logged = false;
+    bool injPaused = false;
 
     /** Injection Info */
-    unsigned int injTime;
+    Tick injTime;
     unsigned int injLoc;
     InjComp injComp;
     unsigned int injWait;
     Minor::InstId faulty_inst_id;
+    Addr injAddr = 0;
+    Addr injLen = 0;
+    bool injMaskedExit = false;
+
+    /** Tracking Info */
+    bool memTainted = false;
+    bool dmaFaultConsumed = false;
+    bool gpuFaultConsumed = false;
+
+    /** Corrupted bytes in memory and their faulty value */
+    static std::unordered_map<Addr, uint8_t> taintedBytes;
+
+    /**
+     * Report at the end of the run whether the fault propagated, the
+     * campaign scripts look for "Fault consumed" in the output
+     */
+    struct ReportCallback : public Callback
+    {
+        void process() override
+        {
+            if (dmaFaultConsumed)
+                inform("Fault consumed: corrupted DMA data was read");
+            if (gpuFaultConsumed)
+                inform("Fault consumed: corrupted GPU state was read");
+        }
+    };
+
+    static void registerReport()
+    {
+        static bool registered = false;
+        if (!registered) {
+            registerExitCallback(new ReportCallback);
+            registered = true;
+        }
+    }
 
     /** (Default value of wait_count) = 0 */
-    void registerInj(unsigned int time, unsigned int loc, InjComp comp, unsigned int wait_count)
+    void registerInj(Tick time, unsigned int loc, InjComp comp, unsigned int wait_count)
     {
         injRegistered = true;
         injTime = time;
@@ -26,7 +70,111 @@ namespace SoftError
         injWait = wait_count;
     }
 
-    bool timeToInject() { return injRegistered && (!injDone) && curTick() >= injTime; }
+    void registerDmaInj(Tick time, unsigned int loc, Addr addr, Addr len, bool masked_exit)
+    {
+        registerInj(time, loc, DMA);
+        registerReport();
+        injAddr = addr;
+        injLen = len;
+        injMaskedExit = masked_exit;
+    }
+
+    void registerGpuInj(Tick time, unsigned int loc, InjComp comp, bool masked_exit)
+    {
+        registerInj(time, loc, comp);
+        registerReport();
+        injMaskedExit = masked_exit;
+    }
+
+    bool timeToInject() { return injRegistered && (!injDone) && (!injPaused) && curTick() >= injTime; }
     bool injReady() { return timeToInject() && (injWait == 0); }
+
+    bool dmaInjReady(Addr addr, unsigned size)
+    {
+        if (!(injReady() && injComp == DMA) || size == 0)
+            return false;
+        return injLen == 0 || (addr < injAddr + injLen && injAddr < addr + size);
+    }
+
+    Addr injectDma(const std::string &dev, Addr addr, uint8_t *data, unsigned size)
+    {
+        // Only the part of the transfer inside the target window is a
+        // candidate, the bit location wraps around its size
+        Addr start = addr;
+        Addr end = addr + size;
+        if (injLen != 0) {
+            start = std::max(start, injAddr);
+            end = std::min(end, injAddr + injLen);
+        }
+        const unsigned bit = injLoc % ((end - start) * 8);
+        const Addr faulty_addr = start + bit / 8;
+        uint8_t &byte = data[faulty_addr - addr];
+        const uint8_t golden = byte;
+
+        byte = BITFLIP(byte, bit % 8);
+        injDone = true;
+
+        DPRINTF(FI, "Fault Injection into 'dma' (%s) - Bit[%u] Flipped, "
+                "transfer [%#x, %#x): byte %#x: %#x -> %#x\n", dev, bit,
+                addr, addr + size, faulty_addr, golden, byte);
+        return faulty_addr;
+    }
+
+    void dmaConsumed(const std::string &dev, Addr addr)
+    {
+        dmaFaultConsumed = true;
+        DPRINTF(FI, "Corrupted DMA data of %#x consumed by %s\n", addr, dev);
+    }
+
+    void taintMem(Addr addr, uint8_t value)
+    {
+        taintedBytes[addr] = value;
+        memTainted = true;
+        DPRINTF(FI, "Tracking corrupted DMA data at %#x\n", addr);
+    }
+
+    void trackMemAccess(Addr addr, unsigned size, const uint8_t *data)
+    {
+        for (auto t = taintedBytes.begin(); t != taintedBytes.end(); ) {
+            if (t->first < addr || t->first >= addr + size) {
+                ++t;
+            } else if (!data) {
+                // The fault propagates out of the memory, there is no
+                // point in tracking it any further
+                dmaFaultConsumed = true;
+                DPRINTF(FI, "Corrupted DMA data at %#x consumed by read of "
+                        "[%#x, %#x)\n", t->first, addr, addr + size);
+                taintedBytes.clear();
+                memTainted = false;
+                return;
+            } else if (data[t->first - addr] != t->second) {
+                // Writing back the faulty value (e.g. a cache eviction)
+                // keeps the fault alive, anything else masks it
+                DPRINTF(FI, "Corrupted DMA data at %#x overwritten\n",
+                        t->first);
+                t = taintedBytes.erase(t);
+            } else {
+                ++t;
+            }
+        }
+
+        if (taintedBytes.empty()) {
+            memTainted = false;
+            faultMasked("DMA data overwritten");
+        }
+    }
+
+    void gpuConsumed(const std::string &by)
+    {
+        gpuFaultConsumed = true;
+        DPRINTF(FI, "Corrupted GPU state consumed by %s\n", by);
+    }
+
+    void faultMasked(const std::string &why)
+    {
+        DPRINTF(FI, "Fault masked: %s\n", why);
+        if (injMaskedExit)
+            exitSimLoop("fault masked");
+    }
 } // namespace SoftError
 
@@ -5,6 +5,9 @@
 #ifndef __BASE_SOFTERROR_HH__
 #define __BASE_SOFTERROR_HH__
 
+#include <string>
+
+#include "base/types.hh"
 #include "sim/core.hh"
 #define BITFLIP(data, bit) (data ^ (1 << (bit)))
 
@@ -22,6 +25,10 @@ namespace SoftError
         DTOE,
         ETOF1,
         F2TOF1,
+        DMA,
+        GPU_VRF,
+        GPU_LDS,
+        GPU_CRF,
         NUM_INJCOMP
     } InjComp;
 
@@ -30,17 +37,54 @@ namespace SoftError
     extern bool injDone;
     extern bool faulty_inst_id_tracked;
     extern bool faulty_inst_id_logged;
+    /** Injection is held off while a golden model (the Minor shadow
+     *  checker) decodes instructions */
+    extern bool injPaused;
 
     /** Injection Infos: You have to register them */
-    extern unsigned int injTime;
+    extern Tick injTime;
     extern unsigned int injLoc;
     extern InjComp injComp;
     extern unsigned int injWait;
     extern Minor::InstId faulty_inst_id;
 
-    void registerInj(unsigned int time, unsigned int loc, InjComp comp, unsigned int wait_count=0);
+    /** DMA injection target: transfers touching [injAddr, injAddr + injLen),
+     *  any transfer if injLen is 0 */
+    extern Addr injAddr;
+    extern Addr injLen;
+    /** End the simulation once the corrupted DMA data is overwritten unread */
+    extern bool injMaskedExit;
+
+    /** Propagation tracking of corrupted DMA data in memory */
+    extern bool memTainted;
+    extern bool dmaFaultConsumed;
+    /** Corrupted GPU state was read by an instruction */
+    extern bool gpuFaultConsumed;
+
+    void registerInj(Tick time, unsigned int loc, InjComp comp, unsigned int wait_count=0);
+    void registerDmaInj(Tick time, unsigned int loc, Addr addr, Addr len, bool masked_exit);
+    void registerGpuInj(Tick time, unsigned int loc, InjComp comp, bool masked_exit);
     bool timeToInject();
     bool injReady();
+
+    /** Is the DMA transfer of [addr, addr + size) the injection target? */
+    bool dmaInjReady(Addr addr, unsigned size);
+    /**
+     * Flip bit injLoc of the part of the transfer within the target window.
+     * @return Address of the corrupted byte.
+     */
+    Addr injectDma(const std::string &dev, Addr addr, uint8_t *data, unsigned size);
+    /** A device used corrupted data it read from memory */
+    void dmaConsumed(const std::string &dev, Addr addr);
+    /** Start tracking a corrupted byte written to memory */
+    void taintMem(Addr addr, uint8_t value);
+    /** Check a memory access against the tracked bytes, data is NULL for reads */
+    void trackMemAccess(Addr addr, unsigned size, const uint8_t *data);
+
+    /** The corrupted GPU state was read by an instruction (or a device) */
+    void gpuConsumed(const std::string &by);
+    /** The fault can no longer propagate, end the run if asked to */
+    void faultMasked(const std::string &why);
 } // namespace SoftError
 
 #endif // __BASE_SOFTERROR_HH__
@@ -448,8 +448,10 @@ Formula::reset()
 bool
 Formula::zero() const
 {
-    VResult vec;
-    result(vec);
+    if (!root)
+        return true;
+
+    const VResult &vec = root->result();
     for (VResult::size_type i = 0; i < vec.size(); ++i)
         if (vec[i] != 0.0)
             return false;
@@ -487,6 +489,25 @@ processDumpQueue()
     dumpQueue.process();
 }
 
+unsigned dumpGeneration = 0;
+
+void
+beginDump()
+{
+    static unsigned lastGeneration = 0;
+
+    // Skip 0 on wrap around, it means that no dump is in progress
+    if (++lastGeneration == 0)
+        ++lastGeneration;
+    dumpGeneration = lastGeneration;
+}
+
+void
+endDump()
+{
+    dumpGeneration = 0;
+}
+
 void
 registerResetCallback(Callback *cb)
 {
@@ -621,6 +621,32 @@ class AvgStor
 
 };
 
+/**
+ * Reset an array of storage objects.
+ * @param stor The first element of the array.
+ * @param size The number of elements.
+ * @param info The info of the stat that owns the storage.
+ */
+template <class Storage>
+inline void
+resetStorage(Storage *stor, size_type size, Info *info)
+{
+    for (off_type i = 0; i < size; ++i)
+        stor[i].reset(info);
+}
+
+/**
+ * A StatStor is a single Counter, so an array of them is a packed
+ * Counter[] and can be cleared with one fill the compiler vectorizes.
+ */
+inline void
+resetStorage(StatStor *stor, size_type size, Info *info)
+{
+    static_assert(sizeof(StatStor) == sizeof(Counter),
+                  "StatStor arrays must be packed Counter arrays");
+    std::fill_n(reinterpret_cast<Counter *>(stor), size, Counter());
+}
+
 /**
  * Implementation of a scalar stat. The type of stat is determined by the
  * Storage template.
@@ -1072,6 +1098,16 @@ class VectorBase : public DataWrapVec<Derived, VectorInfoProxy>
         return total;
     }
 
+    /**
+     * Reset stat value to default
+     */
+    void
+    reset()
+    {
+        if (storage)
+            resetStorage(storage, _size, this->info());
+    }
+
     /**
      * @return the number of elements in this vector.
      */
@@ -1333,10 +1369,8 @@ class Vector2dBase : public DataWrapVec2d<Derived, Vector2dInfoProxy>
     void
     reset()
     {
-        Info *info = this->info();
-        size_type size = this->size();
-        for (off_type i = 0; i < size; ++i)
-            data(i)->reset(info);
+        if (storage)
+            resetStorage(storage, _size, this->info());
     }
 
     bool
@@ -2061,12 +2095,39 @@ class DistProxy
 //
 //////////////////////////////////////////////////////////////////////
 
+/**
+ * Generation of the stats dump in progress, 0 outside of dumps. While a
+ * dump is in progress the stats can't change, so formula nodes evaluate
+ * their subtree once per dump and reuse the result for every later
+ * result(), total() and zero() call.
+ */
+extern unsigned dumpGeneration;
+
 /**
  * Base class for formula statistic node. These nodes are used to build a tree
  * that represents the formula.
  */
 class Node
 {
+  private:
+    /** Dump generation the cached result of this node belongs to. */
+    mutable unsigned generation = 0;
+
+  protected:
+    /**
+     * Check if the cached result of this node is valid for the dump in
+     * progress, and mark it valid as the caller is about to compute it.
+     * @return true if the cached result can be returned as is.
+     */
+    bool
+    cached() const
+    {
+        if (dumpGeneration && generation == dumpGeneration)
+            return true;
+        generation = dumpGeneration;
+        return false;
+    }
+
   public:
     /**
      * Return the number of nodes in the subtree starting at this node.
@@ -2274,6 +2335,9 @@ class UnaryNode : public Node
     const VResult &
     result() const
     {
+        if (this->cached())
+            return vresult;
+
         const VResult &lvec = l->result();
         size_type size = lvec.size();
 
@@ -2320,6 +2384,9 @@ class BinaryNode : public Node
     const VResult &
     result() const
     {
+        if (this->cached())
+            return vresult;
+
         Op op;
         const VResult &lvec = l->result();
         const VResult &rvec = r->result();
@@ -2352,7 +2419,6 @@ class BinaryNode : public Node
     Result
     total() const
     {
-        const VResult &vec = this->result();
         const VResult &lvec = l->result();
         const VResult &rvec = r->result();
         Result total = 0.0;
@@ -2374,6 +2440,7 @@ class BinaryNode : public Node
         }
 
         /** Otherwise divide each item by the divisor */
+        const VResult &vec = this->result();
         for (off_type i = 0; i < size(); ++i) {
             total += vec[i];
         }
@@ -2416,6 +2483,9 @@ class SumNode : public Node
     const VResult &
     result() const
     {
+        if (this->cached())
+            return vresult;
+
         const VResult &lvec = l->result();
         size_type size = lvec.size();
         assert(size > 0);
@@ -3261,6 +3331,17 @@ void processResetQueue();
  */
 void processDumpQueue();
 
+/**
+ * Start a new dump generation, formula results are cached until
+ * endDump() is called. Must only be called while no stat can change.
+ */
+void beginDump();
+
+/**
+ * End the dump generation, formulas are evaluated on every access again.
+ */
+void endDump();
+
 std::list<Info *> &statsList();
 
 typedef std::map<const void *, Info *> MapType;
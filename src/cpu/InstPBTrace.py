@@ -30,8 +30,19 @@ from m5.SimObject import SimObject
 from m5.params import *
 from InstTracer import InstTracer
 
+# protobuf: messages from proto/inst.proto, compressed if the file name
+#           ends with .gz
+# raw:      fixed size records in an indexed block file, see
+#           cpu/inst_pb_trace.hh
+class InstTraceFormat(Enum): vals = ['protobuf', 'raw']
+
 class InstPBTrace(InstTracer):
     type = 'InstPBTrace'
     cxx_class = 'Trace::InstPBTrace'
     cxx_header = 'cpu/inst_pb_trace.hh'
     file_name = Param.String("Instruction trace output file")
+    format = Param.InstTraceFormat('protobuf', "Instruction trace format")
+    batch_size = Param.Unsigned(16384, "Instructions handed to the "
+                                "trace writer thread at a time")
+    compression_level = Param.Int(1, "zlib compression level of a "
+                                  "compressed protobuf trace")
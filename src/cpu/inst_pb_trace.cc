@@ -40,6 +40,7 @@
 #include "cpu/inst_pb_trace.hh"
 
 #include "base/callback.hh"
+#include "base/misc.hh"
 #include "base/output.hh"
 #include "config/the_isa.hh"
 #include "cpu/static_inst.hh"
@@ -51,7 +52,177 @@
 
 namespace Trace {
 
-ProtoOutputStream *InstPBTrace::traceStream;
+namespace
+{
+
+const BlockFile::Format rawFormat = {
+    { 'M', '5', 'I', 'N', 'S', 'T', 'R', '\0' }, 1,
+    0x4b425449, /* "ITBK" */
+    { 'M', '5', 'I', 'N', 'S', 'I', 'D', 'X' }
+};
+
+/** Size of a raw record without its memory accesses */
+const size_t rawInstSize = 28;
+
+}
+
+InstTraceWriter::InstTraceWriter(const std::string &filename,
+    Enums::InstTraceFormat _format, size_t batch_size,
+    int compression_level)
+    : format(_format), batchSize(batch_size), protoStream(NULL),
+      rawFile(NULL), stop(false)
+{
+    if (format == Enums::raw) {
+        rawFile = new BlockFile(filename, rawFormat);
+        rawBlock.body.reserve(batchSize * (rawInstSize + 16));
+        return;
+    }
+
+    protoStream = new ProtoOutputStream(simout.resolve(filename),
+                                        compression_level);
+
+    // Output the header
+    ProtoMessage::InstHeader header_msg;
+    header_msg.set_obj_id("gem5 generated instruction trace");
+    header_msg.set_ver(0);
+    header_msg.set_tick_freq(SimClock::Frequency);
+    header_msg.set_has_mem(true);
+    protoStream->write(header_msg);
+
+    current.insts.reserve(batchSize);
+    current.numMem.reserve(batchSize);
+    spare.resize(numBatches - 1);
+    for (auto &batch : spare) {
+        batch.insts.reserve(batchSize);
+        batch.numMem.reserve(batchSize);
+    }
+
+    writer = std::thread(&InstTraceWriter::writeBatches, this);
+}
+
+void
+InstTraceWriter::add(const Inst &inst, const std::vector<MemAccess> &mem)
+{
+    panic_if(mem.size() > UINT16_MAX,
+             "Too many memory accesses for one instruction\n");
+
+    if (rawFile) {
+        rawBlock.addRecord(curTick());
+        rawBlock.putRaw(uint64_t(inst.tick));
+        rawBlock.putRaw(uint64_t(inst.pc));
+        rawBlock.putRaw(inst.inst);
+        rawBlock.putRaw(inst.cpuId);
+        rawBlock.putRaw(inst.type);
+        rawBlock.putRaw(inst.flags);
+        rawBlock.putRaw(uint16_t(mem.size()));
+        for (const auto &access : mem) {
+            rawBlock.putRaw(uint64_t(access.addr));
+            rawBlock.putRaw(access.size);
+            rawBlock.putRaw(access.flags);
+        }
+
+        if (rawBlock.records >= batchSize)
+            rawFile->write(rawBlock, batchSize * (rawInstSize + 16));
+        return;
+    }
+
+    current.insts.push_back(inst);
+    current.numMem.push_back(mem.size());
+    current.mem.insert(current.mem.end(), mem.begin(), mem.end());
+
+    if (current.insts.size() >= batchSize)
+        flush();
+}
+
+void
+InstTraceWriter::flush()
+{
+    if (current.insts.empty())
+        return;
+
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [this] { return !spare.empty(); });
+        pending.push_back(std::move(current));
+        current = std::move(spare.back());
+        spare.pop_back();
+    }
+    cond.notify_all();
+}
+
+void
+InstTraceWriter::writeBatches()
+{
+    // One message is reused for all the instructions
+    ProtoMessage::Inst msg;
+    std::unique_lock<std::mutex> guard(lock);
+
+    while (true) {
+        cond.wait(guard, [this] { return stop || !pending.empty(); });
+        if (pending.empty())
+            break;
+
+        Batch batch = std::move(pending.front());
+        pending.pop_front();
+        guard.unlock();
+
+        const MemAccess *access = batch.mem.data();
+        for (size_t i = 0; i < batch.insts.size(); i++) {
+            const Inst &inst = batch.insts[i];
+            msg.Clear();
+            msg.set_pc(inst.pc);
+            msg.set_inst(inst.inst);
+            msg.set_cpuid(inst.cpuId);
+            msg.set_tick(inst.tick);
+            msg.set_type(
+                static_cast<ProtoMessage::Inst_InstType>(inst.type));
+            msg.set_inst_flags(inst.flags);
+            for (unsigned j = 0; j < batch.numMem[i]; j++, access++) {
+                ProtoMessage::Inst::MemAccess *mem_msg =
+                    msg.add_mem_access();
+                mem_msg->set_addr(access->addr);
+                mem_msg->set_size(access->size);
+                mem_msg->set_mem_flags(access->flags);
+            }
+            protoStream->write(msg);
+        }
+
+        // Keep the storage of the batch for the next one
+        batch.insts.clear();
+        batch.numMem.clear();
+        batch.mem.clear();
+
+        guard.lock();
+        spare.push_back(std::move(batch));
+        cond.notify_all();
+    }
+}
+
+void
+InstTraceWriter::close()
+{
+    if (rawFile) {
+        rawFile->write(rawBlock);
+        rawFile->close();
+        delete rawFile;
+        rawFile = NULL;
+        return;
+    }
+
+    flush();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    cond.notify_all();
+    writer.join();
+
+    delete protoStream;
+    protoStream = NULL;
+}
+
+InstTraceWriter *InstPBTrace::traceWriter;
+unsigned InstPBTrace::openTracers;
 
 void
 InstPBTraceRecord::dump()
@@ -69,49 +240,48 @@ InstPBTraceRecord::dump()
 }
 
 InstPBTrace::InstPBTrace(const InstPBTraceParams *p)
-    : InstTracer(p), curMsg(nullptr)
+    : InstTracer(p), hasCurInst(false), closed(false)
 {
     // Create our output file
-    createTraceFile(p->file_name);
+    createTraceFile(p);
 }
 
 void
-InstPBTrace::createTraceFile(std::string filename)
+InstPBTrace::createTraceFile(const InstPBTraceParams *p)
 {
-    // Since there is only one output file for all tracers check if it exists
-    if (traceStream)
-        return;
-
-    traceStream = new ProtoOutputStream(simout.resolve(filename));
-
-    // Output the header
-    ProtoMessage::InstHeader header_msg;
-    header_msg.set_obj_id("gem5 generated instruction trace");
-    header_msg.set_ver(0);
-    header_msg.set_tick_freq(SimClock::Frequency);
-    header_msg.set_has_mem(true);
-    traceStream->write(header_msg);
-
-    // get a callback when we exit so we can close the file
+    // get a callback when we exit so we can write out our last
+    // instruction and close the file
+    openTracers++;
     Callback *cb = new MakeCallback<InstPBTrace,
              &InstPBTrace::closeStreams>(this);
     registerExitCallback(cb);
+
+    // Since there is only one output file for all tracers check if it exists
+    if (traceWriter)
+        return;
+
+    traceWriter = new InstTraceWriter(p->file_name, p->format,
+                                      p->batch_size, p->compression_level);
 }
 
 void
 InstPBTrace::closeStreams()
 {
-    if (curMsg) {
-        traceStream->write(*curMsg);
-        delete curMsg;
-        curMsg = NULL;
+    if (closed)
+        return;
+    closed = true;
+
+    if (hasCurInst) {
+        traceWriter->add(curInst, curMem);
+        hasCurInst = false;
     }
 
-    if (!traceStream)
+    if (--openTracers != 0 || !traceWriter)
         return;
 
-    delete traceStream;
-    traceStream = NULL;
+    traceWriter->close();
+    delete traceWriter;
+    traceWriter = NULL;
 }
 
 InstPBTrace::~InstPBTrace()
@@ -134,37 +304,30 @@ InstPBTrace::getInstRecord(Tick when, ThreadContext *tc, const StaticInstPtr si,
 void
 InstPBTrace::traceInst(ThreadContext *tc, StaticInstPtr si, TheISA::PCState pc)
 {
-    if (curMsg) {
-        /// @todo if we are running multi-threaded I assume we'd need a lock here
-        traceStream->write(*curMsg);
-        delete curMsg;
-        curMsg = NULL;
-    }
-
-    // Create a new instruction message and fill out the fields
-    curMsg = new ProtoMessage::Inst;
-    curMsg->set_pc(pc.pc());
-    curMsg->set_inst(static_cast<uint32_t>(bits(si->machInst, 31, 0)));
-    curMsg->set_cpuid(tc->cpuId());
-    curMsg->set_tick(curTick());
-    curMsg->set_type(static_cast<ProtoMessage::Inst_InstType>(si->opClass()));
-    curMsg->set_inst_flags(bits(si->machInst, 7, 0));
+    if (hasCurInst)
+        traceWriter->add(curInst, curMem);
 
+    // Fill out the fields of the new instruction
+    curInst.pc = pc.pc();
+    curInst.inst = static_cast<uint32_t>(bits(si->machInst, 31, 0));
+    curInst.cpuId = tc->cpuId();
+    curInst.tick = curTick();
+    curInst.type = si->opClass();
+    curInst.flags = bits(si->machInst, 7, 0);
+    curMem.clear();
+    hasCurInst = true;
 }
 
 void
 InstPBTrace::traceMem(StaticInstPtr si, Addr a, Addr s, unsigned f)
 {
-    panic_if(!curMsg, "Memory access w/o msg?!");
+    panic_if(!hasCurInst, "Memory access w/o msg?!");
 
     // We do a poor job identifying macro-ops that are load/stores
-    curMsg->set_type(static_cast<ProtoMessage::Inst_InstType>(si->opClass()));
-
-    ProtoMessage::Inst::MemAccess *mem_msg = curMsg->add_mem_access();
-    mem_msg->set_addr(a);
-    mem_msg->set_size(s);
-    mem_msg->set_mem_flags(f);
+    curInst.type = si->opClass();
 
+    InstTraceWriter::MemAccess access = { a, uint32_t(s), f };
+    curMem.push_back(access);
 }
 
 } // namespace Trace
@@ -175,4 +338,3 @@ InstPBTraceParams::create()
 {
     return new Trace::InstPBTrace(this);
 }
-
@@ -40,22 +40,122 @@
 #ifndef __CPU_INST_PB_TRACE_HH__
 #define __CPU_INST_PB_TRACE_HH__
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "arch/types.hh"
+#include "base/block_file.hh"
 #include "base/trace.hh"
 #include "base/types.hh"
 #include "cpu/static_inst_fwd.hh"
+#include "enums/InstTraceFormat.hh"
 #include "params/InstPBTrace.hh"
 #include "proto/protoio.hh"
 #include "sim/insttracer.hh"
 
 class ThreadContext;
 
-namespace ProtoMessage {
-class Inst;
-}
-
 namespace Trace {
 
+/**
+ * Writer of the instruction trace shared by all InstPBTrace tracers.
+ *
+ * Instructions are collected as plain records in batches. In the
+ * protobuf format, full batches are handed to a helper thread that
+ * encodes, compresses and writes them while the simulation fills the
+ * next batch. The batches are recycled, so their storage is reused.
+ *
+ * The raw format needs no encoding, records are copied to the blocks
+ * of a BlockFile (base/block_file.hh) with file magic "M5INSTR\0",
+ * block magic "ITBK" and index magic "M5INSIDX". The ticks of the
+ * blocks are those at which the records were written. Each record
+ * is, in host byte order and without padding:
+ *
+ *  uint64 tick, uint64 pc, uint32 inst, uint32 cpu id, uint8 op class,
+ *  uint8 inst flags, uint16 memory accesses, and for each access
+ *  uint64 address, uint32 size, uint32 flags
+ */
+class InstTraceWriter
+{
+  public:
+    /** A memory access of an instruction */
+    struct MemAccess
+    {
+        Addr addr;
+        uint32_t size;
+        uint32_t flags;
+    };
+
+    /** An instruction, see proto/inst.proto for the fields */
+    struct Inst
+    {
+        Tick tick;
+        Addr pc;
+        uint32_t inst;
+        uint32_t cpuId;
+        uint8_t type;
+        uint8_t flags;
+    };
+
+    /** Batches in use, the simulation waits when they are all full */
+    static const size_t numBatches = 4;
+
+    /**
+     * Create the output file and write its header
+     * @param batch_size Instructions in a batch or raw block
+     * @param compression_level zlib level of a compressed protobuf trace
+     */
+    InstTraceWriter(const std::string &filename,
+        Enums::InstTraceFormat format, size_t batch_size,
+        int compression_level);
+
+    /** Add an instruction and its memory accesses */
+    void add(const Inst &inst, const std::vector<MemAccess> &mem);
+
+    /** Write the remaining instructions and close the file */
+    void close();
+
+  private:
+    struct Batch
+    {
+        std::vector<Inst> insts;
+        /** Number of memory accesses of each instruction */
+        std::vector<uint16_t> numMem;
+        /** Memory accesses of all the instructions, in order */
+        std::vector<MemAccess> mem;
+    };
+
+    const Enums::InstTraceFormat format;
+    const size_t batchSize;
+
+    /** Protobuf output, owned by the helper thread once it runs */
+    ProtoOutputStream *protoStream;
+
+    /** Raw output and the block being filled */
+    BlockFile *rawFile;
+    BlockFile::Block rawBlock;
+
+    /** The batch being filled */
+    Batch current;
+
+    /** Full batches to write and empty ones to fill, protected by lock */
+    std::deque<Batch> pending;
+    std::vector<Batch> spare;
+    bool stop;
+    std::mutex lock;
+    std::condition_variable cond;
+    std::thread writer;
+
+    /** Hand the current batch to the helper thread and take a spare one */
+    void flush();
+
+    /** Main loop of the helper thread */
+    void writeBatches();
+};
+
 /**
  * This in an instruction tracer that records the flow of instructions through
  * multiple cpus and systems to a protobuf file specified by proto/inst.proto
@@ -93,24 +193,32 @@ class InstPBTrace : public InstTracer
                                     StaticInstPtr mi = NULL) override;
 
   protected:
-    /** One output stream for the entire simulation.
+    /** One writer for the entire simulation.
      * We encode the CPU & system ID so all we need is a single file
      */
-    static ProtoOutputStream *traceStream;
+    static InstTraceWriter *traceWriter;
 
+    /** Tracers that haven't closed their streams yet */
+    static unsigned openTracers;
 
-    /** This is the message were working on writing. The majority of the message
-     * exists however the memory accesses will be delayed.
+    /** This is the instruction were working on writing. The majority of
+     * the instruction exists however the memory accesses will be delayed.
      */
-    ProtoMessage::Inst *curMsg;
+    InstTraceWriter::Inst curInst;
+    std::vector<InstTraceWriter::MemAccess> curMem;
+    bool hasCurInst;
+
+    /** Has closeStreams() been called? */
+    bool closed;
 
     /** Create the output file and write the header into it
-     * @param filename the file to create (if ends with .gz it will be
-     * compressed)
+     * @param p the parameters of the tracer creating the file (if
+     * file_name ends with .gz a protobuf trace will be compressed)
      */
-    void createTraceFile(std::string filename);
+    void createTraceFile(const InstPBTraceParams *p);
 
-    /** If there is a pending message still write it out and then close the file
+    /** If there is a pending instruction still write it out, the file is
+     * closed with the last tracer
      */
     void closeStreams();
 
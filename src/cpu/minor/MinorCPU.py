@@ -289,4 +289,21 @@ class MinorCPU(BaseCPU):
     #ybkim
     injectFaultFu = Param.Unsigned(0, "Inject a single-bit fault in Functional unit or not (0: NO, 1: Yes)")
     correctRf = Param.Bool(False, "Correct register data after fault injection")
-    correctTime = Param.UInt64(0, "Time to correct fault")
\ No newline at end of file
+    correctTime = Param.UInt64(0, "Time to correct fault")
+    rfParity = Param.Bool(False, "Model parity protection of the integer "
+        "register file (only adds parity event stats)")
+    timingStats = Param.Bool(False, "Count the pipeline occupancy, stall "
+        "and redirect stats (executeOccupancy, lsqOccupancy, "
+        "scoreboardStalls, fetchRedirects)")
+    shadowCheck = Param.Bool(False, "Check committed instructions against "
+        "a golden shadow started at injectTime (SE mode only)")
+    shadowDetectOnly = Param.Bool(False, "End the simulation when the "
+        "shadow checker finds the first difference")
+    dupOpClasses = Param.MinorOpClassSet(MinorOpClassSet(), "Op classes "
+        "of the instructions duplicated by Decode (software hardening by "
+        "instruction duplication, nothing is duplicated when empty)")
+    dupDetectExit = Param.Bool(False, "End the simulation when a "
+        "duplication check fails")
+    minorTraceFile = Param.String("", "Write MinorTrace to this binary "
+        "file in the output directory for minorview (no debug flag needed) "
+        "instead of the MinorTrace debug output")
\ No newline at end of file
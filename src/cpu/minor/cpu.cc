@@ -42,6 +42,7 @@
 #include "cpu/minor/dyn_inst.hh"
 #include "cpu/minor/fetch1.hh"
 #include "cpu/minor/pipeline.hh"
+#include "cpu/minor/trace_file.hh"
 #include "debug/Drain.hh"
 #include "debug/MinorCPU.hh"
 #include "debug/Quiesce.hh"
@@ -63,11 +64,17 @@ MinorCPU::MinorCPU(MinorCPUParams *params) :
     isFaultInjectedToFu(false),
     //YOHAN
     correctTime(params->correctTime),
-    correctRf(params->correctRf)
+    correctRf(params->correctRf),
+    rfParity(params->rfParity),
+    corruptedRead(false),
+    timingStats(params->timingStats)
 {
     //YOHAN
     Callback *cb = new MakeCallback<MinorCPU, &MinorCPU::exitCallback>(this);
     registerExitCallback(cb);
+
+    if (!params->minorTraceFile.empty())
+        Minor::TraceFile::open(params->minorTraceFile);
     
     /* This is only written for one thread at the moment */
     Minor::MinorThread *thread;
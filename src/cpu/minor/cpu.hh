@@ -134,6 +134,15 @@ class MinorCPU : public BaseCPU
     uint64_t correctTime;
     bool correctRf;
 
+    /** Is the integer register file parity protected? */
+    bool rfParity;
+
+    /** Has an instruction read the corrupted register yet? */
+    bool corruptedRead;
+
+    /** Count the occupancy, stall and redirect stats? */
+    bool timingStats;
+
     void exitCallback();    
 
     std::map<int, uint64_t> faultyRegs;
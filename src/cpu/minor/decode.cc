@@ -57,6 +57,7 @@ Decode::Decode(const std::string &name,
     nextStageReserve(next_stage_input_buffer),
     outputWidth(params.executeInputWidth),
     processMoreThanOneInput(params.decodeCycleInput),
+    dup(cpu_, params.dupOpClasses),
     decodeInfo(params.numThreads),
     threadPriority(0)
 {
@@ -119,6 +120,48 @@ dynInstAddTracing(MinorDynInstPtr inst, StaticInstPtr static_inst,
 }
 #endif
 
+void
+Decode::expandDup(ThreadID tid, MinorDynInstPtr inst,
+    StaticInstPtr parent_static_inst)
+{
+    DecodeThreadInfo &decode_info = decodeInfo[tid];
+    StaticInstPtr static_inst = inst->staticInst;
+
+    /* Inserted instructions share the id, PC and streams of inst but
+     *  carry no prediction */
+    auto insert = [&] (StaticInstPtr static_insert,
+        MinorDynInst::DupRole role)
+    {
+        MinorDynInstPtr inserted = new MinorDynInst(inst->id);
+        inserted->pc = inst->pc;
+        inserted->staticInst = static_insert;
+        inserted->dupRole = role;
+        inserted->id.execSeqNum = decode_info.execSeqNum++;
+        decode_info.dupOutput.push_back(inserted);
+    };
+
+    if (DupDecoder::needsCheck(static_inst))
+        insert(dup.check(static_inst), MinorDynInst::DupCheck);
+
+    bool duplicated = dup.duplicates(static_inst);
+
+    inst->id.execSeqNum = decode_info.execSeqNum++;
+    inst->dupRole = (duplicated ? MinorDynInst::DupMaster :
+        MinorDynInst::NotDuplicated);
+#if TRACING_ON
+    dynInstAddTracing(inst, parent_static_inst, cpu);
+#endif
+    decode_info.dupOutput.push_back(inst);
+
+    if (duplicated) {
+        insert(dup.duplicate(tid, static_inst, parent_static_inst,
+            inst->pc.microPC()), MinorDynInst::DupCopy);
+    }
+
+    DPRINTF(Decode, "Duplication expanded %s into %d instructions\n",
+        *inst, decode_info.dupOutput.size());
+}
+
 void
 Decode::evaluate()
 {
@@ -143,10 +186,22 @@ Decode::evaluate()
 
         /* Pack instructions into the output while we can.  This may involve
          * using more than one input line */
-        while (insts_in &&
-           decode_info.inputIndex < insts_in->width() && /* Still more input */
-           output_index < outputWidth /* Still more output to fill */)
+        while (output_index < outputWidth && /* Still more output to fill */
+           (!decode_info.dupOutput.empty() || /* Unfinished expansion */
+           (insts_in &&
+           decode_info.inputIndex < insts_in->width()))) /* More input */
         {
+            if (!decode_info.dupOutput.empty()) {
+                /* Finish the duplication expansion of an earlier
+                 *  instruction before taking more input */
+                if (output_index == 0) insts_out.resize(outputWidth);
+                insts_out.insts[output_index] =
+                    decode_info.dupOutput.front();
+                decode_info.dupOutput.pop_front();
+                output_index++;
+                continue;
+            }
+
             MinorDynInstPtr inst = insts_in->insts[decode_info.inputIndex];
 
             if (inst->isBubble()) {
@@ -236,15 +291,23 @@ Decode::evaluate()
                     decode_info.inMacroop = false;
                 }
 
-                /* Set execSeqNum of output_inst */
-                output_inst->id.execSeqNum = decode_info.execSeqNum;
-                /* Add tracing */
+                if (dup.enabled && !output_inst->isFault()) {
+                    /* Queue the instruction with its duplicate and check
+                     *  and pass on the first of them */
+                    expandDup(tid, output_inst, parent_static_inst);
+                    output_inst = decode_info.dupOutput.front();
+                    decode_info.dupOutput.pop_front();
+                } else {
+                    /* Set execSeqNum of output_inst */
+                    output_inst->id.execSeqNum = decode_info.execSeqNum;
+                    /* Add tracing */
 #if TRACING_ON
-                dynInstAddTracing(output_inst, parent_static_inst, cpu);
+                    dynInstAddTracing(output_inst, parent_static_inst, cpu);
 #endif
 
-                /* Step to next sequence number */
-                decode_info.execSeqNum++;
+                    /* Step to next sequence number */
+                    decode_info.execSeqNum++;
+                }
 
                 /* Correctly size the output before writing */
                 if (output_index == 0) insts_out.resize(outputWidth);
@@ -254,7 +317,7 @@ Decode::evaluate()
             }
 
             /* Have we finished with the input? */
-            if (decode_info.inputIndex == insts_in->width()) {
+            if (insts_in && decode_info.inputIndex == insts_in->width()) {
                 /* If we have just been producing micro-ops, we *must* have
                  * got to the end of that for inputIndex to be pushed past
                  * insts_in->width() */
@@ -290,7 +353,9 @@ Decode::evaluate()
      *  mark stage as active */
     for (ThreadID i = 0; i < cpu.numThreads; i++)
     {
-        if (getInput(i) && nextStageReserve[i].canReserve()) {
+        if ((getInput(i) || !decodeInfo[i].dupOutput.empty()) &&
+            nextStageReserve[i].canReserve())
+        {
             cpu.activityRecorder->activateStage(Pipeline::DecodeStageId);
             break;
         }
@@ -322,7 +387,9 @@ Decode::getScheduledThread()
     }
 
     for (auto tid : priority_list) {
-        if (getInput(tid) && !decodeInfo[tid].blocked) {
+        if ((getInput(tid) || !decodeInfo[tid].dupOutput.empty()) &&
+            !decodeInfo[tid].blocked)
+        {
             threadPriority = tid;
             return tid;
         }
@@ -339,6 +406,11 @@ Decode::isDrained()
             return false;
     }
 
+    for (const auto &info : decodeInfo) {
+        if (!info.dupOutput.empty())
+            return false;
+    }
+
     return (*inp.outputWire).isBubble();
 }
 
@@ -47,8 +47,11 @@
 #ifndef __CPU_MINOR_DECODE_HH__
 #define __CPU_MINOR_DECODE_HH__
 
+#include <deque>
+
 #include "cpu/minor/buffers.hh"
 #include "cpu/minor/cpu.hh"
+#include "cpu/minor/dup.hh"
 #include "cpu/minor/dyn_inst.hh"
 #include "cpu/minor/pipe_data.hh"
 
@@ -80,6 +83,9 @@ class Decode : public Named
      *  there is room in the output to contain its processed data */
     bool processMoreThanOneInput;
 
+    /** Instruction duplication model */
+    DupDecoder dup;
+
   public:
     /* Public for Pipeline to be able to pass it to Fetch2 */
     std::vector<InputBuffer<ForwardInstData>> inputBuffer;
@@ -101,7 +107,8 @@ class Decode : public Named
             inputIndex(other.inputIndex),
             inMacroop(other.inMacroop),
             execSeqNum(other.execSeqNum),
-            blocked(other.blocked)
+            blocked(other.blocked),
+            dupOutput(other.dupOutput)
         { }
 
 
@@ -122,6 +129,10 @@ class Decode : public Named
 
         /** Blocked indication for report */
         bool blocked;
+
+        /** Instructions of a duplication expansion (check, instruction,
+         *  duplicate) not yet passed to Execute */
+        std::deque<MinorDynInstPtr> dupOutput;
     };
 
     std::vector<DecodeThreadInfo> decodeInfo;
@@ -137,6 +148,11 @@ class Decode : public Named
     /** Use the current threading policy to determine the next thread to
      *  decode from. */
     ThreadID getScheduledThread();
+
+    /** Expand inst into the instructions of the duplication model, with
+     *  execSeqNums, onto the thread's dupOutput */
+    void expandDup(ThreadID tid, MinorDynInstPtr inst,
+        StaticInstPtr parent_static_inst);
   public:
     Decode(const std::string &name,
         MinorCPU &cpu_,
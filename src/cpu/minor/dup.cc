@@ -0,0 +1,462 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/minor/dup.hh"
+
+#include "base/cprintf.hh"
+#include "cpu/exec_context.hh"
+#include "cpu/minor/cpu.hh"
+#include "cpu/reg_class.hh"
+#include "cpu/thread_context.hh"
+#include "debug/FI.hh"
+#include "sim/sim_exit.hh"
+
+namespace Minor
+{
+
+DupCheckInst::DupCheckInst(const StaticInstPtr &guarded_) :
+    StaticInst("dupcheck", guarded_->machInst, IntAluOp),
+    guarded(guarded_)
+{
+    /* Never the last op of an instruction, so that nothing is taken
+     *  between the check and the guarded instruction */
+    flags[IsInteger] = true;
+    flags[IsMicroop] = true;
+
+    for (int i = 0; i < guarded->numSrcRegs(); i++) {
+        RegIndex reg = guarded->srcRegIdx(i);
+
+        if (reg < TheISA::Misc_Reg_Base)
+            _srcRegIdx[_numSrcRegs++] = reg;
+    }
+}
+
+std::string
+DupCheckInst::generateDisassembly(Addr pc, const SymbolTable *symtab) const
+{
+    return csprintf("%-10s %s", mnemonic, guarded->disassemble(pc, symtab));
+}
+
+DupDecoder::DupDecoder(MinorCPU &cpu_, MinorOpClassSet *op_classes) :
+    cpu(cpu_),
+    opClasses(op_classes),
+    enabled(!op_classes->opClasses.empty())
+{ }
+
+bool
+DupDecoder::duplicable(const StaticInstPtr &inst)
+{
+    if (inst->isMemRef() || inst->isControl() || inst->isSyscall() ||
+        inst->isSerializing() || inst->isNonSpeculative() ||
+        inst->isUnverifiable() || inst->isStoreConditional() ||
+        inst->isIprAccess() || inst->isQuiesce())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < inst->numDestRegs(); i++) {
+        if (inst->destRegIdx(i) >= TheISA::Misc_Reg_Base)
+            return false;
+    }
+    return true;
+}
+
+StaticInstPtr
+DupDecoder::duplicate(ThreadID tid, const StaticInstPtr &inst,
+    const StaticInstPtr &macroop, MicroPC upc)
+{
+    auto dup = dupInsts.find(macroop->machInst);
+
+    if (dup == dupInsts.end()) {
+        TheISA::Decoder *decoder = cpu.getContext(tid)->getDecoderPtr();
+
+        dup = dupInsts.insert(std::make_pair(macroop->machInst,
+            decoder->decodeInst(macroop->machInst))).first;
+    }
+
+    if (inst != macroop)
+        return dup->second->fetchMicroop(upc);
+    else
+        return dup->second;
+}
+
+StaticInstPtr
+DupDecoder::check(const StaticInstPtr &inst)
+{
+    StaticInstPtr &check = checkInsts[inst.get()];
+
+    if (!check)
+        check = new DupCheckInst(inst);
+    return check;
+}
+
+/** ExecContext executing a duplicate on the shadow registers.  Only
+ *  instructions without memory, control or miscellaneous register side
+ *  effects are duplicated (see DupDecoder::duplicable) */
+class DupExecContext : public ::ExecContext
+{
+  protected:
+    DupChecker &dup;
+
+    ThreadContext *tc;
+
+    MinorDynInstPtr inst;
+
+    union FloatRegUnion
+    {
+        TheISA::FloatReg f;
+        TheISA::FloatRegBits i;
+    };
+
+  public:
+    DupExecContext(DupChecker &dup_, ThreadContext *tc_,
+        MinorDynInstPtr inst_) :
+        dup(dup_), tc(tc_), inst(inst_)
+    { }
+
+    IntReg
+    readIntRegOperand(const StaticInst *si, int idx) override
+    {
+        return dup.intRegs[tc->flattenIntIndex(si->srcRegIdx(idx))];
+    }
+
+    void
+    setIntRegOperand(const StaticInst *si, int idx, IntReg val) override
+    {
+        dup.intRegs[tc->flattenIntIndex(si->destRegIdx(idx))] = val;
+    }
+
+    TheISA::FloatRegBits
+    readFloatRegOperandBits(const StaticInst *si, int idx) override
+    {
+        return dup.floatRegs[tc->flattenFloatIndex(si->srcRegIdx(idx) -
+            TheISA::FP_Reg_Base)];
+    }
+
+    TheISA::FloatReg
+    readFloatRegOperand(const StaticInst *si, int idx) override
+    {
+        FloatRegUnion val;
+        val.i = readFloatRegOperandBits(si, idx);
+        return val.f;
+    }
+
+    void
+    setFloatRegOperandBits(const StaticInst *si, int idx,
+        TheISA::FloatRegBits val) override
+    {
+        dup.floatRegs[tc->flattenFloatIndex(si->destRegIdx(idx) -
+            TheISA::FP_Reg_Base)] = val;
+    }
+
+    void
+    setFloatRegOperand(const StaticInst *si, int idx,
+        TheISA::FloatReg val) override
+    {
+        FloatRegUnion bits;
+        bits.f = val;
+        setFloatRegOperandBits(si, idx, bits.i);
+    }
+
+    TheISA::CCReg
+    readCCRegOperand(const StaticInst *si, int idx) override
+    {
+        return dup.ccRegs[tc->flattenCCIndex(si->srcRegIdx(idx) -
+            TheISA::CC_Reg_Base)];
+    }
+
+    void
+    setCCRegOperand(const StaticInst *si, int idx, TheISA::CCReg val) override
+    {
+        dup.ccRegs[tc->flattenCCIndex(si->destRegIdx(idx) -
+            TheISA::CC_Reg_Base)] = val;
+    }
+
+    TheISA::MiscReg
+    readMiscReg(int misc_reg) override
+    {
+        return tc->readMiscReg(misc_reg);
+    }
+
+    void
+    setMiscReg(int misc_reg, const TheISA::MiscReg &val) override
+    {
+        panic("Duplicate %s writes a misc register\n", *inst);
+    }
+
+    TheISA::MiscReg
+    readMiscRegOperand(const StaticInst *si, int idx) override
+    {
+        return readMiscReg(si->srcRegIdx(idx) - TheISA::Misc_Reg_Base);
+    }
+
+    void
+    setMiscRegOperand(const StaticInst *si, int idx,
+        const TheISA::MiscReg &val) override
+    {
+        setMiscReg(si->destRegIdx(idx) - TheISA::Misc_Reg_Base, val);
+    }
+
+    TheISA::PCState pcState() const override { return inst->pc; }
+    void pcState(const TheISA::PCState &val) override { }
+
+    void setEA(Addr ea) override { }
+    Addr getEA() const override { return 0; }
+
+    Fault
+    readMem(Addr addr, uint8_t *data, unsigned int size,
+        Request::Flags flags) override
+    {
+        panic("Duplicate %s accesses memory\n", *inst);
+    }
+
+    Fault
+    writeMem(uint8_t *data, unsigned int size, Addr addr,
+        Request::Flags flags, uint64_t *res) override
+    {
+        panic("Duplicate %s accesses memory\n", *inst);
+    }
+
+    unsigned int readStCondFailures() const override { return 0; }
+    void setStCondFailures(unsigned int st_cond_failures) override { }
+
+    void
+    syscall(int64_t callnum) override
+    {
+        panic("Duplicate %s is a syscall\n", *inst);
+    }
+
+    ThreadContext *tcBase() override { return tc; }
+
+    Fault hwrei() override { return NoFault; }
+    bool simPalCheck(int palFunc) override { return false; }
+
+    bool readPredicate() override { return true; }
+    void setPredicate(bool val) override { }
+
+    void demapPage(Addr vaddr, uint64_t asn) override { }
+    void armMonitor(Addr address) override { }
+    bool mwait(PacketPtr pkt) override { return false; }
+    void mwaitAtomic(ThreadContext *tc) override { }
+
+    AddressMonitor *
+    getAddrMonitor() override
+    {
+        return dup.cpu.getCpuAddrMonitor(dup.tid);
+    }
+
+#if THE_ISA == MIPS_ISA
+    MiscReg
+    readRegOtherThread(int regIdx, ThreadID tid = InvalidThreadID) override
+    {
+        panic("Duplicates can't access other threads\n");
+    }
+
+    void
+    setRegOtherThread(int regIdx, MiscReg val,
+        ThreadID tid = InvalidThreadID) override
+    {
+        panic("Duplicates can't access other threads\n");
+    }
+#endif
+};
+
+DupChecker::DupChecker(MinorCPU &cpu_, ThreadID tid_, bool detect_exit) :
+    cpu(cpu_),
+    tid(tid_),
+    detectExit(detect_exit),
+    started(false),
+    dupPending(false),
+    detected(false),
+    intRegs(TheISA::NumIntRegs),
+    floatRegs(TheISA::NumFloatRegs),
+    ccRegs(TheISA::NumCCRegs)
+{ }
+
+Fault
+DupChecker::executeDup(MinorDynInstPtr inst)
+{
+    /* The master faulted or checking has stopped, nothing to duplicate */
+    if (!dupPending || detected)
+        return NoFault;
+
+    DupExecContext context(*this, cpu.getContext(tid), inst);
+    Fault fault = inst->staticInst->execute(&context, NULL);
+
+    /* The duplicate's fault is never taken, it is a detection */
+    if (fault != NoFault)
+        detect(inst, csprintf("duplicate raised fault %s", fault->name()));
+
+    return NoFault;
+}
+
+void
+DupChecker::commit(MinorDynInstPtr inst, Fault fault)
+{
+    if (detected)
+        return;
+
+    if (!started) {
+        reload();
+        started = true;
+    }
+
+    if (fault != NoFault) {
+        /* Faults change the registers in ways the duplicates don't see */
+        reload();
+        dupPending = false;
+        return;
+    }
+
+    switch (inst->dupRole) {
+      case MinorDynInst::DupCheck:
+        {
+            const DupCheckInst *check =
+                dynamic_cast<const DupCheckInst *>(inst->staticInst.get());
+            assert(check);
+
+            cpu.stats.dupChecks++;
+            std::string diff = checkSources(check->guarded);
+            if (diff != "")
+                detect(inst, diff);
+        }
+        break;
+      case MinorDynInst::DupCopy:
+        cpu.stats.dupInsts++;
+        dupPending = false;
+        break;
+      default:
+        /* The duplicate of the previous instruction didn't arrive */
+        if (dupPending) {
+            reload();
+            dupPending = false;
+        }
+
+        if (inst->staticInst->isSyscall() ||
+            inst->staticInst->isSerializing() ||
+            inst->staticInst->isNonSpeculative())
+        {
+            reload();
+        } else if (inst->dupRole == MinorDynInst::DupMaster) {
+            dupPending = true;
+        } else {
+            copyDests(inst->staticInst);
+        }
+        break;
+    }
+}
+
+void
+DupChecker::reload()
+{
+    ThreadContext *tc = cpu.getContext(tid);
+
+    for (int i = 0; i < TheISA::NumIntRegs; i++)
+        intRegs[i] = tc->readIntRegFlat(i);
+    for (int i = 0; i < TheISA::NumFloatRegs; i++)
+        floatRegs[i] = tc->readFloatRegBitsFlat(i);
+    for (int i = 0; i < TheISA::NumCCRegs; i++)
+        ccRegs[i] = tc->readCCRegFlat(i);
+}
+
+void
+DupChecker::copyDests(const StaticInstPtr &inst)
+{
+    ThreadContext *tc = cpu.getContext(tid);
+
+    for (int i = 0; i < inst->numDestRegs(); i++) {
+        TheISA::RegIndex reg = inst->destRegIdx(i);
+        int flat;
+
+        switch (regIdxToClass(reg, &reg)) {
+          case IntRegClass:
+            flat = tc->flattenIntIndex(reg);
+            intRegs[flat] = tc->readIntRegFlat(flat);
+            break;
+          case FloatRegClass:
+            flat = tc->flattenFloatIndex(reg);
+            floatRegs[flat] = tc->readFloatRegBitsFlat(flat);
+            break;
+          case CCRegClass:
+            flat = tc->flattenCCIndex(reg);
+            ccRegs[flat] = tc->readCCRegFlat(flat);
+            break;
+          default:
+            break;
+        }
+    }
+}
+
+std::string
+DupChecker::checkSources(const StaticInstPtr &inst)
+{
+    ThreadContext *tc = cpu.getContext(tid);
+
+    for (int i = 0; i < inst->numSrcRegs(); i++) {
+        TheISA::RegIndex reg = inst->srcRegIdx(i);
+        int flat;
+
+        switch (regIdxToClass(reg, &reg)) {
+          case IntRegClass:
+            flat = tc->flattenIntIndex(reg);
+            if (intRegs[flat] != tc->readIntRegFlat(flat)) {
+                return csprintf("int reg %d: %#x, shadow %#x", flat,
+                    tc->readIntRegFlat(flat), intRegs[flat]);
+            }
+            break;
+          case FloatRegClass:
+            flat = tc->flattenFloatIndex(reg);
+            if (floatRegs[flat] != tc->readFloatRegBitsFlat(flat)) {
+                return csprintf("float reg %d: %#x, shadow %#x", flat,
+                    tc->readFloatRegBitsFlat(flat), floatRegs[flat]);
+            }
+            break;
+          case CCRegClass:
+            flat = tc->flattenCCIndex(reg);
+            if (ccRegs[flat] != tc->readCCRegFlat(flat)) {
+                return csprintf("CC reg %d: %#x, shadow %#x", flat,
+                    tc->readCCRegFlat(flat), ccRegs[flat]);
+            }
+            break;
+          default:
+            break;
+        }
+    }
+    return "";
+}
+
+void
+DupChecker::detect(MinorDynInstPtr inst, const std::string &what)
+{
+    detected = true;
+    cpu.stats.dupDetections++;
+
+    DPRINTF(FI, "Duplication check failed at %s: %s\n", *inst, what);
+
+    if (detectExit)
+        exitSimLoop("fault detected by duplication check");
+}
+
+}
@@ -0,0 +1,193 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *
+ *  Model of software-implemented hardening by instruction duplication
+ *  (SWIFT/EDDI style).  Decode expands the selected instructions into
+ *  the instruction and a duplicate working on shadow registers, and puts
+ *  a compare of the master and shadow registers in front of each store,
+ *  branch and system call.  Execute runs the duplicates and the compares
+ *  against the shadow registers held by DupChecker.
+ */
+
+#ifndef __CPU_MINOR_DUP_HH__
+#define __CPU_MINOR_DUP_HH__
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "arch/registers.hh"
+#include "cpu/decode_cache.hh"
+#include "cpu/minor/dyn_inst.hh"
+#include "cpu/minor/func_unit.hh"
+#include "cpu/static_inst.hh"
+
+class MinorCPU;
+
+namespace Minor
+{
+
+/** Compare inserted before a synchronisation point.  Its sources are the
+ *  sources of the guarded instruction so that it waits for them like the
+ *  guarded instruction would.  The compare itself is done by DupChecker
+ *  as the ExecContext only has the master registers */
+class DupCheckInst : public StaticInst
+{
+  public:
+    /** The instruction whose sources are checked */
+    const StaticInstPtr guarded;
+
+  public:
+    DupCheckInst(const StaticInstPtr &guarded_);
+
+    Fault
+    execute(ExecContext *xc, Trace::InstRecord *traceData) const override
+    {
+        return NoFault;
+    }
+
+    /** The guarded instruction has the same PC */
+    void advancePC(TheISA::PCState &pc) const override { }
+
+    std::string generateDisassembly(Addr pc,
+        const SymbolTable *symtab) const override;
+};
+
+/** Decode-time part of the model: selects the instructions to duplicate
+ *  and to check and provides their StaticInsts.  Duplicates are decoded
+ *  again from the machine instruction into private StaticInsts, so that a
+ *  fault injected into the decoded master instruction doesn't also
+ *  affect its duplicate.  Both are cached, runs without duplication only
+ *  pay for testing enabled */
+class DupDecoder
+{
+  protected:
+    MinorCPU &cpu;
+
+    /** Op classes of the duplicated instructions */
+    MinorOpClassSet *opClasses;
+
+    /** Private copies of the (macro-op) instructions, by machInst */
+    DecodeCache::InstMap dupInsts;
+
+    /** Compare instructions by guarded instruction */
+    std::unordered_map<const StaticInst *, StaticInstPtr> checkInsts;
+
+  public:
+    /** Is any instruction duplicated? */
+    const bool enabled;
+
+  public:
+    DupDecoder(MinorCPU &cpu_, MinorOpClassSet *op_classes);
+
+    /** Can inst be duplicated?  Instructions with side effects outside
+     *  the integer, float and CC registers can't */
+    static bool duplicable(const StaticInstPtr &inst);
+
+    /** Is inst a synchronisation point which needs a check */
+    static bool
+    needsCheck(const StaticInstPtr &inst)
+    {
+        return inst->isStore() || inst->isControl() || inst->isSyscall();
+    }
+
+    /** Is inst duplicated */
+    bool
+    duplicates(const StaticInstPtr &inst)
+    {
+        return opClasses->provides(inst->opClass()) && duplicable(inst);
+    }
+
+    /** The duplicate of inst, macroop is inst's macro-op (or inst) and
+     *  upc its micro PC in macroop */
+    StaticInstPtr duplicate(ThreadID tid, const StaticInstPtr &inst,
+        const StaticInstPtr &macroop, MicroPC upc);
+
+    /** The compare in front of inst */
+    StaticInstPtr check(const StaticInstPtr &inst);
+};
+
+/** Execute-time part of the model for one thread: the shadow registers.
+ *  The shadow registers are updated by the duplicates, the results of
+ *  all other instructions are copied to them at commit as a compiler
+ *  would copy loaded values into the shadow registers */
+class DupChecker
+{
+  protected:
+    friend class DupExecContext;
+
+    MinorCPU &cpu;
+
+    ThreadID tid;
+
+    /** End the simulation at the first detection */
+    bool detectExit;
+
+    /** The shadow registers have been initialised */
+    bool started;
+
+    /** A duplicated instruction has committed, its duplicate is next */
+    bool dupPending;
+
+    /** A check failed, no more checking */
+    bool detected;
+
+    /** Shadow registers, indexed by flattened register index */
+    std::vector<TheISA::IntReg> intRegs;
+    std::vector<TheISA::FloatRegBits> floatRegs;
+    std::vector<TheISA::CCReg> ccRegs;
+
+  public:
+    DupChecker(MinorCPU &cpu_, ThreadID tid_, bool detect_exit);
+
+    /** Execute the duplicate inst on the shadow registers in place of
+     *  the thread's registers */
+    Fault executeDup(MinorDynInstPtr inst);
+
+    /** Account for a committed instruction, fault is the fault it
+     *  raised */
+    void commit(MinorDynInstPtr inst, Fault fault);
+
+  protected:
+    /** Copy the thread's registers into the shadow registers */
+    void reload();
+
+    /** Copy the registers written by inst into the shadow registers */
+    void copyDests(const StaticInstPtr &inst);
+
+    /** Compare the master and shadow copies of inst's sources.
+     *  @return Description of the first difference, or "" */
+    std::string checkSources(const StaticInstPtr &inst);
+
+    /** Report a failed check */
+    void detect(MinorDynInstPtr inst, const std::string &what);
+};
+
+}
+
+#endif /* __CPU_MINOR_DUP_HH__ */
@@ -255,6 +255,18 @@ class MinorDynInst : public RefCounted
     /** Effective address as set by ExecContext::setEA */
     Addr ea;
 
+    /** Part played in the duplication model (see dup.hh): a duplicated
+     *  instruction, its duplicate or a compare inserted by Decode */
+    enum DupRole
+    {
+        NotDuplicated,
+        DupMaster,
+        DupCopy,
+        DupCheck
+    };
+
+    DupRole dupRole;
+
   public:
     MinorDynInst(InstId id_ = InstId(), Fault fault_ = NoFault) :
         staticInst(NULL), id(id_), traceData(NULL),
@@ -264,13 +276,20 @@ class MinorDynInst : public RefCounted
         canEarlyIssue(false),
         instToWaitFor(0), extraCommitDelay(Cycles(0)),
         extraCommitDelayExpr(NULL), minimumCommitCycle(Cycles(0)),
-        ea(0)
+        ea(0), dupRole(NotDuplicated)
     { }
 
   public:
     /** The BubbleIF interface. */
     bool isBubble() const { return id.fetchSeqNum == 0; }
 
+    /** Is this instruction inserted by the duplication model */
+    bool
+    isDupInserted() const
+    {
+        return dupRole == DupCopy || dupRole == DupCheck;
+    }
+
     /** There is a single bubble inst */
     static MinorDynInstPtr bubble() { return bubbleInst; }
 
@@ -59,6 +59,7 @@
 #include "cpu/base.hh"
 #include "cpu/simple_thread.hh"
 #include "mem/request.hh"
+#include "sim/stat_sampler.hh"
 #include "debug/MinorExecute.hh"
 #include "debug/FI.hh" //YOHAN
 
@@ -108,6 +109,9 @@ class ExecContext : public ::ExecContext
     initiateMemRead(Addr addr, unsigned int size,
                     Request::Flags flags) override
     {
+        if (ShadowChecker *shadow = execute.getShadow(inst->id.threadId))
+            shadow->recordAccess(inst, false, addr, size, NULL);
+
         execute.getLSQ().pushRequest(inst, true /* load */, nullptr,
             size, addr, flags, NULL);
         return NoFault;
@@ -117,6 +121,9 @@ class ExecContext : public ::ExecContext
     writeMem(uint8_t *data, unsigned int size, Addr addr,
              Request::Flags flags, uint64_t *res) override
     {
+        if (ShadowChecker *shadow = execute.getShadow(inst->id.threadId))
+            shadow->recordAccess(inst, true, addr, size, data);
+
         execute.getLSQ().pushRequest(inst, false /* store */, data,
             size, addr, flags, res);
         return NoFault;
@@ -127,17 +134,26 @@ class ExecContext : public ::ExecContext
     {
         //YOHAN: Behaviors of corrupted register
         uint64_t flipped_data;
+        if (cpu.rfParity)
+            cpu.stats.rfParityChecks++;
         if(cpu.traceReg && (cpu.injectLoc/32) == si->srcRegIdx(idx)) {
             DPRINTF(FI, "Corrupted reg %d is read by %s %#x\n", si->srcRegIdx(idx), si->getName(), inst->id);
+            if (cpu.rfParity)
+                cpu.stats.rfParityErrors++;
             //DPRINTF(FI, "inst id is %#x, machInst is %#x\n", inst->id, inst->staticInst->machInst);
             //cpu.traceReg = false;
             cpu.instRead = true;
+            if (!cpu.corruptedRead) {
+                cpu.corruptedRead = true;
+                StatSampler::mark("corrupted_read");
+            }
             flipped_data = thread.readIntReg(si->srcRegIdx(idx));
             //cpu.instRead = true;
             if(curTick() >= cpu.correctTime && cpu.correctRf) {
                 cpu.traceReg = false;
                 thread.setIntReg(si->srcRegIdx(idx), cpu.originalRegData);
                 DPRINTF(FI, "Corrupted reg %d is corrected\n", si->srcRegIdx(idx));
+                cpu.stats.rfCorrections++;
             }
         }
         
@@ -164,6 +180,8 @@ class ExecContext : public ::ExecContext
     void
     setIntRegOperand(const StaticInst *si, int idx, IntReg val) override
     {
+        if (cpu.rfParity)
+            cpu.stats.rfParityUpdates++;
         //YOHAN: Behaviors of corrupted register
         if(cpu.traceReg && (cpu.injectLoc/32) == si->destRegIdx(idx)) {
             DPRINTF(FI, "Corrupted reg %d is overwritten by %s\n", si->destRegIdx(idx), si->getName());
@@ -228,6 +246,9 @@ class ExecContext : public ::ExecContext
     void
     setMiscReg(int misc_reg, const TheISA::MiscReg &val) override
     {
+        if (ShadowChecker *shadow = execute.getShadow(inst->id.threadId))
+            shadow->recordMiscWrite(misc_reg, val);
+
         thread.setMiscReg(misc_reg, val);
     }
 
@@ -243,6 +264,10 @@ class ExecContext : public ::ExecContext
         const TheISA::MiscReg &val) override
     {
         int reg_idx = si->destRegIdx(idx) - TheISA::Misc_Reg_Base;
+
+        if (ShadowChecker *shadow = execute.getShadow(inst->id.threadId))
+            shadow->recordMiscWrite(reg_idx, val);
+
         return thread.setMiscReg(reg_idx, val);
     }
 
@@ -197,6 +197,18 @@ Execute::Execute(const std::string &name_,
         executeInfo[tid].inFUMemInsts = new Queue<QueuedInst,
             ReportTraitsAdaptor<QueuedInst> >(
             name_ + ".inFUMemInsts" + tid_str, "insts", total_slots);
+
+        /* Golden shadows, started by startShadow */
+        if (params.shadowCheck) {
+            shadows.push_back(new ShadowChecker(cpu_, tid,
+                params.shadowDetectOnly));
+        }
+
+        /* Shadow registers of the duplication model */
+        if (!params.dupOpClasses->opClasses.empty()) {
+            dups.push_back(new DupChecker(cpu_, tid,
+                params.dupDetectExit));
+        }
     }
 }
 
@@ -311,8 +323,11 @@ Execute::updateBranchData(
 {
     if (reason != BranchData::NoBranch) {
         /* Bump up the stream sequence number on a real branch*/
-        if (BranchData::isStreamChange(reason))
+        if (BranchData::isStreamChange(reason)) {
             executeInfo[tid].streamSeqNum++;
+            if (cpu.timingStats)
+                cpu.stats.fetchRedirects++;
+        }
 
         /* Branches (even mis-predictions) don't change the predictionSeqNum,
          *  just the streamSeqNum */
@@ -339,6 +354,11 @@ Execute::handleMemResponse(MinorDynInstPtr inst,
 
     PacketPtr packet = response->packet;
 
+    /* The shadow runs the instruction before it changes any state */
+    ShadowChecker *shadow = getShadow(thread_id);
+    if (shadow && response->fault == NoFault)
+        shadow->execute(inst, packet);
+
     bool is_load = inst->staticInst->isLoad();
     bool is_store = inst->staticInst->isStore();
     bool is_prefetch = inst->staticInst->isDataPrefetch();
@@ -412,6 +432,16 @@ Execute::handleMemResponse(MinorDynInstPtr inst,
 
     doInstCommitAccounting(inst);
 
+    if (shadow) {
+        if (response->fault != NoFault)
+            shadow->faultInst(inst);
+        else
+            shadow->compare(inst, fault);
+    }
+
+    if (!dups.empty())
+        dups[thread_id]->commit(inst, fault);
+
     /* Generate output to account for branches */
     tryToBranch(inst, fault, branch);
 }
@@ -581,6 +611,7 @@ Execute::issue(ThreadID thread_id)
         Fault fault = inst->fault;
         bool discarded = false;
         bool issued_mem_ref = false;
+        bool scoreboard_stall = false;
 
         if (inst->isBubble()) {
             /* Skip */
@@ -685,6 +716,7 @@ Execute::issue(ThreadID thread_id)
                     {
                         DPRINTF(MinorExecute, "Can't issue inst: %s yet\n",
                             *inst);
+                        scoreboard_stall = true;
                     } else {
                         /* Can insert the instruction into this FU */
                         DPRINTF(MinorExecute, "Issuing inst: %s"
@@ -778,14 +810,17 @@ Execute::issue(ThreadID thread_id)
                 fu_index++;
             } while (fu_index != numFuncUnits && !issued);
 
-            if (!issued)
+            if (!issued) {
                 DPRINTF(MinorExecute, "Didn't issue inst: %s\n", *inst);
+                if (scoreboard_stall && cpu.timingStats)
+                    cpu.stats.scoreboardStalls++;
+            }
         }
 
         if (issued) {
             /* Generate MinorTrace's MinorInst lines.  Do this at commit
              *  to allow better instruction annotation? */
-            if (DTRACE(MinorTrace) && !inst->isBubble())
+            if (minorTraceOn() && !inst->isBubble())
                 inst->minorTraceInst(*this);
 
             /* Mark up barriers in the LSQ */
@@ -921,6 +956,12 @@ Execute::commitInst(MinorDynInstPtr inst, bool early_memory_issue,
         fault = inst->fault;
         inst->fault->invoke(thread, NULL);
 
+        if (ShadowChecker *shadow = getShadow(thread_id))
+            shadow->faultInst(inst);
+
+        if (!dups.empty())
+            dups[thread_id]->commit(inst, fault);
+
         tryToBranch(inst, fault, branch);
     } else if (inst->staticInst->isMemRef()) {
         /* Memory accesses are executed in two parts:
@@ -952,8 +993,20 @@ Execute::commitInst(MinorDynInstPtr inst, bool early_memory_issue,
             } else {
                 DPRINTF(MinorExecute, "Fault in execute: %s\n",
                     fault->name());
+
+                /* Check that the golden instruction faults too */
+                ShadowChecker *shadow = getShadow(thread_id);
+                if (shadow)
+                    shadow->execute(inst);
+
                 fault->invoke(thread, NULL);
 
+                if (shadow)
+                    shadow->compare(inst, fault);
+
+                if (!dups.empty())
+                    dups[thread_id]->commit(inst, fault);
+
                 tryToBranch(inst, fault, branch);
                 completed_inst = true;
             }
@@ -978,8 +1031,19 @@ Execute::commitInst(MinorDynInstPtr inst, bool early_memory_issue,
 
         DPRINTF(MinorExecute, "Committing inst: %s\n", *inst);
 
-        fault = inst->staticInst->execute(&context,
-            inst->traceData);
+        /* Instructions inserted by the duplication model have no
+         *  golden counterpart */
+        ShadowChecker *shadow = (inst->isDupInserted() ? NULL :
+            getShadow(thread_id));
+        if (shadow)
+            shadow->execute(inst);
+
+        if (inst->dupRole == MinorDynInst::DupCopy) {
+            fault = dups[thread_id]->executeDup(inst);
+        } else {
+            fault = inst->staticInst->execute(&context,
+                inst->traceData);
+        }
 
         /* Set the predicate for tracing and dump */
         if (inst->traceData)
@@ -993,8 +1057,19 @@ Execute::commitInst(MinorDynInstPtr inst, bool early_memory_issue,
             fault->invoke(thread, inst->staticInst);
         }
 
-        doInstCommitAccounting(inst);
-        tryToBranch(inst, fault, branch);
+        if (!dups.empty())
+            dups[thread_id]->commit(inst, fault);
+
+        /* Duplicates and checks aren't program instructions and share
+         *  the PC of the instruction they belong to */
+        if (!inst->isDupInserted()) {
+            doInstCommitAccounting(inst);
+
+            if (shadow)
+                shadow->compare(inst, fault);
+
+            tryToBranch(inst, fault, branch);
+        }
     }
 
     if (completed_inst) {
@@ -1399,7 +1474,7 @@ Execute::commit(ThreadID thread_id, bool only_commit_microops, bool discard,
 
             /* Don't show no cost instructions as having taken a commit
              *  slot */
-            if (DTRACE(MinorTrace) && !is_no_cost_inst)
+            if (minorTraceOn() && !is_no_cost_inst)
                 ex_info.instsBeingCommitted.insts[num_insts_committed] = inst;
 
             if (!is_no_cost_inst)
@@ -1445,6 +1520,14 @@ Execute::evaluate()
 
     unsigned int num_issued = 0;
 
+    if (cpu.timingStats) {
+        for (ThreadID tid = 0; tid < cpu.numThreads; tid++) {
+            cpu.stats.executeOccupancy +=
+                executeInfo[tid].inFlightInsts->occupiedSpace();
+        }
+        cpu.stats.lsqOccupancy += lsq.occupancy();
+    }
+
     /* Do all the cycle-wise activities for dcachePort here to potentially
      *  free up input spaces in the LSQ's requests queue */
     lsq.step();
@@ -1884,6 +1967,12 @@ Execute::~Execute()
 
     for (ThreadID tid = 0; tid < cpu.numThreads; tid++)
         delete executeInfo[tid].inFlightInsts;
+
+    for (auto shadow : shadows)
+        delete shadow;
+
+    for (auto dup : dups)
+        delete dup;
 }
 
 bool
@@ -1937,6 +2026,13 @@ bool Execute::injReady() const {
     return injRegistered && (!injDone) && (curTick() >= injTime);
 }
 
+void
+Execute::startShadow()
+{
+    for (auto shadow : shadows)
+        shadow->start();
+}
+
 // JONGHO
 void Execute::printAllFU(std::ostream& os) const {
 
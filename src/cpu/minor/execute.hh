@@ -49,10 +49,12 @@
 
 #include "cpu/minor/buffers.hh"
 #include "cpu/minor/cpu.hh"
+#include "cpu/minor/dup.hh"
 #include "cpu/minor/func_unit.hh"
 #include "cpu/minor/lsq.hh"
 #include "cpu/minor/pipe_data.hh"
 #include "cpu/minor/scoreboard.hh"
+#include "cpu/minor/shadow.hh"
 
 namespace Minor
 {
@@ -121,6 +123,13 @@ class Execute : public Named
     /** The execution functional units */
     std::vector<FUPipeline *> funcUnits;
 
+    /** Golden shadow checkers, one per thread (only with shadowCheck) */
+    std::vector<ShadowChecker *> shadows;
+
+    /** Duplication model shadow registers, one per thread (only with
+     *  dupOpClasses) */
+    std::vector<DupChecker *> dups;
+
   // JONGHO
   public:
     void printAllFU(std::ostream& os) const;
@@ -336,6 +345,18 @@ class Execute : public Named
     /** To allow ExecContext to find the LSQ */
     LSQ &getLSQ() { return lsq; }
 
+    /** The thread's shadow checker if it is checking instructions, to
+     *  allow ExecContext to record the pipeline's side effects */
+    ShadowChecker *
+    getShadow(ThreadID thread_id)
+    {
+        return (shadows.empty() || !shadows[thread_id]->active() ? NULL :
+            shadows[thread_id]);
+    }
+
+    /** Start the shadow checkers (if any) from the current state */
+    void startShadow();
+
     /** Does the given instruction have the right stream sequence number
      *  to be committed? */
     bool instIsRightStream(MinorDynInstPtr inst);
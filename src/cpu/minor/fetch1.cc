@@ -260,7 +260,7 @@ Fetch1::handleTLBResponse(FetchRequestPtr response)
             (response->request.hasPaddr() ? response->request.getPaddr() : 0),
             response->request.getVaddr());
 
-        if (DTRACE(MinorTrace))
+        if (minorTraceOn())
             minorTraceResponseLine(name(), response);
     } else {
         DPRINTF(Fetch, "Got ITLB response\n");
@@ -429,7 +429,7 @@ Fetch1::recvTimingResp(PacketPtr response)
     numFetchesInMemorySystem--;
     fetch_request->state = FetchRequest::Complete;
 
-    if (DTRACE(MinorTrace))
+    if (minorTraceOn())
         minorTraceResponseLine(name(), fetch_request);
 
     if (response->isError()) {
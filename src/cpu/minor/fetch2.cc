@@ -477,7 +477,7 @@ Fetch2::evaluate()
 
                 /* Output MinorTrace instruction info for
                  *  pre-microop decomposition macroops */
-                if (DTRACE(MinorTrace) && !dyn_inst->isFault() &&
+                if (minorTraceOn() && !dyn_inst->isFault() &&
                     dyn_inst->staticInst->isMacroop())
                 {
                     dyn_inst->minorTraceInst(*this);
@@ -679,6 +679,15 @@ class LSQ : public Named
     /** Must check this before trying to insert into the store buffer */
     bool canPushIntoStoreBuffer() const { return storeBuffer.canInsert(); }
 
+    /** Number of requests in the requests and transfers queues and the
+     *  store buffer */
+    unsigned int
+    occupancy() const
+    {
+        return requests.occupiedSpace() + transfers.occupiedSpace() +
+            storeBuffer.slots.size();
+    }
+
     /** A store has been committed, please move it to the store buffer */
     void sendStoreToStoreBuffer(LSQRequestPtr request);
 
@@ -53,6 +53,7 @@
 // JONGHO
 #include "base/softerror.hh"
 #include "debug/PrintAllFU.hh"
+#include "sim/stat_sampler.hh"
 
 namespace Minor
 {
@@ -86,7 +87,8 @@ Pipeline::Pipeline(MinorCPU &cpu_, MinorCPUParams &params) :
         std::max(params.fetch2ToDecodeForwardDelay,
         std::max(params.decodeToExecuteForwardDelay,
         params.executeBranchDelay)))),
-    needToSignalDrained(false)
+    needToSignalDrained(false),
+    faultCounted(false)
 {
     // JONGHO: Print all FUs if the debug flag "PrintAllFU" is set
     if(DTRACE(PrintAllFU)) {
@@ -132,6 +134,14 @@ Pipeline::Pipeline(MinorCPU &cpu_, MinorCPUParams &params) :
     }
 }
 
+bool
+Pipeline::faultInjected() const
+{
+    return cpu.injectReg || cpu.isFaultInjectedToFu ||
+        fetch1.injDone || fetch2.injDone || execute.injDone ||
+        (SoftError::injDone && SoftError::injComp == SoftError::F2TOD);
+}
+
 void
 Pipeline::minorTrace() const
 {
@@ -167,6 +177,11 @@ Pipeline::evaluate()
         }
     }
     */
+
+    /* The golden shadow must copy the state before any fault is injected */
+    if (curTick() >= cpu.injectTime)
+        execute.startShadow();
+
     cpu.injectFaultRegFunc();
 	
 	//HwiSoo, Temporal checking for lsq values
@@ -186,7 +201,7 @@ Pipeline::evaluate()
     fetch2.evaluate();
     fetch1.evaluate();
 
-    if (DTRACE(MinorTrace))
+    if (minorTraceOn())
         minorTrace();
 
     /* Update the time buffers after the stages */
@@ -196,6 +211,12 @@ Pipeline::evaluate()
     dToE.evaluate();
     eToF1.evaluate();
 
+    if (!faultCounted && faultInjected()) {
+        cpu.stats.faultsInjected++;
+        faultCounted = true;
+        StatSampler::mark("injection");
+    }
+
     /* The activity recorder must be be called after all the stages and
      *  before the idler (which acts on the advice of the activity recorder */
     activityRecorder.evaluate();
@@ -106,6 +106,13 @@ class Pipeline : public Ticked
     /** True after drain is called but draining isn't complete */
     bool needToSignalDrained;
 
+    /** Has the injected fault been counted in faultsInjected? */
+    bool faultCounted;
+
+  protected:
+    /** Has a fault been injected into any of the CPU components? */
+    bool faultInjected() const;
+
   public:
     Pipeline(MinorCPU &cpu_, MinorCPUParams &params);
 
@@ -0,0 +1,677 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/minor/shadow.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "arch/utility.hh"
+#include "base/cprintf.hh"
+#include "base/softerror.hh"
+#include "cpu/base.hh"
+#include "cpu/exec_context.hh"
+#include "cpu/minor/cpu.hh"
+#include "cpu/thread_context.hh"
+#include "debug/FI.hh"
+#include "mem/se_translating_port_proxy.hh"
+#include "sim/full_system.hh"
+#include "sim/sim_exit.hh"
+
+namespace Minor
+{
+
+/** ExecContext executing an instruction on the shadow state.  Registers
+ *  come from the shadow, everything else is read from the thread, which
+ *  is still in the state before the instruction */
+class ShadowExecContext : public ::ExecContext
+{
+  protected:
+    ShadowChecker &shadow;
+
+    ThreadContext *tc;
+
+    /** Miscellaneous registers written by this instruction */
+    std::map<int, TheISA::MiscReg> miscRegs;
+
+    Addr ea;
+
+    union FloatRegUnion
+    {
+        TheISA::FloatReg f;
+        TheISA::FloatRegBits i;
+    };
+
+  public:
+    ShadowExecContext(ShadowChecker &shadow_, ThreadContext *tc_) :
+        shadow(shadow_), tc(tc_), ea(0)
+    { }
+
+    IntReg
+    readIntRegOperand(const StaticInst *si, int idx) override
+    {
+        return shadow.intRegs[tc->flattenIntIndex(si->srcRegIdx(idx))];
+    }
+
+    void
+    setIntRegOperand(const StaticInst *si, int idx, IntReg val) override
+    {
+        int reg = tc->flattenIntIndex(si->destRegIdx(idx));
+        shadow.intRegs[reg] = val;
+        shadow.regWrites.push_back(reg);
+    }
+
+    TheISA::FloatRegBits
+    readFloatRegOperandBits(const StaticInst *si, int idx) override
+    {
+        int reg = tc->flattenFloatIndex(si->srcRegIdx(idx) -
+            TheISA::FP_Reg_Base);
+        return shadow.floatRegs[reg];
+    }
+
+    TheISA::FloatReg
+    readFloatRegOperand(const StaticInst *si, int idx) override
+    {
+        FloatRegUnion val;
+        val.i = readFloatRegOperandBits(si, idx);
+        return val.f;
+    }
+
+    void
+    setFloatRegOperandBits(const StaticInst *si, int idx,
+        TheISA::FloatRegBits val) override
+    {
+        int reg = tc->flattenFloatIndex(si->destRegIdx(idx) -
+            TheISA::FP_Reg_Base);
+        shadow.floatRegs[reg] = val;
+        shadow.regWrites.push_back(TheISA::FP_Reg_Base + reg);
+    }
+
+    void
+    setFloatRegOperand(const StaticInst *si, int idx,
+        TheISA::FloatReg val) override
+    {
+        FloatRegUnion bits;
+        bits.f = val;
+        setFloatRegOperandBits(si, idx, bits.i);
+    }
+
+    TheISA::CCReg
+    readCCRegOperand(const StaticInst *si, int idx) override
+    {
+        int reg = tc->flattenCCIndex(si->srcRegIdx(idx) -
+            TheISA::CC_Reg_Base);
+        return shadow.ccRegs[reg];
+    }
+
+    void
+    setCCRegOperand(const StaticInst *si, int idx, TheISA::CCReg val) override
+    {
+        int reg = tc->flattenCCIndex(si->destRegIdx(idx) -
+            TheISA::CC_Reg_Base);
+        shadow.ccRegs[reg] = val;
+        shadow.regWrites.push_back(TheISA::CC_Reg_Base + reg);
+    }
+
+    TheISA::MiscReg
+    readMiscReg(int misc_reg) override
+    {
+        auto written = miscRegs.find(misc_reg);
+        if (written != miscRegs.end())
+            return written->second;
+        return tc->readMiscReg(misc_reg);
+    }
+
+    void
+    setMiscReg(int misc_reg, const TheISA::MiscReg &val) override
+    {
+        miscRegs[misc_reg] = val;
+        shadow.shadowMiscWrites.push_back(std::make_pair(misc_reg, val));
+    }
+
+    TheISA::MiscReg
+    readMiscRegOperand(const StaticInst *si, int idx) override
+    {
+        return readMiscReg(si->srcRegIdx(idx) - TheISA::Misc_Reg_Base);
+    }
+
+    void
+    setMiscRegOperand(const StaticInst *si, int idx,
+        const TheISA::MiscReg &val) override
+    {
+        setMiscReg(si->destRegIdx(idx) - TheISA::Misc_Reg_Base, val);
+    }
+
+    TheISA::PCState pcState() const override { return shadow.pc; }
+    void pcState(const TheISA::PCState &val) override { shadow.pc = val; }
+
+    void setEA(Addr ea_) override { ea = ea_; }
+    Addr getEA() const override { return ea; }
+
+    /** Loads return the data of the pipeline's access when it is to the
+     *  same address.  Any difference in the accesses is reported by
+     *  ShadowChecker::compare */
+    Fault
+    readMem(Addr addr, uint8_t *data, unsigned int size,
+        Request::Flags flags) override
+    {
+        ShadowChecker::MemAccess access;
+        access.store = false;
+        access.addr = addr;
+        access.size = size;
+        shadow.shadowAccesses.push_back(access);
+
+        std::memset(data, 0, size);
+
+        auto pipe = shadow.pipeAccesses.find(
+            shadow.curDynInst->id.execSeqNum);
+        if (pipe == shadow.pipeAccesses.end() || pipe->second.store ||
+            pipe->second.addr != addr || pipe->second.size != size ||
+            flags.isSet(Request::PREFETCH))
+        {
+            return NoFault;
+        }
+
+        PacketPtr response = shadow.loadResponse;
+        if (!response || !response->hasData() ||
+            response->getSize() != size)
+        {
+            /* No data to check the instruction against */
+            shadow.resync = true;
+        } else {
+            std::memcpy(data, response->getConstPtr<uint8_t>(), size);
+        }
+        return NoFault;
+    }
+
+    Fault
+    writeMem(uint8_t *data, unsigned int size, Addr addr,
+        Request::Flags flags, uint64_t *res) override
+    {
+        ShadowChecker::MemAccess access;
+        access.store = true;
+        access.addr = addr;
+        access.size = size;
+        if (data)
+            access.data.assign(data, data + size);
+        shadow.shadowAccesses.push_back(access);
+        return NoFault;
+    }
+
+    unsigned int readStCondFailures() const override { return 0; }
+    void setStCondFailures(unsigned int st_cond_failures) override { }
+
+    /** System calls aren't verifiable, the shadow never executes them */
+    void syscall(int64_t callnum) override { shadow.resync = true; }
+
+    ThreadContext *tcBase() override { return tc; }
+
+    Fault hwrei() override { return NoFault; }
+    bool simPalCheck(int palFunc) override { return false; }
+
+    bool readPredicate() override { return shadow.predicate; }
+    void setPredicate(bool val) override { shadow.predicate = val; }
+
+    /* The shadow doesn't model TLBs and monitors, instructions using them
+     *  end with a resync */
+    void demapPage(Addr vaddr, uint64_t asn) override { shadow.resync = true; }
+    void armMonitor(Addr address) override { shadow.resync = true; }
+
+    bool
+    mwait(PacketPtr pkt) override
+    {
+        shadow.resync = true;
+        return false;
+    }
+
+    void mwaitAtomic(ThreadContext *tc) override { shadow.resync = true; }
+
+    AddressMonitor *
+    getAddrMonitor() override
+    {
+        return shadow.cpu.getCpuAddrMonitor(shadow.tid);
+    }
+
+#if THE_ISA == MIPS_ISA
+    MiscReg
+    readRegOtherThread(int regIdx, ThreadID tid = InvalidThreadID) override
+    {
+        panic("Shadow checker can't access other threads\n");
+    }
+
+    void
+    setRegOtherThread(int regIdx, MiscReg val,
+        ThreadID tid = InvalidThreadID) override
+    {
+        panic("Shadow checker can't access other threads\n");
+    }
+#endif
+};
+
+ShadowChecker::ShadowChecker(MinorCPU &cpu_, ThreadID tid_,
+    bool detect_only) :
+    cpu(cpu_),
+    tid(tid_),
+    detectOnly(detect_only),
+    running(false),
+    detected(false),
+    resync(false),
+    reloadPC(false),
+    intRegs(TheISA::NumIntRegs),
+    floatRegs(TheISA::NumFloatRegs),
+    ccRegs(TheISA::NumCCRegs),
+    predicate(true),
+    loadResponse(NULL),
+    startTick(0),
+    numChecked(0)
+{
+    if (FullSystem)
+        fatal("%s: the shadow checker only supports SE mode\n", cpu.name());
+}
+
+void
+ShadowChecker::start()
+{
+    if (running)
+        return;
+
+    ThreadContext *tc = cpu.getContext(tid);
+
+    running = true;
+    startTick = curTick();
+    decoder = *tc->getDecoderPtr();
+    reload();
+
+    DPRINTF(FI, "Shadow checker of thread %d started\n", tid);
+}
+
+void
+ShadowChecker::recordAccess(MinorDynInstPtr inst, bool store, Addr addr,
+    unsigned int size, const uint8_t *data)
+{
+    if (!active())
+        return;
+
+    MemAccess &access = pipeAccesses[inst->id.execSeqNum];
+    access.store = store;
+    access.addr = addr;
+    access.size = size;
+    if (data)
+        access.data.assign(data, data + size);
+    else
+        access.data.clear();
+}
+
+bool
+ShadowChecker::verifiable(const StaticInstPtr &inst) const
+{
+    return !(inst->isSyscall() || inst->isUnverifiable() ||
+        inst->isStoreConditional() || inst->isNonSpeculative() ||
+        inst->isSerializing() || inst->isIprAccess() || inst->isQuiesce());
+}
+
+StaticInstPtr
+ShadowChecker::fetch()
+{
+    if (curMacroop)
+        return curMacroop->fetchMicroop(pc.microPC());
+
+    SETranslatingPortProxy &proxy = cpu.getContext(tid)->getMemProxy();
+    Addr fetch_pc = pc.instAddr() & BaseCPU::PCMask;
+    TheISA::PCState decode_pc = pc;
+    StaticInstPtr inst;
+
+    for (Addr offset = 0; !inst; offset += sizeof(TheISA::MachInst)) {
+        TheISA::MachInst mach_inst;
+
+        if (!proxy.tryReadBlob(fetch_pc + offset, (uint8_t *) &mach_inst,
+            sizeof(mach_inst)))
+        {
+            return StaticInst::nullStaticInstPtr;
+        }
+
+        decoder.moreBytes(decode_pc, fetch_pc + offset,
+            TheISA::gtoh(mach_inst));
+
+        if (decoder.instReady()) {
+            /* Don't let the golden decode take the decode fault */
+            SoftError::injPaused = true;
+            inst = decoder.decode(decode_pc);
+            SoftError::injPaused = false;
+        }
+    }
+
+    /* The StaticInst came from the shared decode cache, use a private
+     *  copy of it */
+    auto golden = goldenInsts.find(inst->machInst);
+    if (golden == goldenInsts.end()) {
+        golden = goldenInsts.insert(std::make_pair(inst->machInst,
+            decoder.decodeInst(inst->machInst))).first;
+    }
+    inst = golden->second;
+    pc = decode_pc;
+
+    if (inst->isMacroop()) {
+        curMacroop = inst;
+        inst = curMacroop->fetchMicroop(pc.microPC());
+    }
+    return inst;
+}
+
+void
+ShadowChecker::execute(MinorDynInstPtr inst, PacketPtr response)
+{
+    if (!active())
+        return;
+
+    curDynInst = inst;
+    curInst = NULL;
+    curFault = NoFault;
+    regWrites.clear();
+    shadowMiscWrites.clear();
+    shadowAccesses.clear();
+    loadResponse = response;
+
+    numChecked++;
+    cpu.stats.shadowChecks++;
+
+    if (reloadPC) {
+        pc = inst->pc;
+        curMacroop = NULL;
+        decoder.reset();
+        reloadPC = false;
+    } else if (pc.instAddr() != inst->pc.instAddr() ||
+        pc.microPC() != inst->pc.microPC())
+    {
+        detect(inst, csprintf("PC %s, golden PC %s", inst->pc, pc));
+        return;
+    }
+
+    curInst = fetch();
+    if (!curInst) {
+        DPRINTF(FI, "Shadow checker can't fetch from PC %s\n", pc);
+        resync = true;
+        return;
+    }
+
+    bool golden_verifiable = verifiable(curInst);
+    if (golden_verifiable != verifiable(inst->staticInst)) {
+        detect(inst, csprintf("executes %s, golden %s",
+            inst->staticInst->getName(), curInst->getName()));
+        return;
+    } else if (!golden_verifiable) {
+        /* The instruction may depend on any register, compare them all
+         *  before it executes and carry on from the pipeline's state */
+        std::string diff = compareRegs();
+        if (!diff.empty())
+            detect(inst, diff);
+        else
+            resync = true;
+        return;
+    }
+
+    ShadowExecContext context(*this, cpu.getContext(tid));
+
+    intRegs[cpu.getContext(tid)->flattenIntIndex(TheISA::ZeroReg)] = 0;
+    predicate = true;
+
+    curFault = curInst->execute(&context, NULL);
+
+    if (curFault == NoFault) {
+        if (!curInst->isMicroop() || curInst->isLastMicroop())
+            curMacroop = NULL;
+        TheISA::advancePC(pc, curInst);
+    }
+}
+
+void
+ShadowChecker::compare(MinorDynInstPtr inst, Fault fault)
+{
+    if (!active() || inst != curDynInst)
+        return;
+
+    std::string diff;
+
+    if (curInst && !resync && (curFault != NoFault || fault != NoFault)) {
+        if (curFault == NoFault) {
+            diff = csprintf("fault %s", fault->name());
+        } else if (fault == NoFault) {
+            diff = csprintf("no fault, golden %s", curFault->name());
+        } else if (std::strcmp(fault->name(), curFault->name()) != 0) {
+            diff = csprintf("fault %s, golden %s", fault->name(),
+                curFault->name());
+        } else {
+            /* The shadow doesn't model faults */
+            resync = true;
+        }
+    }
+
+    if (diff.empty() && !resync)
+        diff = compareSideEffects(inst);
+    if (diff.empty() && !resync)
+        diff = compareDests(inst);
+
+    if (!diff.empty()) {
+        detect(inst, diff);
+    } else if (resync) {
+        cpu.stats.shadowResyncs++;
+        reload();
+    }
+
+    retire(inst);
+}
+
+void
+ShadowChecker::faultInst(MinorDynInstPtr inst)
+{
+    if (!active())
+        return;
+
+    if (!reloadPC && (pc.instAddr() != inst->pc.instAddr() ||
+        pc.microPC() != inst->pc.microPC()))
+    {
+        detect(inst, csprintf("PC %s, golden PC %s", inst->pc, pc));
+        return;
+    }
+
+    cpu.stats.shadowResyncs++;
+    reload();
+    retire(inst);
+}
+
+std::string
+ShadowChecker::compareReg(int reg)
+{
+    ThreadContext *tc = cpu.getContext(tid);
+
+    if (reg < TheISA::FP_Reg_Base) {
+        TheISA::IntReg val = tc->readIntRegFlat(reg);
+        if (val != intRegs[reg]) {
+            return csprintf("int reg %d is %#x, golden %#x", reg, val,
+                intRegs[reg]);
+        }
+    } else if (reg < TheISA::CC_Reg_Base) {
+        int idx = reg - TheISA::FP_Reg_Base;
+        TheISA::FloatRegBits val = tc->readFloatRegBitsFlat(idx);
+        if (val != floatRegs[idx]) {
+            return csprintf("float reg %d is %#x, golden %#x", idx, val,
+                floatRegs[idx]);
+        }
+    } else {
+        int idx = reg - TheISA::CC_Reg_Base;
+        TheISA::CCReg val = tc->readCCRegFlat(idx);
+        if (val != ccRegs[idx]) {
+            return csprintf("cc reg %d is %#x, golden %#x", idx, val,
+                ccRegs[idx]);
+        }
+    }
+    return "";
+}
+
+std::string
+ShadowChecker::compareRegs()
+{
+    std::string diff;
+
+    for (int i = 0; diff.empty() && i < TheISA::NumIntRegs; i++)
+        diff = compareReg(i);
+    for (int i = 0; diff.empty() && i < TheISA::NumFloatRegs; i++)
+        diff = compareReg(TheISA::FP_Reg_Base + i);
+    for (int i = 0; diff.empty() && i < TheISA::NumCCRegs; i++)
+        diff = compareReg(TheISA::CC_Reg_Base + i);
+
+    return diff;
+}
+
+std::string
+ShadowChecker::compareDests(MinorDynInstPtr inst)
+{
+    ThreadContext *tc = cpu.getContext(tid);
+    const StaticInstPtr &si = inst->staticInst;
+
+    /* The registers written by the golden instruction and the ones the
+     *  pipeline's (possibly corrupted) instruction names */
+    std::vector<int> regs(regWrites);
+    for (int i = 0; i < si->numDestRegs(); i++) {
+        RegIndex reg = si->destRegIdx(i);
+
+        if (reg < TheISA::FP_Reg_Base) {
+            regs.push_back(tc->flattenIntIndex(reg));
+        } else if (reg < TheISA::CC_Reg_Base) {
+            regs.push_back(TheISA::FP_Reg_Base +
+                tc->flattenFloatIndex(reg - TheISA::FP_Reg_Base));
+        } else if (reg < TheISA::Misc_Reg_Base) {
+            regs.push_back(TheISA::CC_Reg_Base +
+                tc->flattenCCIndex(reg - TheISA::CC_Reg_Base));
+        }
+        /* Miscellaneous registers are compared by compareSideEffects */
+    }
+
+    for (auto reg : regs) {
+        std::string diff = compareReg(reg);
+        if (!diff.empty())
+            return diff;
+    }
+    return "";
+}
+
+std::string
+ShadowChecker::compareSideEffects(MinorDynInstPtr inst)
+{
+    auto pipe = pipeAccesses.find(inst->id.execSeqNum);
+
+    if (pipe != pipeAccesses.end() || !shadowAccesses.empty()) {
+        if (shadowAccesses.empty()) {
+            return csprintf("%s of %#x not made by golden",
+                pipe->second.store ? "store" : "load", pipe->second.addr);
+        } else if (pipe == pipeAccesses.end()) {
+            return csprintf("no access, golden %s of %#x",
+                shadowAccesses.front().store ? "store" : "load",
+                shadowAccesses.front().addr);
+        }
+
+        const MemAccess &golden = shadowAccesses.front();
+        const MemAccess &access = pipe->second;
+
+        if (golden.store != access.store || golden.addr != access.addr ||
+            golden.size != access.size)
+        {
+            return csprintf("%s of %d bytes at %#x, golden %s of %d bytes "
+                "at %#x", access.store ? "store" : "load", access.size,
+                access.addr, golden.store ? "store" : "load", golden.size,
+                golden.addr);
+        } else if (golden.store && golden.data != access.data) {
+            return csprintf("store data to %#x differs", access.addr);
+        }
+    }
+
+    size_t num_writes = std::max(pipeMiscWrites.size(),
+        shadowMiscWrites.size());
+    for (size_t i = 0; i < num_writes; i++) {
+        if (i >= shadowMiscWrites.size()) {
+            return csprintf("misc reg %d written, not by golden",
+                pipeMiscWrites[i].first);
+        } else if (i >= pipeMiscWrites.size()) {
+            return csprintf("misc reg %d not written, golden writes %#x",
+                shadowMiscWrites[i].first, shadowMiscWrites[i].second);
+        } else if (pipeMiscWrites[i] != shadowMiscWrites[i]) {
+            return csprintf("misc reg %d written with %#x, golden misc "
+                "reg %d with %#x", pipeMiscWrites[i].first,
+                pipeMiscWrites[i].second, shadowMiscWrites[i].first,
+                shadowMiscWrites[i].second);
+        }
+    }
+    return "";
+}
+
+void
+ShadowChecker::reload()
+{
+    ThreadContext *tc = cpu.getContext(tid);
+
+    for (int i = 0; i < TheISA::NumIntRegs; i++)
+        intRegs[i] = tc->readIntRegFlat(i);
+    for (int i = 0; i < TheISA::NumFloatRegs; i++)
+        floatRegs[i] = tc->readFloatRegBitsFlat(i);
+    for (int i = 0; i < TheISA::NumCCRegs; i++)
+        ccRegs[i] = tc->readCCRegFlat(i);
+
+    resync = false;
+    reloadPC = true;
+    curMacroop = NULL;
+}
+
+void
+ShadowChecker::retire(MinorDynInstPtr inst)
+{
+    pipeAccesses.erase(pipeAccesses.begin(),
+        pipeAccesses.upper_bound(inst->id.execSeqNum));
+    pipeMiscWrites.clear();
+    curDynInst = NULL;
+    loadResponse = NULL;
+}
+
+void
+ShadowChecker::detect(MinorDynInstPtr inst, const std::string &what)
+{
+    detected = true;
+
+    cpu.stats.shadowDetections++;
+    cpu.stats.shadowDetectTicks = curTick() - startTick;
+    cpu.stats.shadowDetectInsts = numChecked;
+
+    DPRINTF(FI, "Shadow checker: fault visible at %s after %d insts and "
+        "%d ticks: %s\n", *inst, numChecked, curTick() - startTick, what);
+
+    pipeAccesses.clear();
+    pipeMiscWrites.clear();
+    curDynInst = NULL;
+    loadResponse = NULL;
+
+    if (detectOnly)
+        exitSimLoop("fault detected by shadow checker");
+}
+
+}
@@ -0,0 +1,232 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *
+ *  Lockstep golden shadow for fault injection runs. The shadow holds a copy
+ *  of the architectural state of a thread taken before the fault is
+ *  injected and re-executes every committed instruction functionally
+ *  against it, comparing the results with those of the pipeline.
+ */
+
+#ifndef __CPU_MINOR_SHADOW_HH__
+#define __CPU_MINOR_SHADOW_HH__
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arch/decoder.hh"
+#include "arch/registers.hh"
+#include "cpu/decode_cache.hh"
+#include "cpu/minor/dyn_inst.hh"
+#include "cpu/static_inst.hh"
+#include "mem/packet.hh"
+
+class MinorCPU;
+
+namespace Minor
+{
+
+class ShadowExecContext;
+
+/** Functional golden copy of one thread, checked at every commit.
+ *
+ *  The shadow fetches and decodes its own instructions from memory into
+ *  its own StaticInsts, so a fault in the fetched bytes or in a decoded
+ *  instruction is seen as a difference in behaviour, not copied into the
+ *  shadow.  For every committed instruction:
+ *
+ *  - execute() runs the golden instruction on the shadow state before the
+ *    pipeline executes (or completes the memory access of) the
+ *    instruction.  Register and miscellaneous register reads that the
+ *    shadow doesn't hold come from the thread, which is still in its
+ *    state before the instruction.
+ *  - compare() is called once the pipeline has committed the instruction
+ *    and compares the faults, the registers written by either
+ *    instruction, the miscellaneous registers written and the memory
+ *    accesses.
+ *
+ *  Load data is taken from the pipeline's response when the addresses
+ *  match: memory only diverges from the golden memory after a corrupted
+ *  store, which is itself a detection.  Instructions with side effects
+ *  the shadow can't reproduce (system calls, serializing and
+ *  non-speculative instructions, store conditionals) are checked by
+ *  comparing the whole register file before they execute, after which
+ *  the shadow is resynchronised from the thread.  The same is done after
+ *  the fetch, TLB and memory faults that the shadow doesn't model.
+ *
+ *  The first difference is the point at which the fault becomes
+ *  architecturally visible.  It is reported and checking stops; in
+ *  detect-only mode the simulation ends there.
+ */
+class ShadowChecker
+{
+  protected:
+    friend class ShadowExecContext;
+
+    MinorCPU &cpu;
+
+    ThreadID tid;
+
+    /** End the simulation at the first detection */
+    bool detectOnly;
+
+    /** The shadow is following the thread */
+    bool running;
+
+    /** A difference has been found, no more checking */
+    bool detected;
+
+    /** The shadow state is to be reloaded from the thread after the
+     *  current instruction */
+    bool resync;
+
+    /** Take the PC of the next instruction from the pipeline */
+    bool reloadPC;
+
+    /** Golden architectural state, indexed by flattened register index */
+    std::vector<TheISA::IntReg> intRegs;
+    std::vector<TheISA::FloatRegBits> floatRegs;
+    std::vector<TheISA::CCReg> ccRegs;
+    TheISA::PCState pc;
+    bool predicate;
+
+    /** Golden fetch and decode.  Instructions are decoded into private
+     *  StaticInsts as the ones in the shared decode cache are the ones
+     *  the fault injection corrupts */
+    TheISA::Decoder decoder;
+    DecodeCache::InstMap goldenInsts;
+    StaticInstPtr curMacroop;
+
+    /** State of the instruction being checked */
+    StaticInstPtr curInst;
+    MinorDynInstPtr curDynInst;
+    Fault curFault;
+
+    /** Flattened registers written by the shadow instruction, the index
+     *  includes the register class base (see TheISA::FP_Reg_Base) */
+    std::vector<int> regWrites;
+
+    /** Miscellaneous register writes by the shadow and by the pipeline */
+    std::vector<std::pair<int, TheISA::MiscReg> > shadowMiscWrites;
+    std::vector<std::pair<int, TheISA::MiscReg> > pipeMiscWrites;
+
+    /** A memory access, addr is the virtual address */
+    struct MemAccess
+    {
+        bool store;
+        Addr addr;
+        unsigned int size;
+        std::vector<uint8_t> data;
+    };
+
+    /** Accesses made by the shadow instruction */
+    std::vector<MemAccess> shadowAccesses;
+
+    /** Accesses issued by the pipeline, by execSeqNum.  Accesses are
+     *  issued before the instruction commits */
+    std::map<InstSeqNum, MemAccess> pipeAccesses;
+
+    /** Response data for the load being checked */
+    PacketPtr loadResponse;
+
+    /** Tick at which the shadow started */
+    Tick startTick;
+
+    /** Number of instructions checked */
+    Counter numChecked;
+
+  public:
+    ShadowChecker(MinorCPU &cpu_, ThreadID tid_, bool detect_only);
+
+    /** Is the shadow checking instructions? */
+    bool active() const { return running && !detected; }
+
+    /** Take the golden state from the thread, called before any fault is
+     *  injected */
+    void start();
+
+    /** Record a memory access issued by the pipeline */
+    void recordAccess(MinorDynInstPtr inst, bool store, Addr addr,
+        unsigned int size, const uint8_t *data);
+
+    /** Record a miscellaneous register written by the pipeline */
+    void
+    recordMiscWrite(int misc_reg, const TheISA::MiscReg &val)
+    {
+        if (active())
+            pipeMiscWrites.push_back(std::make_pair(misc_reg, val));
+    }
+
+    /** Execute the golden version of inst, before the pipeline does.
+     *  response is the memory response for memory instructions */
+    void execute(MinorDynInstPtr inst, PacketPtr response = NULL);
+
+    /** Compare the shadow against the committed inst, fault is the fault
+     *  the pipeline raised executing it */
+    void compare(MinorDynInstPtr inst, Fault fault);
+
+    /** The pipeline committed a fault which the shadow doesn't model
+     *  instead of executing inst */
+    void faultInst(MinorDynInstPtr inst);
+
+  protected:
+    /** Fetch and decode the instruction at pc */
+    StaticInstPtr fetch();
+
+    /** Can inst be executed by the shadow? */
+    bool verifiable(const StaticInstPtr &inst) const;
+
+    /** Compare one register with the thread, reg is a flattened index
+     *  including the register class base.
+     *  @return Description of the difference, or "" */
+    std::string compareReg(int reg);
+
+    /** Compare the full register file with the thread */
+    std::string compareRegs();
+
+    /** Compare the registers written by the shadow and by the pipeline */
+    std::string compareDests(MinorDynInstPtr inst);
+
+    /** Compare memory accesses and miscellaneous register writes */
+    std::string compareSideEffects(MinorDynInstPtr inst);
+
+    /** Reload the shadow registers from the thread, the PC is taken from
+     *  the next instruction */
+    void reload();
+
+    /** Forget the pipeline's records up to inst */
+    void retire(MinorDynInstPtr inst);
+
+    /** Report the first architecturally visible difference */
+    void detect(MinorDynInstPtr inst, const std::string &what);
+};
+
+}
+
+#endif /* __CPU_MINOR_SHADOW_HH__ */
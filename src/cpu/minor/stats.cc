@@ -89,6 +89,92 @@ MinorStats::regStats(const std::string &name, BaseCPU &baseCpu)
         .desc("Class of committed instruction")
         .flags(Stats::total | Stats::pdf | Stats::dist);
     committedInstType.ysubnames(Enums::OpClassStrings);
+
+    faultsInjected
+        .name(name + ".faultsInjected")
+        .desc("Number of faults injected into the CPU")
+        .prereq(faultsInjected);
+
+    rfParityChecks
+        .name(name + ".rfParityChecks")
+        .desc("Number of register file parity checks")
+        .prereq(rfParityChecks);
+
+    rfParityUpdates
+        .name(name + ".rfParityUpdates")
+        .desc("Number of register file parity updates")
+        .prereq(rfParityUpdates);
+
+    rfParityErrors
+        .name(name + ".rfParityErrors")
+        .desc("Number of parity errors detected in the register file")
+        .prereq(rfParityErrors);
+
+    rfCorrections
+        .name(name + ".rfCorrections")
+        .desc("Number of corrupted registers corrected")
+        .prereq(rfCorrections);
+
+    shadowChecks
+        .name(name + ".shadowChecks")
+        .desc("Number of instructions checked by the shadow checker")
+        .prereq(shadowChecks);
+
+    shadowResyncs
+        .name(name + ".shadowResyncs")
+        .desc("Number of shadow checker resynchronisations")
+        .prereq(shadowChecks);
+
+    shadowDetections
+        .name(name + ".shadowDetections")
+        .desc("Number of faults detected by the shadow checker")
+        .prereq(shadowChecks);
+
+    shadowDetectTicks
+        .name(name + ".shadowDetectTicks")
+        .desc("Ticks from the start of the shadow checker to the detection")
+        .prereq(shadowDetections);
+
+    shadowDetectInsts
+        .name(name + ".shadowDetectInsts")
+        .desc("Instructions checked by the shadow checker up to the "
+            "detection")
+        .prereq(shadowDetections);
+
+    dupInsts
+        .name(name + ".dupInsts")
+        .desc("Number of duplicate instructions committed")
+        .prereq(dupInsts);
+
+    dupChecks
+        .name(name + ".dupChecks")
+        .desc("Number of duplication compares committed")
+        .prereq(dupChecks);
+
+    dupDetections
+        .name(name + ".dupDetections")
+        .desc("Number of faults detected by duplication compares")
+        .prereq(dupChecks);
+
+    executeOccupancy
+        .name(name + ".executeOccupancy")
+        .desc("Instructions in flight in Execute summed over cycles")
+        .prereq(executeOccupancy);
+
+    lsqOccupancy
+        .name(name + ".lsqOccupancy")
+        .desc("LSQ requests and store buffer entries summed over cycles")
+        .prereq(executeOccupancy);
+
+    scoreboardStalls
+        .name(name + ".scoreboardStalls")
+        .desc("Number of cycles issue waited on the scoreboard")
+        .prereq(executeOccupancy);
+
+    fetchRedirects
+        .name(name + ".fetchRedirects")
+        .desc("Number of stream changes signalled to Fetch1 by Execute")
+        .prereq(executeOccupancy);
 }
 
 };
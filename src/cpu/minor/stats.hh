@@ -79,6 +79,43 @@ class MinorStats
     /** Number of instructions by type (OpClass) */
     Stats::Vector2d committedInstType;
 
+    /** Number of faults injected into this CPU */
+    Stats::Scalar faultsInjected;
+
+    /** Register file parity events (only with rfParity): parity checks
+     *  on reads, parity updates on writes and reads of a corrupted
+     *  register caught by the check */
+    Stats::Scalar rfParityChecks;
+    Stats::Scalar rfParityUpdates;
+    Stats::Scalar rfParityErrors;
+
+    /** Number of corrupted registers restored (correctRf) */
+    Stats::Scalar rfCorrections;
+
+    /** Golden shadow checking (only with shadowCheck): instructions
+     *  checked, resynchronisations after instructions the shadow can't
+     *  execute, and the first difference found with the ticks and
+     *  instructions since the shadow started */
+    Stats::Scalar shadowChecks;
+    Stats::Scalar shadowResyncs;
+    Stats::Scalar shadowDetections;
+    Stats::Scalar shadowDetectTicks;
+    Stats::Scalar shadowDetectInsts;
+
+    /** Duplication (only with dupOpClasses): duplicates and compares
+     *  executed and failed compares */
+    Stats::Scalar dupInsts;
+    Stats::Scalar dupChecks;
+    Stats::Scalar dupDetections;
+
+    /** Timing (only with timingStats): instructions in flight in Execute
+     *  and LSQ requests, both summed over cycles, cycles in which issue
+     *  waited on the scoreboard and stream changes signalled to Fetch1 */
+    Stats::Scalar executeOccupancy;
+    Stats::Scalar lsqOccupancy;
+    Stats::Scalar scoreboardStalls;
+    Stats::Scalar fetchRedirects;
+
   public:
     MinorStats();
 
@@ -52,23 +52,47 @@
 
 #include <string>
 
+#include "base/cprintf.hh"
 #include "base/trace.hh"
+#include "cpu/minor/trace_file.hh"
 #include "debug/MinorTrace.hh"
 
 namespace Minor
 {
 
+/** Is MinorTrace wanted, as debug output or in a trace file? */
+inline bool
+minorTraceOn()
+{
+    return DTRACE(MinorTrace) || traceFile;
+}
+
+/** Write a MinorTrace record to the trace file if there is one and to
+ *  the debug output otherwise */
+#define MINORTRACE_RECORD(name, kind, prefix, ...) \
+    do { \
+        if (Minor::traceFile) { \
+            Minor::traceFile->record((name), Minor::TraceFile::kind, \
+                csprintf(__VA_ARGS__)); \
+        } else if (DTRACE(MinorTrace)) { \
+            Trace::getDebugLogger()->dprintf(curTick(), (name), \
+                prefix __VA_ARGS__); \
+        } \
+    } while (0)
+
 /** DPRINTFN for MinorTrace reporting */
 #define MINORTRACE(...) \
-    DPRINTF(MinorTrace, "MinorTrace: " __VA_ARGS__)
+    MINORTRACE_RECORD(name(), Trace, "MinorTrace: ", __VA_ARGS__)
 
 /** DPRINTFN for MinorTrace MinorInst line reporting */
 #define MINORINST(sim_object, ...) \
-    DPRINTFS(MinorTrace, (sim_object), "MinorInst: " __VA_ARGS__)
+    MINORTRACE_RECORD((sim_object)->name(), Inst, "MinorInst: ", \
+        __VA_ARGS__)
 
 /** DPRINTFN for MinorTrace MinorLine line reporting */
 #define MINORLINE(sim_object, ...) \
-    DPRINTFS(MinorTrace, (sim_object), "MinorLine: " __VA_ARGS__)
+    MINORTRACE_RECORD((sim_object)->name(), Line, "MinorLine: ", \
+        __VA_ARGS__)
 
 }
 
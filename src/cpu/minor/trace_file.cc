@@ -0,0 +1,152 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/minor/trace_file.hh"
+
+#include <algorithm>
+
+#include "base/callback.hh"
+#include "base/misc.hh"
+#include "sim/core.hh"
+#include "sim/sim_exit.hh"
+
+namespace Minor
+{
+
+TraceFile *traceFile = NULL;
+
+namespace
+{
+
+const BlockFile::Format format = {
+    { 'M', '5', 'M', 'I', 'N', 'T', 'R', '\0' }, 1,
+    0x4b42544d, /* "MTBK" */
+    { 'M', '5', 'M', 'I', 'N', 'I', 'D', 'X' }
+};
+
+/** Finish the trace file at exit and release it */
+struct CloseCallback : public Callback
+{
+    void
+    process() override
+    {
+        traceFile->close();
+        delete traceFile;
+        traceFile = NULL;
+    }
+};
+
+}
+
+void
+TraceFile::open(const std::string &name)
+{
+    if (traceFile) {
+        if (traceFile->file.name() != name) {
+            fatal("MinorTrace is already written to %s, can't also write "
+                  "it to %s\n", traceFile->file.name(), name);
+        }
+        return;
+    }
+
+    traceFile = new TraceFile(name);
+    registerExitCallback(new CloseCallback);
+}
+
+TraceFile::TraceFile(const std::string &name) :
+    file(name, format, maxPending)
+{
+    current.body.reserve(blockSize + 1024);
+}
+
+void
+TraceFile::record(const std::string &unit, Kind kind,
+    const std::string &text)
+{
+    Tick now = curTick();
+
+    /* Records are formatted like debug output lines, drop the newline */
+    size_t size = text.size();
+    if (size != 0 && text[size - 1] == '\n')
+        size--;
+
+    auto found = units.find(unit);
+    unsigned unit_num;
+    if (found == units.end()) {
+        unit_num = units.size();
+        units[unit] = unit_num;
+        lastTrace.emplace_back();
+
+        current.putVarint(now - current.addRecord(now));
+        current.body.push_back(UnitName);
+        current.putString(unit.data(), unit.size());
+    } else {
+        unit_num = found->second;
+    }
+
+    std::string &last = lastTrace[unit_num];
+    if (kind == Trace && last.size() == size &&
+        text.compare(0, size, last) == 0)
+    {
+        return;
+    }
+
+    current.putVarint(now - current.addRecord(now));
+    current.body.push_back(kind);
+    current.putVarint(unit_num);
+
+    if (kind == Trace) {
+        size_t prefix = 0;
+        size_t max_prefix = std::min(size, last.size());
+        while (prefix < max_prefix && text[prefix] == last[prefix])
+            prefix++;
+
+        current.putVarint(prefix);
+        current.putString(text.data() + prefix, size - prefix);
+        last.assign(text, 0, size);
+    } else {
+        current.putString(text.data(), size);
+    }
+
+    if (current.body.size() >= blockSize)
+        flush();
+}
+
+void
+TraceFile::flush()
+{
+    file.write(current, blockSize + 1024);
+    units.clear();
+    lastTrace.clear();
+}
+
+void
+TraceFile::close()
+{
+    flush();
+    file.close();
+}
+
+}
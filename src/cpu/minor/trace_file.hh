@@ -0,0 +1,118 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *
+ *  Binary MinorTrace file for minorview. Written instead of the
+ *  MinorTrace debug output when MinorCPU.minorTraceFile is set, so
+ *  that long runs can be traced and windows of them loaded quickly.
+ *
+ *  The file is a BlockFile (base/block_file.hh) with file magic
+ *  "M5MINTR\0", block magic "MTBK" and index magic "M5MINIDX".
+ *
+ *  A body is a sequence of records, each starting with the tick
+ *  since the previous record (the first is relative to the block's
+ *  first tick) as a LEB128 varint and a kind byte:
+ *
+ *  UnitName:  varint length, name; defines the next unit number
+ *  Trace:     varint unit, varint length of the prefix shared with
+ *             the unit's previous Trace record in the block, varint
+ *             suffix length, suffix
+ *  Inst/Line: varint unit, varint length, text
+ *
+ *  The text of a record is what would follow "MinorTrace: ",
+ *  "MinorInst: " or "MinorLine: " in the debug output. A Trace line
+ *  that is the same as the unit's previous one isn't written, as
+ *  minorview only shows changes. Unit numbers and the previous Trace
+ *  lines are reset at each block, so any block can be decoded on its
+ *  own and a reader can seek to a tick with the index.
+ */
+
+#ifndef __CPU_MINOR_TRACE_FILE_HH__
+#define __CPU_MINOR_TRACE_FILE_HH__
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/block_file.hh"
+
+namespace Minor
+{
+
+class TraceFile
+{
+  public:
+    /** Record kinds */
+    enum Kind : uint8_t
+    {
+        UnitName = 0,
+        Trace,
+        Inst,
+        Line
+    };
+
+    /** Block body size at which a block is handed to the writer */
+    static const size_t blockSize = 256 * 1024;
+
+    /** Filled blocks waiting for the writer before record() waits */
+    static const size_t maxPending = 16;
+
+    /**
+     * Start writing the trace to a file in the output directory. All
+     * CPUs share one file, so later calls must name the same file.
+     */
+    static void open(const std::string &name);
+
+    /** Add a record to the trace */
+    void record(const std::string &unit, Kind kind, const std::string &text);
+
+    /** Write the last block and the index */
+    void close();
+
+  private:
+    TraceFile(const std::string &name);
+
+    BlockFile file;
+
+    /** The block being filled */
+    BlockFile::Block current;
+    /** Unit numbers in current */
+    std::unordered_map<std::string, unsigned> units;
+    /** Last Trace text of each unit in current */
+    std::vector<std::string> lastTrace;
+
+    /** Hand the current block to the writer and start a new one */
+    void flush();
+};
+
+/** The trace file, null when MinorTrace goes to the debug output */
+extern TraceFile *traceFile;
+
+}
+
+#endif /* __CPU_MINOR_TRACE_FILE_HH__ */
@@ -145,6 +145,10 @@ class DerivO3CPU(BaseCPU):
     needsTSO = Param.Bool(buildEnv['TARGET_ISA'] == 'x86',
                           "Enable TSO Memory model")
 
+    pipeViewFile = Param.String("", "Write the pipeline view of the "
+        "committed instructions to this binary file in the output "
+        "directory (no O3PipeView debug flag needed)")
+
     def addCheckerCpu(self):
         if buildEnv['TARGET_ISA'] in ['arm']:
             from ArmTLB import ArmTLB
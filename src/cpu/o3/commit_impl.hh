@@ -1286,8 +1286,12 @@ DefaultCommit<Impl>::commitHead(DynInstPtr &head_inst, unsigned inst_num)
     rob->retireHead(tid);
 
 #if TRACING_ON
-    if (DTRACE(O3PipeView)) {
+    if (cpu->pipeViewOn()) {
         head_inst->commitTick = curTick() - head_inst->fetchTick;
+
+        // Stores are recorded when they complete, with the store tick
+        if (cpu->pipeViewFile && !head_inst->isStore())
+            cpu->pipeViewFile->record(head_inst);
     }
 #endif
 
@@ -214,6 +214,16 @@ FullO3CPU<Impl>::FullO3CPU(DerivO3CPUParams *params)
         checker = NULL;
     }
 
+    pipeViewFile = NULL;
+    if (!params->pipeViewFile.empty()) {
+#if TRACING_ON
+        pipeViewFile = new O3PipeViewFile(params->pipeViewFile);
+#else
+        warn("%s: pipeViewFile needs a build with tracing, ignoring it\n",
+             name());
+#endif
+    }
+
     if (!FullSystem) {
         thread.resize(numThreads);
         tids.resize(numThreads);
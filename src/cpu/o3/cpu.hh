@@ -58,12 +58,14 @@
 #include "config/the_isa.hh"
 #include "cpu/o3/comm.hh"
 #include "cpu/o3/cpu_policy.hh"
+#include "cpu/o3/pipeview_file.hh"
 #include "cpu/o3/scoreboard.hh"
 #include "cpu/o3/thread_state.hh"
 #include "cpu/activity.hh"
 #include "cpu/base.hh"
 #include "cpu/simple_thread.hh"
 #include "cpu/timebuf.hh"
+#include "debug/O3PipeView.hh"
 //#include "cpu/o3/thread_context.hh"
 #include "params/DerivO3CPU.hh"
 #include "sim/process.hh"
@@ -654,6 +656,16 @@ class FullO3CPU : public BaseO3CPU
      */
     Checker<Impl> *checker;
 
+    /** The binary pipeline view file, NULL if there is none */
+    O3PipeViewFile *pipeViewFile;
+
+    /** Should the stages record the pipeline view ticks? */
+    bool
+    pipeViewOn() const
+    {
+        return DTRACE(O3PipeView) || pipeViewFile;
+    }
+
     /** Pointer to the system. */
     System *system;
 
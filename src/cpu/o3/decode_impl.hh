@@ -698,7 +698,7 @@ DefaultDecode<Impl>::decodeInsts(ThreadID tid)
         --insts_available;
 
 #if TRACING_ON
-        if (DTRACE(O3PipeView)) {
+        if (cpu->pipeViewOn()) {
             inst->decodeTick = curTick() - inst->fetchTick;
         }
 #endif
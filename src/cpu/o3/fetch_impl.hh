@@ -1339,7 +1339,7 @@ DefaultFetch<Impl>::fetch(bool &status_change)
             numInst++;
 
 #if TRACING_ON
-            if (DTRACE(O3PipeView)) {
+            if (cpu->pipeViewOn()) {
                 instruction->fetchTick = curTick();
             }
 #endif
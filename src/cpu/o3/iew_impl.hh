@@ -1583,7 +1583,7 @@ DefaultIEW<Impl>::updateExeInstStats(DynInstPtr &inst)
     iewExecutedInsts++;
 
 #if TRACING_ON
-    if (DTRACE(O3PipeView)) {
+    if (cpu->pipeViewOn()) {
         inst->completeTick = curTick() - inst->fetchTick;
     }
 #endif
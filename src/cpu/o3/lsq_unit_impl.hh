@@ -1186,9 +1186,12 @@ LSQUnit<Impl>::completeStore(int store_idx)
             storeQueue[store_idx].inst->seqNum, store_idx, storeHead);
 
 #if TRACING_ON
-    if (DTRACE(O3PipeView)) {
+    if (cpu->pipeViewOn()) {
         storeQueue[store_idx].inst->storeTick =
             curTick() - storeQueue[store_idx].inst->fetchTick;
+
+        if (cpu->pipeViewFile)
+            cpu->pipeViewFile->record(storeQueue[store_idx].inst);
     }
 #endif
 
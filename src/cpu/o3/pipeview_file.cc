@@ -0,0 +1,102 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/o3/pipeview_file.hh"
+
+#include "base/callback.hh"
+#include "sim/core.hh"
+#include "sim/sim_exit.hh"
+
+namespace
+{
+
+const BlockFile::Format format = {
+    { 'M', '5', 'O', '3', 'P', 'V', '\0', '\0' }, 1,
+    0x4b425650, /* "PVBK" */
+    { 'M', '5', 'O', '3', 'P', 'I', 'D', 'X' }
+};
+
+}
+
+O3PipeViewFile::O3PipeViewFile(const std::string &name) :
+    file(name, format, maxPending),
+    lastSeqNum(0)
+{
+    current.body.reserve(blockSize + 1024);
+    registerExitCallback(
+        new MakeCallback<O3PipeViewFile, &O3PipeViewFile::close>(this));
+}
+
+void
+O3PipeViewFile::record(InstSeqNum seq_num, Addr pc, MicroPC upc,
+    const StaticInstPtr &static_inst, Tick fetch,
+    const int32_t (&stages)[NumStages])
+{
+    Tick now = curTick();
+
+    current.putVarint(now - current.addRecord(now));
+    current.putVarint(now - fetch);
+
+    int64_t seq_diff = seq_num - lastSeqNum;
+    current.putVarint((uint64_t(seq_diff) << 1) ^ uint64_t(seq_diff >> 63));
+    lastSeqNum = seq_num;
+
+    current.putVarint(pc);
+    current.putVarint(upc);
+    for (int32_t stage : stages)
+        current.putVarint(stage < 0 ? 0 : uint64_t(stage) + 1);
+
+    auto found = disassembly.find(static_inst.get());
+    if (found != disassembly.end()) {
+        current.putVarint(found->second);
+    } else {
+        unsigned number = disassembly.size();
+        disassembly[static_inst.get()] = number;
+        heldInsts.push_back(static_inst);
+
+        const std::string &text = static_inst->disassemble(pc);
+        current.putVarint(number);
+        current.putString(text.data(), text.size());
+    }
+
+    if (current.body.size() >= blockSize)
+        flush();
+}
+
+void
+O3PipeViewFile::flush()
+{
+    file.write(current, blockSize + 1024);
+    lastSeqNum = 0;
+    disassembly.clear();
+    heldInsts.clear();
+}
+
+void
+O3PipeViewFile::close()
+{
+    flush();
+    file.close();
+}
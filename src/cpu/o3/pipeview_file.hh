@@ -0,0 +1,135 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *
+ *  Binary form of the O3PipeView debug output, written when
+ *  DerivO3CPU.pipeViewFile is set so that long runs can be pipeline
+ *  traced. util/o3-pipeview.py reads these files directly and
+ *  util/o3_pipeview_file.py converts them back to O3PipeView text.
+ *
+ *  The file is a BlockFile (base/block_file.hh) with file magic
+ *  "M5O3PV\0\0", block magic "PVBK" and index magic "M5O3PIDX". The
+ *  ticks of the blocks and index are those at which the records were
+ *  written: at retire from commit, or at store completion for stores.
+ *
+ *  Each record is a sequence of LEB128 varints:
+ *
+ *  - ticks since the previous record (the block's first tick for the
+ *    first record)
+ *  - ticks from fetch to the record's tick
+ *  - sequence number, zigzag encoded difference from the previous
+ *    record's (0 for the first record)
+ *  - pc, micro pc
+ *  - decode, rename, dispatch, issue, complete, retire and store
+ *    completion ticks relative to fetch plus one, 0 for stages the
+ *    instruction didn't reach
+ *  - disassembly number in the block, followed by the length and
+ *    text of the disassembly when it is the next unused number
+ *
+ *  Squashed instructions never retire, so they aren't recorded and
+ *  there is no equivalent of the "retire:0" lines of the debug output.
+ */
+
+#ifndef __CPU_O3_PIPEVIEW_FILE_HH__
+#define __CPU_O3_PIPEVIEW_FILE_HH__
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/block_file.hh"
+#include "cpu/inst_seq.hh"
+#include "cpu/static_inst.hh"
+
+class O3PipeViewFile
+{
+  public:
+    /** Stages after fetch in the order they are recorded */
+    enum Stage
+    {
+        Decode = 0,
+        Rename,
+        Dispatch,
+        Issue,
+        Complete,
+        Retire,
+        Store,
+        NumStages
+    };
+
+    /** Block body size at which a block is handed to the writer */
+    static const size_t blockSize = 256 * 1024;
+
+    /** Filled blocks waiting for the writer before record() waits */
+    static const size_t maxPending = 16;
+
+    /** Create the file in the output directory, it is closed on exit */
+    O3PipeViewFile(const std::string &name);
+
+    /**
+     * Record an instruction at the current tick.
+     * @param stages Ticks since fetch at which the instruction entered
+     *        each stage, -1 if it didn't
+     */
+    void record(InstSeqNum seq_num, Addr pc, MicroPC upc,
+        const StaticInstPtr &static_inst, Tick fetch,
+        const int32_t (&stages)[NumStages]);
+
+    /** Record a dynamic instruction with the pipeline view ticks */
+    template <class DynInstPtr>
+    void
+    record(const DynInstPtr &inst)
+    {
+        const int32_t stages[NumStages] = {
+            inst->decodeTick, inst->renameTick, inst->dispatchTick,
+            inst->issueTick, inst->completeTick, inst->commitTick,
+            inst->storeTick
+        };
+        record(inst->seqNum, inst->instAddr(), inst->microPC(),
+            inst->staticInst, inst->fetchTick, stages);
+    }
+
+    /** Write the last block and the index */
+    void close();
+
+  private:
+    BlockFile file;
+
+    /** The block being filled */
+    BlockFile::Block current;
+    /** Sequence number of the last record in current */
+    InstSeqNum lastSeqNum;
+    /** Disassembly numbers in current. The instructions are held so
+     *  that their addresses aren't reused while the block is filled */
+    std::unordered_map<const StaticInst *, unsigned> disassembly;
+    std::vector<StaticInstPtr> heldInsts;
+
+    /** Hand the current block to the writer and start a new one */
+    void flush();
+};
+
+#endif // __CPU_O3_PIPEVIEW_FILE_HH__
@@ -785,7 +785,7 @@ DefaultRename<Impl>::sortInsts()
         DynInstPtr inst = fromDecode->insts[i];
         insts[inst->threadNumber].push_back(inst);
 #if TRACING_ON
-        if (DTRACE(O3PipeView)) {
+        if (cpu->pipeViewOn()) {
             inst->renameTick = curTick() - inst->fetchTick;
         }
 #endif
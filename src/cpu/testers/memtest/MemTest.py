@@ -73,3 +73,8 @@ class MemTest(MemObject):
     # accesses as Ruby needs this
     suppress_func_warnings = Param.Bool(False, "Suppress warnings when "\
                                             "functional accesses fail.")
+
+    # Verify the responses on worker threads rather than inline, this
+    # is shared by all the testers
+    check_threads = Param.Unsigned(0, "Number of threads checking the "\
+                                   "responses (0 checks them inline)")
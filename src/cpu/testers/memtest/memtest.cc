@@ -47,6 +47,7 @@
 #include "cpu/testers/memtest/memtest.hh"
 #include "debug/MemTest.hh"
 #include "mem/mem_object.hh"
+#include "sim/core.hh"
 #include "sim/sim_exit.hh"
 #include "sim/stats.hh"
 #include "sim/system.hh"
@@ -55,6 +56,39 @@ using namespace std;
 
 unsigned int TESTER_ALLOCATOR = 0;
 
+AsyncChecker<MemTest::CheckRecord> *MemTest::asyncChecker = nullptr;
+vector<unordered_map<Addr, uint8_t>> MemTest::shardReference;
+
+string
+MemTest::checkRecord(unsigned shard, const CheckRecord &rec)
+{
+    auto &reference = shardReference[shard];
+
+    if (rec.write) {
+        reference[rec.addr] = rec.data;
+        return "";
+    }
+
+    // addresses read before being written hold zero
+    auto ref = reference.find(rec.addr);
+    const uint8_t ref_data = ref == reference.end() ? 0 : ref->second;
+    if (rec.data != ref_data) {
+        return csprintf("%s: read of %x (blk %x) @ cycle %d "
+                        "returns %x, expected %x\n", rec.tester->name(),
+                        rec.addr, rec.tester->blockAlign(rec.addr), rec.when,
+                        rec.data, ref_data);
+    }
+    return "";
+}
+
+void
+MemTest::flushChecks()
+{
+    asyncChecker->flush();
+    if (asyncChecker->failed())
+        panic("%s", asyncChecker->error());
+}
+
 bool
 MemTest::CpuPort::recvTimingResp(PacketPtr pkt)
 {
@@ -108,6 +142,19 @@ MemTest::MemTest(const Params *p)
     fatal_if(id >= blockSize, "Too many testers, only %d allowed\n",
              blockSize - 1);
 
+    if (p->check_threads) {
+        if (!asyncChecker) {
+            shardReference.resize(p->check_threads);
+            asyncChecker = new AsyncChecker<CheckRecord>(p->check_threads,
+                                                         checkRecord);
+            // the last queued responses still need checking when the
+            // simulation ends
+            registerExitCallback(new FlushChecksCallback());
+        }
+        fatal_if(asyncChecker->numShards() != p->check_threads,
+                 "All testers need the same number of check threads\n");
+    }
+
     baseAddr1 = 0x100000;
     baseAddr2 = 0x400000;
     uncacheAddr = 0x800000;
@@ -156,12 +203,20 @@ MemTest::completeRequest(PacketPtr pkt, bool functional)
         }
     } else {
         if (pkt->isRead()) {
-            uint8_t ref_data = referenceData[req->getPaddr()];
-            if (pkt_data[0] != ref_data) {
-                panic("%s: read of %x (blk %x) @ cycle %d "
-                      "returns %x, expected %x\n", name(),
-                      req->getPaddr(), blockAlign(req->getPaddr()), curTick(),
-                      pkt_data[0], ref_data);
+            if (asyncChecker) {
+                pollChecks();
+                asyncChecker->push(req->getPaddr(),
+                                   CheckRecord{this, req->getPaddr(),
+                                               curTick(), pkt_data[0],
+                                               false});
+            } else {
+                uint8_t ref_data = referenceData[req->getPaddr()];
+                if (pkt_data[0] != ref_data) {
+                    panic("%s: read of %x (blk %x) @ cycle %d "
+                          "returns %x, expected %x\n", name(),
+                          req->getPaddr(), blockAlign(req->getPaddr()),
+                          curTick(), pkt_data[0], ref_data);
+                }
             }
 
             numReads++;
@@ -173,13 +228,22 @@ MemTest::completeRequest(PacketPtr pkt, bool functional)
                 nextProgressMessage += progressInterval;
             }
 
-            if (maxLoads != 0 && numReads >= maxLoads)
+            if (maxLoads != 0 && numReads >= maxLoads) {
+                if (asyncChecker)
+                    flushChecks();
                 exitSimLoop("maximum number of loads reached");
+            }
         } else {
             assert(pkt->isWrite());
 
             // update the reference data
-            referenceData[req->getPaddr()] = pkt_data[0];
+            if (asyncChecker) {
+                asyncChecker->push(req->getPaddr(),
+                                   CheckRecord{this, req->getPaddr(),
+                                               curTick(), pkt_data[0], true});
+            } else {
+                referenceData[req->getPaddr()] = pkt_data[0];
+            }
             numWrites++;
             numWritesStat++;
         }
@@ -259,12 +323,15 @@ MemTest::tick()
     if (cmd < percentReads) {
         // start by ensuring there is a reference value if we have not
         // seen this address before
+        // (the check threads own the reference data otherwise)
         uint8_t M5_VAR_USED ref_data = 0;
-        auto ref = referenceData.find(req->getPaddr());
-        if (ref == referenceData.end()) {
-            referenceData[req->getPaddr()] = 0;
-        } else {
-            ref_data = ref->second;
+        if (!asyncChecker) {
+            auto ref = referenceData.find(req->getPaddr());
+            if (ref == referenceData.end()) {
+                referenceData[req->getPaddr()] = 0;
+            } else {
+                ref_data = ref->second;
+            }
         }
 
         DPRINTF(MemTest,
@@ -46,8 +46,12 @@
 #define __CPU_MEMTEST_MEMTEST_HH__
 
 #include <set>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "base/async_checker.hh"
+#include "base/callback.hh"
 #include "base/statistics.hh"
 #include "mem/mem_object.hh"
 #include "params/MemTest.hh"
@@ -66,6 +70,12 @@
  * In addition to verifying the data, the tester also has timeouts for
  * both requests and responses, thus checking that the memory-system
  * is making progress.
+ *
+ * With check_threads set, the responses are not verified on the
+ * simulation thread. They are queued to worker threads holding a
+ * reference model sharded by address, shared by all the testers (each
+ * address is only touched by one of them). The simulation only stops
+ * early once a worker found a mismatch.
  */
 class MemTest : public MemObject
 {
@@ -139,6 +149,51 @@ class MemTest : public MemObject
     // store the expected value for the addresses we have touched
     std::unordered_map<Addr, uint8_t> referenceData;
 
+    /** A completed access, for the reference model workers */
+    struct CheckRecord
+    {
+        const MemTest *tester;
+        Addr addr;
+        Tick when;
+        uint8_t data;
+        bool write;
+    };
+
+    /**
+     * The workers verifying the responses of all the testers, and the
+     * part of the reference data each of them owns. Only used with
+     * check_threads set.
+     */
+    static AsyncChecker<CheckRecord> *asyncChecker;
+    static std::vector<std::unordered_map<Addr, uint8_t>> shardReference;
+
+    /** Update or check the reference data of a shard (worker thread) */
+    static std::string checkRecord(unsigned shard, const CheckRecord &rec);
+
+    /** Wait for the queued checks and stop on a mismatch */
+    static void flushChecks();
+
+    /** Check the last queued responses when the simulation ends */
+    class FlushChecksCallback : public Callback
+    {
+      public:
+        void
+        process()
+        {
+            flushChecks();
+            delete asyncChecker;
+            asyncChecker = nullptr;
+        }
+    };
+
+    /** Stop if a worker found a mismatch */
+    void
+    pollChecks() const
+    {
+        if (asyncChecker->failed())
+            panic("%s", asyncChecker->error());
+    }
+
     const unsigned blockSize;
 
     const Addr blockAddrMask;
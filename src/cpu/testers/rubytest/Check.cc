@@ -309,18 +309,36 @@ Check::performCallback(NodeID proc, SubBlock* data, Cycles curTime)
                 data->getByte(0));
     } else if (m_status == TesterStatus_Check_Pending) {
         DPRINTF(RubyTest, "Check callback\n");
-        // Perform load/check
-        for (int byte_number=0; byte_number<CHECK_SIZE; byte_number++) {
-            if (uint8_t(m_value + byte_number) != data->getByte(byte_number)) {
-                panic("Action/check failure: proc: %d address: %s data: %s "
-                      "byte_number: %d m_value+byte_number: %d byte: %d %s"
-                      "Time: %d\n",
-                      proc, address, data, byte_number,
-                      (int)m_value + byte_number,
-                      (int)data->getByte(byte_number), *this, curTime);
+        AsyncChecker<RubyCheckRecord> *checker = m_tester_ptr->getAsyncChecker();
+        if (checker) {
+            // Leave the load/check to a check thread
+            RubyCheckRecord record;
+            record.proc = proc;
+            record.address = address;
+            record.time = curTime;
+            record.value = m_value;
+            record.checkAddress = m_address;
+            record.initiatingNode = m_initiatingNode;
+            record.storeCount = m_store_count;
+            for (int byte_number=0; byte_number<CHECK_SIZE; byte_number++) {
+                record.data[byte_number] = data->getByte(byte_number);
             }
+            checker->push(address, record);
+        } else {
+            // Perform load/check
+            for (int byte_number=0; byte_number<CHECK_SIZE; byte_number++) {
+                if (uint8_t(m_value + byte_number) !=
+                    data->getByte(byte_number)) {
+                    panic("Action/check failure: proc: %d address: %s "
+                          "data: %s byte_number: %d m_value+byte_number: %d "
+                          "byte: %d %sTime: %d\n",
+                          proc, address, data, byte_number,
+                          (int)m_value + byte_number,
+                          (int)data->getByte(byte_number), *this, curTime);
+                }
+            }
+            DPRINTF(RubyTest, "Action/check success\n");
         }
-        DPRINTF(RubyTest, "Action/check success\n");
         debugPrint();
 
         // successful check complete, increment complete
@@ -390,3 +408,29 @@ Check::debugPrint()
         m_address, (int)m_value, TesterStatus_to_string(m_status).c_str(),
         m_initiatingNode, m_store_count);
 }
+
+std::string
+Check::verify(unsigned shard, const RubyCheckRecord &record)
+{
+    for (int byte_number=0; byte_number<CHECK_SIZE; byte_number++) {
+        if (uint8_t(record.value + byte_number) != record.data[byte_number]) {
+            std::string data;
+            for (int i = 0; i < CHECK_SIZE; i++)
+                data += csprintf(" %d", (int)record.data[i]);
+            return csprintf("Action/check failure: proc: %d address: %#x "
+                            "data: [%s ] byte_number: %d "
+                            "m_value+byte_number: %d byte: %d "
+                            "[%#x, value: %d, status: %s, initiating node: "
+                            "%d, store_count: %d]Time: %d\n",
+                            record.proc, record.address, data, byte_number,
+                            (int)record.value + byte_number,
+                            (int)record.data[byte_number],
+                            record.checkAddress, (int)record.value,
+                            TesterStatus_to_string(
+                                TesterStatus_Check_Pending),
+                            record.initiatingNode, record.storeCount,
+                            record.time);
+        }
+    }
+    return "";
+}
@@ -31,6 +31,7 @@
 #define __CPU_RUBYTEST_CHECK_HH__
 
 #include <iostream>
+#include <string>
 
 #include "cpu/testers/rubytest/RubyTester.hh"
 #include "mem/protocol/RubyAccessMode.hh"
@@ -42,6 +43,20 @@ class SubBlock;
 const int CHECK_SIZE_BITS = 2;
 const int CHECK_SIZE = (1 << CHECK_SIZE_BITS);
 
+// The data a check read back, verified later by a check thread, with
+// the state of the check for the failure message
+struct RubyCheckRecord
+{
+    NodeID proc;
+    Addr address;
+    Cycles time;
+    uint8_t value;
+    uint8_t data[CHECK_SIZE];
+    Addr checkAddress;
+    NodeID initiatingNode;
+    int storeCount;
+};
+
 class Check
 {
   public:
@@ -55,6 +70,9 @@ class Check
 
     void print(std::ostream& out) const;
 
+    // Verify the data of a check on a check thread, "" if it is correct
+    static std::string verify(unsigned shard, const RubyCheckRecord &record);
+
   private:
     void initiateFlush();
     void initiatePrefetch();
@@ -59,10 +59,16 @@ RubyTester::RubyTester(const Params *p)
     m_wakeup_frequency(p->wakeup_frequency),
     m_check_flush(p->check_flush),
     m_num_inst_only_ports(p->port_cpuInstPort_connection_count),
-    m_num_inst_data_ports(p->port_cpuInstDataPort_connection_count)
+    m_num_inst_data_ports(p->port_cpuInstDataPort_connection_count),
+    asyncChecker(nullptr)
 {
     m_checks_completed = 0;
 
+    if (p->check_threads) {
+        asyncChecker = new AsyncChecker<RubyCheckRecord>(p->check_threads,
+                                                     Check::verify);
+    }
+
     //
     // Create the requested inst and data ports and place them on the
     // appropriate read and write port lists.  The reason for the subtle
@@ -102,6 +108,7 @@ RubyTester::RubyTester(const Params *p)
 RubyTester::~RubyTester()
 {
     delete m_checkTable_ptr;
+    delete asyncChecker;
     // Only delete the readPorts since the writePorts are just a subset
     for (int i = 0; i < readPorts.size(); i++)
         delete readPorts[i];
@@ -240,6 +247,11 @@ RubyTester::hitCallback(NodeID proc, SubBlock* data)
 void
 RubyTester::wakeup()
 {
+    // Stop as soon as a check thread found a failure
+    if (asyncChecker && asyncChecker->failed()) {
+        panic("%s", asyncChecker->error());
+    }
+
     if (m_checks_completed < m_checks_to_complete) {
         // Try to perform an action or check
         Check* check_ptr = m_checkTable_ptr->getRandomCheck();
@@ -250,6 +262,13 @@ RubyTester::wakeup()
 
         schedule(checkStartEvent, curTick() + m_wakeup_frequency);
     } else {
+        if (asyncChecker) {
+            // The last checks may still be queued
+            asyncChecker->flush();
+            if (asyncChecker->failed()) {
+                panic("%s", asyncChecker->error());
+            }
+        }
         exitSimLoop("Ruby Tester completed");
     }
 }
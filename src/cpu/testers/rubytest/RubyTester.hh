@@ -46,6 +46,7 @@
 #include <string>
 #include <vector>
 
+#include "base/async_checker.hh"
 #include "cpu/testers/rubytest/CheckTable.hh"
 #include "mem/mem_object.hh"
 #include "mem/packet.hh"
@@ -53,6 +54,8 @@
 #include "mem/ruby/common/TypeDefines.hh"
 #include "params/RubyTester.hh"
 
+struct RubyCheckRecord;
+
 class RubyTester : public MemObject
 {
   public:
@@ -117,6 +120,9 @@ class RubyTester : public MemObject
     bool getCheckFlush() { return m_check_flush; }
 
     MasterID masterId() { return _masterId; }
+
+    // The threads verifying the checks, nullptr to verify them inline
+    AsyncChecker<RubyCheckRecord> *getAsyncChecker() { return asyncChecker; }
   protected:
     class CheckStartEvent : public Event
     {
@@ -159,6 +165,7 @@ class RubyTester : public MemObject
     bool m_check_flush;
     int m_num_inst_only_ports;
     int m_num_inst_data_ports;
+    AsyncChecker<RubyCheckRecord> *asyncChecker;
 };
 
 inline std::ostream&
@@ -41,4 +41,6 @@ class RubyTester(MemObject):
     deadlock_threshold = Param.Int(50000, "how often to check for deadlock")
     wakeup_frequency = Param.Int(10, "number of cycles between wakeups")
     check_flush = Param.Bool(False, "check cache flushing")
+    check_threads = Param.Unsigned(0, "number of threads verifying the "\
+                                   "checks (0 verifies them inline)")
     system = Param.System(Parent.any, "System we belong to")
@@ -44,7 +44,6 @@
 #include "base/trace.hh"
 #include "cpu/testers/traffic_gen/generators.hh"
 #include "debug/TrafficGen.hh"
-#include "proto/packet.pb.h"
 
 BaseGen::BaseGen(const std::string& _name, MasterID master_id, Tick _duration)
     : _name(_name), masterID(master_id), duration(_duration)
@@ -436,13 +435,12 @@ TraceGen::InputStream::reset()
 bool
 TraceGen::InputStream::read(TraceElement& element)
 {
-    ProtoMessage::Packet pkt_msg;
-    if (trace.read(pkt_msg)) {
-        element.cmd = pkt_msg.cmd();
-        element.addr = pkt_msg.addr();
-        element.blocksize = pkt_msg.size();
-        element.tick = pkt_msg.tick();
-        element.flags = pkt_msg.has_flags() ? pkt_msg.flags() : 0;
+    if (trace.read(pktMsg)) {
+        element.cmd = pktMsg.cmd();
+        element.addr = pktMsg.addr();
+        element.blocksize = pktMsg.size();
+        element.tick = pktMsg.tick();
+        element.flags = pktMsg.has_flags() ? pktMsg.flags() : 0;
         return true;
     }
 
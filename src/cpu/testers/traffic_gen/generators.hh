@@ -53,6 +53,7 @@
 #include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "mem/packet.hh"
+#include "proto/packet.pb.h"
 #include "proto/protoio.hh"
 
 /**
@@ -549,6 +550,9 @@ class TraceGen : public BaseGen
         /// Input file stream for the protobuf trace
         ProtoInputStream trace;
 
+        /// Packet message reused for every element read
+        ProtoMessage::Packet pktMsg;
+
       public:
 
         /**
@@ -50,6 +50,18 @@ class DmaDevice(PioDevice):
     abstract = True
     dma = MasterPort("DMA port")
 
+    # Fault injection into the DMA transfers of the device
+    injectFaultDma = Param.Bool(False, "Inject a single-bit fault in a DMA "
+                                "transfer of this device")
+    injectTime = Param.UInt64(0, "Time to inject fault")
+    injectLoc = Param.Unsigned(0, "Bit location to inject fault, relative "
+                               "to the targeted part of the transfer")
+    injectAddr = Param.Addr(0, "Start of the targeted physical address range")
+    injectLen = Param.Addr(0, "Size of the targeted physical address range "
+                           "(0 for any transfer)")
+    injectMaskedExit = Param.Bool(False, "Exit as soon as the corrupted data "
+                                  "is overwritten before being read")
+
 
 class IsaFake(BasicPioDevice):
     type = 'IsaFake'
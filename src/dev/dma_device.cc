@@ -48,6 +48,7 @@
 #include <utility>
 
 #include "base/chunk_generator.hh"
+#include "base/softerror.hh"
 #include "debug/DMA.hh"
 #include "debug/Drain.hh"
 #include "sim/system.hh"
@@ -55,7 +56,8 @@
 DmaPort::DmaPort(MemObject *dev, System *s)
     : MasterPort(dev->name() + ".dma", dev),
       device(dev), sys(s), masterId(s->getMasterId(dev->name())),
-      sendEvent(this), pendingCount(0), inRetry(false)
+      sendEvent(this), pendingCount(0), inRetry(false),
+      injEnabled(false), faultyPkt(nullptr), faultyAddr(0)
 { }
 
 void
@@ -78,6 +80,23 @@ DmaPort::handleResp(PacketPtr pkt, Tick delay)
     assert(pendingCount != 0);
     pendingCount--;
 
+    if (pkt == faultyPkt) {
+        // the corrupted data has reached the memory system, follow it
+        // from there on
+        SoftError::taintMem(faultyAddr,
+                            pkt->getConstPtr<uint8_t>()[faultyAddr -
+                                                        pkt->getAddr()]);
+        faultyPkt = nullptr;
+    } else if (injEnabled && pkt->isRead() && pkt->hasData() &&
+               SoftError::dmaInjReady(pkt->getAddr(), pkt->getSize())) {
+        // the device uses whatever it reads, so a fault in the read
+        // data is consumed right away
+        const Addr addr = SoftError::injectDma(name(), pkt->getAddr(),
+                                               pkt->getPtr<uint8_t>(),
+                                               pkt->getSize());
+        SoftError::dmaConsumed(name(), addr);
+    }
+
     // update the number of bytes received based on the request rather
     // than the packet as the latter could be rounded up to line sizes
     state->numBytes += pkt->req->getSize();
@@ -116,7 +135,14 @@ DmaPort::recvTimingResp(PacketPtr pkt)
 
 DmaDevice::DmaDevice(const Params *p)
     : PioDevice(p), dmaPort(this, sys)
-{ }
+{
+    if (p->injectFaultDma) {
+        SoftError::registerDmaInj(p->injectTime, p->injectLoc,
+                                  p->injectAddr, p->injectLen,
+                                  p->injectMaskedExit);
+        dmaPort.enableInj();
+    }
+}
 
 void
 DmaDevice::init()
@@ -171,6 +197,14 @@ DmaPort::dmaAction(Packet::Command cmd, Addr addr, int size, Event *event,
         if (data)
             pkt->dataStatic(data + gen.complete());
 
+        if (injEnabled && data && pkt->isWrite() &&
+            SoftError::dmaInjReady(gen.addr(), gen.size())) {
+            faultyAddr = SoftError::injectDma(name(), gen.addr(),
+                                              data + gen.complete(),
+                                              gen.size());
+            faultyPkt = pkt;
+        }
+
         pkt->senderState = reqState;
 
         DPRINTF(DMA, "--Queuing DMA for addr: %#x size: %d\n", gen.addr(),
@@ -132,6 +132,15 @@ class DmaPort : public MasterPort, public Drainable
      * send whatever it is that it's sending. */
     bool inRetry;
 
+    /** Are transfers through this port fault injection targets? */
+    bool injEnabled;
+
+    /** Write packet carrying the injected fault, if not yet acked */
+    PacketPtr faultyPkt;
+
+    /** Address of the corrupted byte in faultyPkt */
+    Addr faultyAddr;
+
   protected:
 
     bool recvTimingResp(PacketPtr pkt) override;
@@ -148,6 +157,9 @@ class DmaPort : public MasterPort, public Drainable
 
     bool dmaPending() const { return pendingCount > 0; }
 
+    /** Make the transfers of this port DMA fault injection targets */
+    void enableInj() { injEnabled = true; }
+
     DrainState drain() override;
 };
 
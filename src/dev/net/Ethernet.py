@@ -58,6 +58,10 @@ class EtherLink(EtherObject):
     speed = Param.NetworkBandwidth('1Gbps', "link speed")
     dump = Param.EtherDump(NULL, "dump object")
 
+# Transport used to exchange messages among the dist-gem5 processes. The
+# shared memory transport only works if all the processes are on one host.
+class DistTransport(Enum): vals = ['tcp', 'shm']
+
 class DistEtherLink(EtherObject):
     type = 'DistEtherLink'
     cxx_header = "dev/net/dist_etherlink.hh"
@@ -70,10 +74,18 @@ class DistEtherLink(EtherObject):
     dist_size = Param.UInt32('1', "Number of gem5 processes (dist run)")
     sync_start = Param.Latency('5200000000000t', "first dist sync barrier")
     sync_repeat = Param.Latency('10us', "dist sync barrier repeat")
+    adaptive_sync = Param.Bool(False, "Stretch the dist sync barrier repeat "
+                               "while no packet can be sent")
     server_name = Param.String('localhost', "Message server name")
     server_port = Param.UInt32('2200', "Message server port")
     is_switch = Param.Bool(False, "true if this a link in etherswitch")
     num_nodes = Param.UInt32('2', "Number of simulate nodes")
+    transport = Param.DistTransport('tcp', "Message transport among the "
+                                    "gem5 processes")
+    shm_name = Param.String('', "Shared memory segment name prefix "
+                            "(default: derived from server_port)")
+    shm_ring_size = Param.MemorySize('4MB', "Size of each shared memory "
+                                     "message ring (power of two)")
 
 class EtherBus(EtherObject):
     type = 'EtherBus'
@@ -63,6 +63,7 @@
 #include "dev/net/etherlink.hh"
 #include "dev/net/etherobject.hh"
 #include "dev/net/etherpkt.hh"
+#include "dev/net/shm_iface.hh"
 #include "dev/net/tcp_iface.hh"
 #include "params/EtherLink.hh"
 #include "sim/core.hh"
@@ -91,11 +92,22 @@ DistEtherLink::DistEtherLink(const Params *p)
         sync_repeat = p->delay;
     }
 
-    // create the dist (TCP) interface to talk to the peer gem5 processes.
-    distIface = new TCPIface(p->server_name, p->server_port,
-                             p->dist_rank, p->dist_size,
-                             p->sync_start, sync_repeat, this, p->is_switch,
-                             p->num_nodes);
+    // create the dist interface to talk to the peer gem5 processes.
+    if (p->transport == Enums::shm) {
+        string shm_name = p->shm_name.empty() ?
+            csprintf("gem5-dist-%d", p->server_port) : p->shm_name;
+        distIface = new ShmIface(shm_name, p->shm_ring_size,
+                                 p->dist_rank, p->dist_size,
+                                 p->sync_start, sync_repeat, this,
+                                 p->is_switch, p->num_nodes,
+                                 p->adaptive_sync);
+    } else {
+        distIface = new TCPIface(p->server_name, p->server_port,
+                                 p->dist_rank, p->dist_size,
+                                 p->sync_start, sync_repeat, this,
+                                 p->is_switch, p->num_nodes,
+                                 p->adaptive_sync);
+    }
 
     localIface = new LocalIface(name() + ".int0", txLink, rxLink, distIface);
 }
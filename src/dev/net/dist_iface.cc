@@ -62,8 +62,13 @@ unsigned DistIface::recvThreadsNum = 0;
 DistIface *DistIface::master = nullptr;
 
 void
-DistIface::Sync::init(Tick start_tick, Tick repeat_tick)
+DistIface::Sync::init(Tick start_tick, Tick repeat_tick, bool adaptive_sync)
 {
+    // Adaptive sync is only used if all the links of this process ask for
+    // it. Peers that do not use it report no lookahead so the sync interval
+    // never gets stretched beyond their needs.
+    adaptive = adaptive && adaptive_sync;
+
     if (start_tick < firstAt) {
         firstAt = start_tick;
         inform("Next dist synchronisation tick is changed to %lu.\n", nextAt);
@@ -79,17 +84,51 @@ DistIface::Sync::init(Tick start_tick, Tick repeat_tick)
     }
 }
 
+void
+DistIface::Sync::recordSend(Tick send_tick, Tick send_delay)
+{
+    // The peer may react to the packet as soon as it arrives. The sync
+    // repeat is a lower bound for the link delay.
+    Tick arrival = send_tick + send_delay + nextRepeat;
+    Tick cur = minArrival.load();
+    while (arrival < cur && !minArrival.compare_exchange_weak(cur, arrival))
+        ;
+}
+
+Tick
+DistIface::Sync::localEarliestSend()
+{
+    Tick earliest = minArrival.exchange(MaxTick);
+    if (!adaptive)
+        return curTick();
+
+    // Nothing can happen in this process before its next event so that is
+    // the earliest a data packet may be sent. Packets that peers sent in
+    // the current quantum are covered by the arrival ticks they report.
+    for (uint32_t i = 0; i < numMainEventQueues; ++i) {
+        EventQueue *eq = mainEventQueue[i];
+        std::lock_guard<EventQueue> eq_lock(*eq);
+        if (!eq->empty())
+            earliest = std::min(earliest, eq->nextTick());
+    }
+    return std::max(earliest, curTick());
+}
+
 DistIface::SyncSwitch::SyncSwitch(int num_nodes)
 {
     numNodes = num_nodes;
     waitNum = num_nodes;
     numExitReq = 0;
     numCkptReq = 0;
+    minReqSend = MaxTick;
     doExit = false;
     doCkpt = false;
     firstAt = std::numeric_limits<Tick>::max();
     nextAt = 0;
     nextRepeat = std::numeric_limits<Tick>::max();
+    adaptive = true;
+    nextSend = 0;
+    minArrival = MaxTick;
 }
 
 DistIface::SyncNode::SyncNode()
@@ -102,6 +141,9 @@ DistIface::SyncNode::SyncNode()
     firstAt = std::numeric_limits<Tick>::max();
     nextAt = 0;
     nextRepeat = std::numeric_limits<Tick>::max();
+    adaptive = true;
+    nextSend = 0;
+    minArrival = MaxTick;
 }
 
 void
@@ -116,6 +158,7 @@ DistIface::SyncNode::run(bool same_tick)
     header.msgType = MsgType::cmdSyncReq;
     header.sendTick = curTick();
     header.syncRepeat = nextRepeat;
+    header.earliestSend = localEarliestSend();
     header.needCkpt = needCkpt;
     if (needCkpt != ReqType::none)
         needCkpt = ReqType::pending;
@@ -148,6 +191,9 @@ DistIface::SyncSwitch::run(bool same_tick)
     header.msgType = MsgType::cmdSyncAck;
     header.sendTick = nextAt;
     header.syncRepeat = nextRepeat;
+    nextSend = std::min(minReqSend, localEarliestSend());
+    minReqSend = MaxTick;
+    header.earliestSend = nextSend;
     if (doCkpt || numCkptReq == numNodes) {
         doCkpt = true;
         header.needCkpt = ReqType::immediate;
@@ -167,6 +213,7 @@ DistIface::SyncSwitch::run(bool same_tick)
 void
 DistIface::SyncSwitch::progress(Tick send_tick,
                                  Tick sync_repeat,
+                                 Tick earliest_send,
                                  ReqType need_ckpt,
                                  ReqType need_exit)
 {
@@ -177,6 +224,8 @@ DistIface::SyncSwitch::progress(Tick send_tick,
         nextAt = send_tick;
     if (nextRepeat > sync_repeat)
         nextRepeat = sync_repeat;
+    if (minReqSend > earliest_send)
+        minReqSend = earliest_send;
 
     if (need_ckpt == ReqType::collective)
         numCkptReq++;
@@ -198,6 +247,7 @@ DistIface::SyncSwitch::progress(Tick send_tick,
 void
 DistIface::SyncNode::progress(Tick max_send_tick,
                                Tick next_repeat,
+                               Tick earliest_send,
                                ReqType do_ckpt,
                                ReqType do_exit)
 {
@@ -206,6 +256,7 @@ DistIface::SyncNode::progress(Tick max_send_tick,
 
     nextAt = max_send_tick;
     nextRepeat = next_repeat;
+    nextSend = earliest_send;
     doCkpt = (do_ckpt != ReqType::none);
     doExit = (do_exit != ReqType::none);
 
@@ -354,8 +405,21 @@ DistIface::SyncEvent::process()
         exitSimLoop("exit request from gem5 peers");
 
     // schedule the next periodic sync
+    lastAt = curTick();
     repeat = DistIface::sync->nextRepeat;
-    schedule(curTick() + repeat);
+    Tick next_at = curTick() + repeat;
+    if (DistIface::sync->adaptive) {
+        // No peer can send a data packet before nextSend and any packet
+        // sent after that arrives at least one repeat later, so the next
+        // barrier may be pushed out to just before that point (a packet
+        // must arrive strictly after the barrier of its quantum). All the
+        // peers got the same nextSend so they all agree on the next sync
+        // tick.
+        Tick earliest_send = std::min(DistIface::sync->nextSend,
+                                      MaxTick - repeat);
+        next_at = std::max(next_at, earliest_send + repeat - 1);
+    }
+    schedule(next_at);
 }
 
 void
@@ -435,7 +499,9 @@ DistIface::RecvScheduler::pushPacket(EthPacketPtr new_packet,
     DPRINTF(DistEthernetPkt, "DistIface::recvScheduler::pushPacket "
             "send_tick:%llu send_delay:%llu link_delay:%llu recv_tick:%llu\n",
             send_tick, send_delay, linkDelay, recv_tick);
-    // Every packet must be sent and arrive in the same quantum
+    // Every packet must be sent in the current quantum, and with adaptive
+    // sync no earlier than the send bound the barrier was placed after
+    assert(send_tick >= master->syncEvent->lastSync());
     assert(send_tick > master->syncEvent->when() -
            master->syncEvent->repeat);
     // No packet may be scheduled for receive in the arrival quantum
@@ -537,9 +603,10 @@ DistIface::DistIface(unsigned dist_rank,
                      Tick sync_start,
                      Tick sync_repeat,
                      EventManager *em,
-                     bool is_switch, int num_nodes) :
+                     bool is_switch, int num_nodes,
+                     bool adaptive_sync) :
     syncStart(sync_start), syncRepeat(sync_repeat),
-    recvThread(nullptr), recvScheduler(em),
+    adaptiveSync(adaptive_sync), recvThread(nullptr), recvScheduler(em),
     rank(dist_rank), size(dist_size)
 {
     DPRINTF(DistEthernet, "DistIface() ctor rank:%d\n",dist_rank);
@@ -585,6 +652,9 @@ DistIface::packetOut(EthPacketPtr pkt, Tick send_delay)
 
     header.dataPacketLength = pkt->size();
 
+    // Let the sync know about the packet in flight (adaptive sync)
+    sync->recordSend(curTick(), send_delay);
+
     // Send out the packet and the meta info.
     sendPacket(header, pkt);
 
@@ -626,6 +696,7 @@ DistIface::recvThreadFunc(Event *recv_done, Tick link_delay)
             // everything else must be synchronisation related command
             sync->progress(header.sendTick,
                            header.syncRepeat,
+                           header.earliestSend,
                            header.needCkpt,
                            header.needExit);
         }
@@ -718,7 +789,7 @@ DistIface::init(const Event *done_event, Tick link_delay)
     // might have different requirements. The singleton sync object
     // will select the minimum values for both params.
     assert(sync != nullptr);
-    sync->init(syncStart, syncRepeat);
+    sync->init(syncStart, syncRepeat, adaptiveSync);
 
     // Initialize the seed for random generator to avoid the same sequence
     // in all gem5 peer processes
@@ -68,16 +68,28 @@
  * transmission delay to ensure that a corresponding receive event can always
  * be scheduled for any message coming in from a peer gem5 process.
  *
+ * With adaptive synchronisation enabled, every process also reports a lower
+ * bound for the tick of its next data packet at each barrier (its next
+ * local event or the arrival of a packet it has just sent, whichever comes
+ * first). No packet can be sent before the global minimum of these bounds,
+ * so the next barrier can be put one quantum after that minimum instead of
+ * one quantum after the current barrier. This skips barriers while the
+ * simulated network and the simulated systems are idle and has no effect on
+ * simulated timing.
+ *
  *
  *
  * This interface is an abstract class. It can work with various low level
  * send/receive service implementations (e.g. TCP/IP, MPI,...). A TCP
  * stream socket version is implemented in src/dev/net/tcp_iface.[hh,cc].
+ * A shared memory version for single host runs is implemented in
+ * src/dev/net/shm_iface.[hh,cc].
  */
 #ifndef __DEV_DIST_IFACE_HH__
 #define __DEV_DIST_IFACE_HH__
 
 #include <array>
+#include <atomic>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -150,18 +162,52 @@ class DistIface : public Drainable, public Serializable
          * Tick for the next periodic sync (if the event is not scheduled yet)
          */
         Tick nextAt;
+        /**
+         * Flag is set if all the local links asked for adaptive sync
+         */
+        bool adaptive;
+        /**
+         * Lower bound for the send tick of the next data packet of any
+         * gem5 peer, as agreed on at the last sync (adaptive sync only)
+         */
+        Tick nextSend;
+        /**
+         * Earliest tick a data packet sent by this process since the last
+         * sync may arrive at its destination
+         */
+        std::atomic<Tick> minArrival;
 
         friend class SyncEvent;
 
+        /**
+         * Lower bound for the tick of the next data packet this process
+         * may send. It is the earliest of the next local event and the
+         * arrival of the data packets sent in the current quantum (that may
+         * trigger a reply at the peer).
+         *
+         * @note Must be called while all the simulation threads are
+         * waiting at the sync barrier.
+         */
+        Tick localEarliestSend();
+
       public:
         /**
          * Initialize periodic sync params.
          *
          * @param start Start tick for dist synchronisation
          * @param repeat Frequency of dist synchronisation
+         * @param adaptive_sync Stretch the sync interval while no packet
+         * can be sent
          *
          */
-        void init(Tick start, Tick repeat);
+        void init(Tick start, Tick repeat, bool adaptive_sync);
+        /**
+         * Record a data packet sent by this process.
+         *
+         * @param send_tick Tick the packet was sent
+         * @param send_delay The simulated delay at the sender side
+         */
+        void recordSend(Tick send_tick, Tick send_delay);
         /**
          *  Core method to perform a full dist sync.
          */
@@ -171,6 +217,7 @@ class DistIface : public Drainable, public Serializable
          */
         virtual void progress(Tick send_tick,
                               Tick next_repeat,
+                              Tick earliest_send,
                               ReqType do_ckpt,
                               ReqType do_exit) = 0;
 
@@ -202,6 +249,7 @@ class DistIface : public Drainable, public Serializable
         void run(bool same_tick) override;
         void progress(Tick max_req_tick,
                       Tick next_repeat,
+                      Tick earliest_send,
                       ReqType do_ckpt,
                       ReqType do_exit) override;
 
@@ -227,6 +275,10 @@ class DistIface : public Drainable, public Serializable
          *  Number of connected simulated nodes
          */
         unsigned numNodes;
+        /**
+         * Minimum of the earliest send ticks reported by the nodes
+         */
+        Tick minReqSend;
 
       public:
         SyncSwitch(int num_nodes);
@@ -235,6 +287,7 @@ class DistIface : public Drainable, public Serializable
         void run(bool same_tick) override;
         void progress(Tick max_req_tick,
                       Tick next_repeat,
+                      Tick earliest_send,
                       ReqType do_ckpt,
                       ReqType do_exit) override;
 
@@ -268,12 +321,17 @@ class DistIface : public Drainable, public Serializable
          * Flag to set when the system is draining
          */
         bool _draining;
+        /**
+         * Tick of the last completed periodic sync
+         */
+        Tick lastAt;
       public:
         /**
          * Only the firstly instantiated DistIface object will
          * call this constructor.
          */
-        SyncEvent() : GlobalSyncEvent(Sim_Exit_Pri, 0), _draining(false) {}
+        SyncEvent() : GlobalSyncEvent(Sim_Exit_Pri, 0), _draining(false),
+                      lastAt(0) {}
 
         ~SyncEvent() {}
         /**
@@ -289,6 +347,8 @@ class DistIface : public Drainable, public Serializable
 
         bool draining() const { return _draining; }
         void draining(bool fl) { _draining = fl; }
+
+        Tick lastSync() const { return lastAt; }
     };
     /**
      * Class to encapsulate information about data packets received.
@@ -428,6 +488,10 @@ class DistIface : public Drainable, public Serializable
      * Frequency of dist sync events in ticks.
      */
     Tick syncRepeat;
+    /**
+     * Stretch the sync interval while no packet can be sent.
+     */
+    bool adaptiveSync;
     /**
      * Receiver thread pointer.
      * Each DistIface object must have exactly one receiver thread.
@@ -527,6 +591,8 @@ class DistIface : public Drainable, public Serializable
      * @param sync_start Start tick for dist synchronisation
      * @param sync_repeat Frequency for dist synchronisation
      * @param em The event manager associated with the simulated Ethernet link
+     * @param adaptive_sync Stretch the sync interval while no packet can be
+     * sent
      */
     DistIface(unsigned dist_rank,
               unsigned dist_size,
@@ -534,7 +600,8 @@ class DistIface : public Drainable, public Serializable
               Tick sync_repeat,
               EventManager *em,
               bool is_switch,
-              int num_nodes);
+              int num_nodes,
+              bool adaptive_sync = false);
 
     virtual ~DistIface();
     /**
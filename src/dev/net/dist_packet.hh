@@ -100,6 +100,12 @@ class DistHeaderPkt
                 ReqType needExit;
             };
         };
+        /**
+         * Lower bound for the tick of the next data packet the sender (sync
+         * request) or any of the gem5 peers (sync ack) may send. Only valid
+         * for sync messages and only used by adaptive synchronisation.
+         */
+        Tick earliestSend;
     };
 };
 
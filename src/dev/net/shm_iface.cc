@@ -0,0 +1,419 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* @file
+ * Shared memory based interface class implementation for dist-gem5 runs.
+ */
+
+#include "dev/net/shm_iface.hh"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#endif
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "base/types.hh"
+#include "debug/DistEthernet.hh"
+#include "debug/DistEthernetCmd.hh"
+
+using namespace std;
+
+vector<ShmIface::Ring *> ShmIface::ringRegistry;
+
+namespace {
+
+/**
+ * Number of polling iterations before a waiting thread gives up the CPU.
+ * Peers usually arrive at a sync barrier within a few microseconds of each
+ * other so spinning for a while avoids most of the futex calls.
+ */
+const unsigned spinLimit = 1 << 14;
+
+inline void
+cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * The futex word is shared between processes so we cannot use the
+ * FUTEX_PRIVATE variants. The wait has a timeout to make sure a missed
+ * close() can never hang the receiver thread for good.
+ */
+inline void
+futexWait(std::atomic<uint32_t> *addr, uint32_t val)
+{
+#if defined(__linux__)
+    struct timespec ts = { 0, 100 * 1000 * 1000 };
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAIT,
+            val, &ts, nullptr, 0);
+#else
+    usleep(50);
+#endif
+}
+
+inline void
+futexWake(std::atomic<uint32_t> *addr)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAKE,
+            INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+} // anonymous namespace
+
+void
+ShmIface::Ring::init(uint64_t size)
+{
+    head.store(0);
+    tail.store(0);
+    seq.store(0);
+    sleeping.store(0);
+    closed.store(0);
+    capacity = size;
+}
+
+void
+ShmIface::Ring::copyIn(uint64_t pos, const void *buf, unsigned length)
+{
+    const uint64_t offset = pos & (capacity - 1);
+    const uint64_t first = min<uint64_t>(length, capacity - offset);
+    memcpy(data() + offset, buf, first);
+    if (first < length)
+        memcpy(data(), static_cast<const uint8_t *>(buf) + first,
+               length - first);
+}
+
+void
+ShmIface::Ring::copyOut(uint64_t pos, void *buf, unsigned length)
+{
+    const uint64_t offset = pos & (capacity - 1);
+    const uint64_t first = min<uint64_t>(length, capacity - offset);
+    memcpy(buf, data() + offset, first);
+    if (first < length)
+        memcpy(static_cast<uint8_t *>(buf) + first, data(), length - first);
+}
+
+void
+ShmIface::Ring::wakeup()
+{
+    seq.fetch_add(1);
+    if (sleeping.load())
+        futexWake(&seq);
+}
+
+void
+ShmIface::Ring::push(const void *buf0, unsigned len0,
+                     const void *buf1, unsigned len1)
+{
+    const uint64_t length = len0 + len1;
+    panic_if(length > capacity, "Dist message (%d bytes) does not fit into "
+             "the shared memory ring (%d bytes)", length, capacity);
+
+    const uint64_t pos = tail.load(std::memory_order_relaxed);
+    // Wait for the consumer to make room. This only happens if the peer
+    // falls behind by a whole ring worth of packets.
+    for (unsigned spins = 0;
+         pos + length - head.load(std::memory_order_acquire) > capacity;
+         spins++) {
+        if (spins < spinLimit)
+            cpuRelax();
+        else
+            sched_yield();
+    }
+
+    copyIn(pos, buf0, len0);
+    if (len1 > 0)
+        copyIn(pos + len0, buf1, len1);
+    tail.store(pos + length, std::memory_order_release);
+    wakeup();
+}
+
+bool
+ShmIface::Ring::pop(void *buf, unsigned length)
+{
+    const uint64_t pos = head.load(std::memory_order_relaxed);
+
+    for (unsigned spins = 0;
+         tail.load(std::memory_order_acquire) - pos < length;
+         spins++) {
+        if (closed.load(std::memory_order_acquire)) {
+            // Make sure we did not miss data published right before close
+            if (tail.load(std::memory_order_acquire) - pos >= length)
+                break;
+            return false;
+        }
+        if (spins < spinLimit) {
+            cpuRelax();
+            continue;
+        }
+        // Announce that we are going to sleep and re-check the ring
+        // before blocking so that a concurrent push() either sees the
+        // flag or we see its data.
+        sleeping.store(1);
+        const uint32_t cur_seq = seq.load();
+        if (tail.load() - pos < length && !closed.load())
+            futexWait(&seq, cur_seq);
+        sleeping.store(0);
+    }
+
+    copyOut(pos, buf, length);
+    head.store(pos + length, std::memory_order_release);
+    return true;
+}
+
+void
+ShmIface::Ring::close()
+{
+    closed.store(1, std::memory_order_release);
+    seq.fetch_add(1);
+    futexWake(&seq);
+}
+
+uint64_t
+ShmIface::Segment::stride(uint64_t ring_size)
+{
+    return roundUp(sizeof(Ring) + ring_size, 4096);
+}
+
+ShmIface::ShmIface(string shm_name, uint64_t ring_size,
+                   unsigned dist_rank, unsigned dist_size,
+                   Tick sync_start, Tick sync_repeat,
+                   EventManager *em, bool is_switch, int num_nodes,
+                   bool adaptive_sync) :
+    DistIface(dist_rank, dist_size, sync_start, sync_repeat, em,
+              is_switch, num_nodes, adaptive_sync), shmName(shm_name),
+    ringSize(ring_size),
+    isSwitch(is_switch), seg(nullptr), segLength(0), txRing(nullptr),
+    rxRing(nullptr)
+{
+    fatal_if(!isPowerOf2(ringSize), "ShmIface: ring size (%d) must be a "
+             "power of two", ringSize);
+    // A ring must hold at least one full sized data packet and its header
+    fatal_if(ringSize < 64 * 1024, "ShmIface: ring size (%d) must be at "
+             "least 64kB", ringSize);
+}
+
+ShmIface::~ShmIface()
+{
+    // Let the peer's receiver thread know that we are gone. We keep the
+    // segment mapped because our own receiver thread may still be blocked
+    // on the incoming ring. The segment name is already unlinked so the
+    // memory is released when both processes exit.
+    if (txRing)
+        txRing->close();
+}
+
+string
+ShmIface::segmentName(unsigned node_rank, unsigned iface_id) const
+{
+    return csprintf("/%s.%u.%u", shmName, node_rank, iface_id);
+}
+
+void
+ShmIface::mapSegment(int fd, size_t length)
+{
+    void *addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd, 0);
+    panic_if(addr == MAP_FAILED, "mmap() failed: %s", strerror(errno));
+    ::close(fd);
+
+    seg = static_cast<Segment *>(addr);
+    segLength = length;
+}
+
+void
+ShmIface::createSegment()
+{
+    const string seg_name = segmentName(rank, distIfaceId);
+    int fd = shm_open(seg_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        // Most likely left behind by a crashed run
+        warn("ShmIface: removing stale shared memory segment %s", seg_name);
+        shm_unlink(seg_name.c_str());
+        fd = shm_open(seg_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    panic_if(fd < 0, "shm_open(%s) failed: %s", seg_name, strerror(errno));
+
+    const uint64_t stride = Segment::stride(ringSize);
+    panic_if(ftruncate(fd, 3 * stride) != 0, "ftruncate() failed: %s",
+             strerror(errno));
+    mapSegment(fd, 3 * stride);
+
+    seg->magic = segMagic;
+    seg->ringSize = ringSize;
+    seg->ringStride = stride;
+    seg->node.rank = rank;
+    seg->node.distIfaceId = distIfaceId;
+    seg->node.distIfaceNum = distIfaceNum;
+    seg->toSwitch()->init(ringSize);
+    seg->toNode()->init(ringSize);
+    txRing = seg->toSwitch();
+    rxRing = seg->toNode();
+    seg->state.store(Segment::NodeReady, std::memory_order_release);
+
+    DPRINTF(DistEthernet, "Segment %s created, waiting for ack "
+            "(distIfaceId:%d)\n", seg_name, distIfaceId);
+    while (seg->state.load(std::memory_order_acquire) != Segment::SwitchAck)
+        usleep(1000);
+
+    // Both ends have the segment mapped now so we do not need the seg_name any
+    // more. Removing it here also makes sure it does not outlive the run.
+    shm_unlink(seg_name.c_str());
+
+    assert(seg->ack.rank == rank);
+    inform("Link okay  (iface:%d -> switch iface:%d)", distIfaceId,
+           seg->ack.distIfaceId);
+}
+
+void
+ShmIface::attachSegment()
+{
+    // The switch pairs its links with the node links in (rank, iface id)
+    // order, just like the TCP transport does.
+    static unsigned cur_rank = 0;
+    static unsigned cur_id = 0;
+
+    const string seg_name = segmentName(cur_rank, cur_id);
+    DPRINTF(DistEthernet, "Waiting for segment %s\n", seg_name);
+
+    int fd;
+    while ((fd = shm_open(seg_name.c_str(), O_RDWR, 0)) < 0) {
+        panic_if(errno != ENOENT, "shm_open(%s) failed: %s", seg_name,
+                 strerror(errno));
+        usleep(1000);
+    }
+
+    // The node may not have sized the segment yet
+    struct stat st;
+    for (;;) {
+        panic_if(fstat(fd, &st) != 0, "fstat() failed: %s", strerror(errno));
+        if (st.st_size != 0)
+            break;
+        usleep(1000);
+    }
+    mapSegment(fd, st.st_size);
+
+    while (seg->state.load(std::memory_order_acquire) != Segment::NodeReady)
+        usleep(1000);
+    panic_if(seg->magic != segMagic, "Bad dist shared memory segment %s",
+             seg_name);
+    if (seg->ringSize != ringSize)
+        warn("ShmIface: ring size mismatch on %s (local:%d, node:%d)",
+             seg_name, ringSize, seg->ringSize);
+
+    NodeInfo ni = seg->node;
+    assert(ni.rank == cur_rank);
+    assert(ni.distIfaceId == cur_id);
+    inform("Link okay  (iface:%d -> (node:%d, iface:%d))",
+           distIfaceId, ni.rank, ni.distIfaceId);
+    if (ni.distIfaceId < ni.distIfaceNum - 1) {
+        cur_id++;
+    } else {
+        cur_rank++;
+        cur_id = 0;
+    }
+
+    txRing = seg->toNode();
+    rxRing = seg->toSwitch();
+
+    // send ack
+    seg->ack.rank = ni.rank;
+    seg->ack.distIfaceId = distIfaceId;
+    seg->ack.distIfaceNum = distIfaceNum;
+    seg->state.store(Segment::SwitchAck, std::memory_order_release);
+}
+
+void
+ShmIface::establishConnection()
+{
+    if (isSwitch)
+        attachSegment();
+    else
+        createSegment();
+    ringRegistry.push_back(txRing);
+}
+
+void
+ShmIface::sendPacket(const Header &header, const EthPacketPtr &packet)
+{
+    txRing->push(&header, sizeof(header), packet->data, packet->length);
+}
+
+void
+ShmIface::sendCmd(const Header &header)
+{
+    DPRINTF(DistEthernetCmd, "ShmIface::sendCmd() type: %d\n",
+            static_cast<int>(header.msgType));
+    // Global commands (i.e. sync request) are always sent by the master
+    // DistIface through all the links of this process.
+    for (auto r: ringRegistry)
+        r->push(&header, sizeof(header), nullptr, 0);
+}
+
+bool
+ShmIface::recvHeader(Header &header)
+{
+    bool ret = rxRing->pop(&header, sizeof(header));
+    DPRINTF(DistEthernetCmd, "ShmIface::recvHeader() type: %d ret: %d\n",
+            static_cast<int>(header.msgType), ret);
+    return ret;
+}
+
+void
+ShmIface::recvPacket(const Header &header, EthPacketPtr &packet)
+{
+    packet = make_shared<EthPacketData>(header.dataPacketLength);
+    bool ret = rxRing->pop(packet->data, header.dataPacketLength);
+    panic_if(!ret, "Error while reading shared memory ring");
+    packet->length = header.dataPacketLength;
+}
+
+void
+ShmIface::initTransport()
+{
+    // Same as for the TCP transport: global link ordering requires the
+    // number of dist interfaces per process which is only known at init.
+    establishConnection();
+}
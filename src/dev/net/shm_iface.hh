@@ -0,0 +1,210 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* @file
+ * Shared memory based interface class for dist-gem5 runs.
+ *
+ * For a high level description about dist-gem5 see comments in
+ * header file dist_iface.hh.
+ *
+ * This transport is a drop-in replacement for the TCP stream socket
+ * transport (tcp_iface.hh) when all the gem5 peers run on the same host.
+ * Every simulated link owns a POSIX shared memory segment holding two
+ * single producer/single consumer byte rings (one per direction). The
+ * message stream carried by the rings is exactly the same as the one
+ * carried by the TCP sockets (i.e. header packets optionally followed by
+ * a data packet) so the dist synchronisation protocol itself is unchanged.
+ *
+ * Sending a message is a plain memory copy into the ring. The receiver
+ * thread spins for a short while on the ring and then falls back to
+ * sleeping on a futex, so a quantum barrier costs no system calls as long
+ * as the peers arrive at the barrier close to each other.
+ */
+#ifndef __DEV_NET_SHM_IFACE_HH__
+#define __DEV_NET_SHM_IFACE_HH__
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "dev/net/dist_iface.hh"
+
+class EventManager;
+
+class ShmIface : public DistIface
+{
+  private:
+    /**
+     * Single producer/single consumer byte ring living in shared memory.
+     * The head is only written by the consumer and the tail is only
+     * written by the producer so no locks are needed. The data area
+     * follows the ring header directly and its size is a power of two.
+     */
+    struct Ring
+    {
+        /** Consumer position (bytes consumed since the start). */
+        alignas(64) std::atomic<uint64_t> head;
+        /** Producer position (bytes produced since the start). */
+        alignas(64) std::atomic<uint64_t> tail;
+        /** Futex word, bumped every time new data is published. */
+        alignas(64) std::atomic<uint32_t> seq;
+        /** Set by the consumer before it goes to sleep on seq. */
+        std::atomic<uint32_t> sleeping;
+        /** Set by the producer when it detaches from the link. */
+        std::atomic<uint32_t> closed;
+        /** Size of the data area in bytes. */
+        uint64_t capacity;
+
+        uint8_t *data() { return reinterpret_cast<uint8_t *>(this + 1); }
+
+        void init(uint64_t size);
+        /**
+         * Copy a message made of two parts into the ring and publish it
+         * with a single tail update.
+         */
+        void push(const void *buf0, unsigned len0,
+                  const void *buf1, unsigned len1);
+        /**
+         * Consume exactly length bytes from the ring, blocking until they
+         * are available.
+         * @return False if the producer closed the ring before the data
+         * arrived.
+         */
+        bool pop(void *buf, unsigned length);
+        /** Mark the ring closed and wake up a sleeping consumer. */
+        void close();
+
+      private:
+        void copyIn(uint64_t pos, const void *buf, unsigned length);
+        void copyOut(uint64_t pos, void *buf, unsigned length);
+        void wakeup();
+    };
+
+    /**
+     * Compute node info exchanged during the link setup. It is the same
+     * information the TCP transport sends in its first message.
+     */
+    struct NodeInfo
+    {
+        unsigned rank;
+        unsigned distIfaceId;
+        unsigned distIfaceNum;
+    };
+
+    /**
+     * Layout of the shared memory segment of a link. The node side creates
+     * the segment and the switch side attaches to it.
+     */
+    struct Segment
+    {
+        enum State : uint32_t { Created = 0, NodeReady, SwitchAck };
+
+        uint32_t magic;
+        std::atomic<uint32_t> state;
+        NodeInfo node;
+        NodeInfo ack;
+        uint64_t ringSize;
+        uint64_t ringStride;
+
+        Ring *toSwitch()
+        { return reinterpret_cast<Ring *>(
+                reinterpret_cast<uint8_t *>(this) + ringStride); }
+        Ring *toNode()
+        { return reinterpret_cast<Ring *>(
+                reinterpret_cast<uint8_t *>(this) + 2 * ringStride); }
+
+        static uint64_t stride(uint64_t ring_size);
+    };
+
+    static const uint32_t segMagic = 0x67356473; // "gd5s"
+
+    /** Prefix of the names of all the segments in this dist run. */
+    std::string shmName;
+    /** Size of the data area of each ring in bytes. */
+    uint64_t ringSize;
+
+    bool isSwitch;
+
+    /** The mapped segment of this link. */
+    Segment *seg;
+    size_t segLength;
+
+    /** Ring used for outgoing messages. */
+    Ring *txRing;
+    /** Ring used for incoming messages. */
+    Ring *rxRing;
+
+    /**
+     * Storage for all outgoing rings (global commands are sent through all
+     * of them).
+     */
+    static std::vector<Ring *> ringRegistry;
+
+  private:
+    std::string segmentName(unsigned node_rank, unsigned iface_id) const;
+    /** Node side: create and publish the segment, wait for the switch. */
+    void createSegment();
+    /** Switch side: attach to the next node segment and ack it. */
+    void attachSegment();
+    void mapSegment(int fd, size_t length);
+    void establishConnection();
+
+  protected:
+
+    void sendPacket(const Header &header,
+                    const EthPacketPtr &packet) override;
+
+    void sendCmd(const Header &header) override;
+
+    bool recvHeader(Header &header) override;
+
+    void recvPacket(const Header &header, EthPacketPtr &packet) override;
+
+    void initTransport() override;
+
+  public:
+    /**
+     * The ctor only records the link params, the segments are set up in
+     * initTransport() because the number of dist interfaces per process is
+     * unknown until the (simobject) init phase.
+     * @param shm_name Common prefix for the shared memory segment names of
+     * this dist run.
+     * @param ring_size Size of the data area of each ring in bytes.
+     * @param sync_start The tick for the first dist synchronisation.
+     * @param sync_repeat The frequency of dist synchronisation.
+     * @param em The EventManager object associated with the simulated
+     * Ethernet link.
+     * @param adaptive_sync Stretch the sync interval while no packet can be
+     * sent.
+     */
+    ShmIface(std::string shm_name, uint64_t ring_size,
+             unsigned dist_rank, unsigned dist_size,
+             Tick sync_start, Tick sync_repeat, EventManager *em,
+             bool is_switch, int num_nodes, bool adaptive_sync);
+
+    ~ShmIface() override;
+};
+
+#endif // __DEV_NET_SHM_IFACE_HH__
@@ -82,9 +82,10 @@ bool TCPIface::anyListening = false;
 TCPIface::TCPIface(string server_name, unsigned server_port,
                    unsigned dist_rank, unsigned dist_size,
                    Tick sync_start, Tick sync_repeat,
-                   EventManager *em, bool is_switch, int num_nodes) :
+                   EventManager *em, bool is_switch, int num_nodes,
+                   bool adaptive_sync) :
     DistIface(dist_rank, dist_size, sync_start, sync_repeat, em,
-              is_switch, num_nodes), serverName(server_name),
+              is_switch, num_nodes, adaptive_sync), serverName(server_name),
     serverPort(server_port), isSwitch(is_switch), listening(false)
 {
     if (is_switch && isMaster) {
@@ -144,11 +144,13 @@ class TCPIface : public DistIface
      * @param sync_repeat The frequency of dist synchronisation.
      * @param em The EventManager object associated with the simulated
      * Ethernet link.
+     * @param adaptive_sync Stretch the sync interval while no packet can be
+     * sent.
      */
     TCPIface(std::string server_name, unsigned server_port,
              unsigned dist_rank, unsigned dist_size,
              Tick sync_start, Tick sync_repeat, EventManager *em,
-             bool is_switch, int num_nodes);
+             bool is_switch, int num_nodes, bool adaptive_sync);
 
     ~TCPIface() override;
 };
@@ -34,10 +34,14 @@
 
 #include "dev/storage/disk_image.hh"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <fstream>
@@ -53,12 +57,36 @@
 
 using namespace std;
 
+std::streampos
+DiskImage::readSectors(uint8_t *data, std::streampos offset,
+                       unsigned count) const
+{
+    uint64_t sector = offset;
+    for (unsigned i = 0; i < count; ++i) {
+        if (read(data + i * SectorSize, sector + i) != SectorSize)
+            return i * SectorSize;
+    }
+    return count * SectorSize;
+}
+
+std::streampos
+DiskImage::writeSectors(const uint8_t *data, std::streampos offset,
+                        unsigned count)
+{
+    uint64_t sector = offset;
+    for (unsigned i = 0; i < count; ++i) {
+        if (write(data + i * SectorSize, sector + i) != SectorSize)
+            return i * SectorSize;
+    }
+    return count * SectorSize;
+}
+
 ////////////////////////////////////////////////////////////////////////
 //
 // Raw Disk image
 //
 RawDiskImage::RawDiskImage(const Params* p)
-    : DiskImage(p), disk_size(0)
+    : DiskImage(p), disk_size(0), mapping(NULL), mappingSize(0)
 { open(p->image_file, p->read_only); }
 
 RawDiskImage::~RawDiskImage()
@@ -83,6 +111,9 @@ RawDiskImage::open(const string &filename, bool rd_only)
         readonly = rd_only;
         file = filename;
 
+        if (map())
+            return;
+
         ios::openmode mode = ios::in | ios::binary;
         if (!readonly)
             mode |= ios::out;
@@ -92,9 +123,44 @@ RawDiskImage::open(const string &filename, bool rd_only)
     }
 }
 
+bool
+RawDiskImage::map()
+{
+    int fd = ::open(file.c_str(), readonly ? O_RDONLY : O_RDWR);
+    if (fd < 0)
+        panic("Error opening %s: %s", file, strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    int prot = PROT_READ | (readonly ? 0 : PROT_WRITE);
+    void *addr = mmap(NULL, st.st_size, prot, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        warn("Could not map disk image %s (%s), using file I/O instead",
+             file, strerror(errno));
+        return false;
+    }
+
+    mapping = (uint8_t *)addr;
+    mappingSize = st.st_size;
+    disk_size = mappingSize;
+    return true;
+}
+
 void
 RawDiskImage::close()
 {
+    if (mapping) {
+        if (!readonly)
+            msync(mapping, mappingSize, MS_SYNC);
+        munmap(mapping, mappingSize);
+        mapping = NULL;
+        mappingSize = 0;
+    }
     stream.close();
 }
 
@@ -117,6 +183,21 @@ RawDiskImage::read(uint8_t *data, std::streampos offset) const
     if (!initialized)
         panic("RawDiskImage not initialized");
 
+    if (mapping) {
+        // Reads past the end of the image are short, just like they are
+        // with file I/O
+        uint64_t pos = (uint64_t)offset * SectorSize;
+        uint64_t count = pos < mappingSize ?
+            min<uint64_t>(SectorSize, mappingSize - pos) : 0;
+        if (count)
+            memcpy(data, mapping + pos, count);
+
+        DPRINTF(DiskImageRead, "read: offset=%d\n", (uint64_t)offset);
+        DDUMP(DiskImageRead, data, count);
+
+        return count;
+    }
+
     if (!stream.is_open())
         panic("file not open!\n");
 
@@ -142,6 +223,18 @@ RawDiskImage::write(const uint8_t *data, std::streampos offset)
     if (readonly)
         panic("Cannot write to a read only disk image");
 
+    if (mapping) {
+        uint64_t pos = (uint64_t)offset * SectorSize;
+        if (pos + SectorSize > mappingSize)
+            panic("Write past the end of disk image %s", file);
+
+        DPRINTF(DiskImageWrite, "write: offset=%d\n", (uint64_t)offset);
+        DDUMP(DiskImageWrite, data, SectorSize);
+
+        memcpy(mapping + pos, data, SectorSize);
+        return SectorSize;
+    }
+
     if (!stream.is_open())
         panic("file not open!\n");
 
@@ -157,6 +250,55 @@ RawDiskImage::write(const uint8_t *data, std::streampos offset)
     return stream.tellp() - pos;
 }
 
+std::streampos
+RawDiskImage::readSectors(uint8_t *data, std::streampos offset,
+                          unsigned count) const
+{
+    if (!mapping)
+        return DiskImage::readSectors(data, offset, count);
+
+    if (!initialized)
+        panic("RawDiskImage not initialized");
+
+    uint64_t pos = (uint64_t)offset * SectorSize;
+    uint64_t length = pos < mappingSize ?
+        min<uint64_t>((uint64_t)count * SectorSize, mappingSize - pos) : 0;
+    if (length)
+        memcpy(data, mapping + pos, length);
+
+    DPRINTF(DiskImageRead, "read: offset=%d count=%d\n", (uint64_t)offset,
+            count);
+    DDUMP(DiskImageRead, data, length);
+
+    return length;
+}
+
+std::streampos
+RawDiskImage::writeSectors(const uint8_t *data, std::streampos offset,
+                           unsigned count)
+{
+    if (!mapping)
+        return DiskImage::writeSectors(data, offset, count);
+
+    if (!initialized)
+        panic("RawDiskImage not initialized");
+
+    if (readonly)
+        panic("Cannot write to a read only disk image");
+
+    uint64_t pos = (uint64_t)offset * SectorSize;
+    uint64_t length = (uint64_t)count * SectorSize;
+    if (pos + length > mappingSize)
+        panic("Write past the end of disk image %s", file);
+
+    DPRINTF(DiskImageWrite, "write: offset=%d count=%d\n",
+            (uint64_t)offset, count);
+    DDUMP(DiskImageWrite, data, length);
+
+    memcpy(mapping + pos, data, length);
+    return length;
+}
+
 RawDiskImage *
 RawDiskImageParams::create()
 {
@@ -167,7 +309,7 @@ RawDiskImageParams::create()
 //
 // Copy on Write Disk image
 //
-const uint32_t CowDiskImage::VersionMajor = 1;
+const uint32_t CowDiskImage::VersionMajor = 2;
 const uint32_t CowDiskImage::VersionMinor = 0;
 
 class CowDiskCallback : public Callback
@@ -180,8 +322,39 @@ class CowDiskCallback : public Callback
     void process() { image->save(); delete this; }
 };
 
+uint32_t
+CowDiskImage::SectorStore::alloc()
+{
+    if ((used >> ChunkShift) == chunks.size()) {
+        if (used + ChunkSectors > (1ULL << 32))
+            panic("Too many modified sectors in COW disk image");
+
+        // Reserve address space only, the host allocates pages on first
+        // touch so a partially used chunk costs little memory
+        void *chunk = mmap(NULL, ChunkSectors * sizeof(Sector),
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                           -1, 0);
+        if (chunk == MAP_FAILED)
+            panic("Could not allocate COW disk sector storage: %s",
+                  strerror(errno));
+        chunks.push_back((Sector *)chunk);
+    }
+
+    return used++;
+}
+
+void
+CowDiskImage::SectorStore::clear()
+{
+    for (auto chunk : chunks)
+        munmap(chunk, ChunkSectors * sizeof(Sector));
+    chunks.clear();
+    used = 0;
+}
+
 CowDiskImage::CowDiskImage(const Params *p)
-    : DiskImage(p), filename(p->image_file), child(p->child), table(NULL)
+    : DiskImage(p), filename(p->image_file), child(p->child)
 {
     if (filename.empty()) {
         initSectorTable(p->table_size);
@@ -199,13 +372,6 @@ CowDiskImage::CowDiskImage(const Params *p)
 
 CowDiskImage::~CowDiskImage()
 {
-    SectorTable::iterator i = table->begin();
-    SectorTable::iterator end = table->end();
-
-    while (i != end) {
-        delete (*i).second;
-        ++i;
-    }
 }
 
 void
@@ -218,6 +384,34 @@ CowDiskImage::notifyFork()
     }
 }
 
+CowDiskImage::Sector *
+CowDiskImage::findSector(uint64_t offset) const
+{
+    ExtentTable::const_iterator i = table.find(offset >> ExtentShift);
+    if (i == table.end())
+        return NULL;
+
+    unsigned idx = offset & (ExtentSectors - 1);
+    const Extent &extent = (*i).second;
+    if (!(extent.valid & (1ULL << idx)))
+        return NULL;
+
+    return store.get(extent.slot[idx]);
+}
+
+CowDiskImage::Sector *
+CowDiskImage::getSector(uint64_t offset)
+{
+    Extent &extent = table[offset >> ExtentShift];
+    unsigned idx = offset & (ExtentSectors - 1);
+    if (!(extent.valid & (1ULL << idx))) {
+        extent.slot[idx] = store.alloc();
+        extent.valid |= 1ULL << idx;
+    }
+
+    return store.get(extent.slot[idx]);
+}
+
 void
 SafeRead(ifstream &stream, void *data, int count)
 {
@@ -247,6 +441,21 @@ SafeReadSwap(ifstream &stream, T &data)
     data = letoh(data); //is this the proper byte order conversion?
 }
 
+void
+CowDiskImage::loadV1(ifstream &stream)
+{
+    uint64_t sector_count;
+    SafeReadSwap(stream, sector_count);
+
+    for (uint64_t i = 0; i < sector_count; i++) {
+        uint64_t offset;
+        SafeReadSwap(stream, offset);
+
+        assert(findSector(offset) == NULL);
+        SafeRead(stream, getSector(offset), sizeof(Sector));
+    }
+}
+
 bool
 CowDiskImage::open(const string &file)
 {
@@ -267,24 +476,42 @@ CowDiskImage::open(const string &file)
     SafeReadSwap(stream, major);
     SafeReadSwap(stream, minor);
 
-    if (major != VersionMajor && minor != VersionMinor)
+    if (major != VersionMajor && major != 1)
         panic("Could not open %s: invalid version %d.%d != %d.%d",
               file, major, minor, VersionMajor, VersionMinor);
 
-    uint64_t sector_count;
-    SafeReadSwap(stream, sector_count);
-    table = new SectorTable(sector_count);
-
+    clearSectorTable();
 
-    for (uint64_t i = 0; i < sector_count; i++) {
-        uint64_t offset;
-        SafeReadSwap(stream, offset);
-
-        Sector *sector = new Sector;
-        SafeRead(stream, sector, sizeof(Sector));
+    if (major == 1) {
+        loadV1(stream);
+        stream.close();
+        initialized = true;
+        return true;
+    }
 
-        assert(table->find(offset) == table->end());
-        (*table)[offset] = sector;
+    // Version 2 images store one record per extent: the extent index, the
+    // bitmap of the modified sectors, the bitmap of the modified sectors
+    // that are all zeros and the contents of the remaining sectors.
+    uint64_t extent_count;
+    SafeReadSwap(stream, extent_count);
+    table.reserve(extent_count);
+
+    for (uint64_t i = 0; i < extent_count; i++) {
+        uint64_t index, valid, zero;
+        SafeReadSwap(stream, index);
+        SafeReadSwap(stream, valid);
+        SafeReadSwap(stream, zero);
+
+        assert(table.find(index) == table.end());
+        assert((zero & ~valid) == 0);
+        for (unsigned idx = 0; idx < ExtentSectors; idx++) {
+            if (!(valid & (1ULL << idx)))
+                continue;
+            // Fresh sector storage is zero filled
+            Sector *sector = getSector((index << ExtentShift) + idx);
+            if (!(zero & (1ULL << idx)))
+                SafeRead(stream, sector, sizeof(Sector));
+        }
     }
 
     stream.close();
@@ -296,11 +523,19 @@ CowDiskImage::open(const string &file)
 void
 CowDiskImage::initSectorTable(int hash_size)
 {
-    table = new SectorTable(hash_size);
+    clearSectorTable();
+    table.reserve(hash_size / ExtentSectors);
 
     initialized = true;
 }
 
+void
+CowDiskImage::clearSectorTable()
+{
+    table.clear();
+    store.clear();
+}
+
 void
 SafeWrite(ofstream &stream, const void *data, int count)
 {
@@ -355,19 +590,32 @@ CowDiskImage::save(const string &file) const
 
     SafeWriteSwap(stream, (uint32_t)VersionMajor);
     SafeWriteSwap(stream, (uint32_t)VersionMinor);
-    SafeWriteSwap(stream, (uint64_t)table->size());
+    SafeWriteSwap(stream, (uint64_t)table.size());
+
+    static const Sector zero_sector = {};
 
-    uint64_t size = table->size();
-    SectorTable::iterator iter = table->begin();
-    SectorTable::iterator end = table->end();
+    for (const auto &entry : table) {
+        const Extent &extent = entry.second;
 
-    for (uint64_t i = 0; i < size; i++) {
-        if (iter == end)
-            panic("Incorrect Table Size during save of COW disk image");
+        // Sectors that were zeroed by the guest are only recorded in the
+        // extent header
+        uint64_t zero = 0;
+        for (unsigned idx = 0; idx < ExtentSectors; idx++) {
+            if ((extent.valid & (1ULL << idx)) &&
+                memcmp(store.get(extent.slot[idx]), &zero_sector,
+                       sizeof(Sector)) == 0)
+                zero |= 1ULL << idx;
+        }
 
-        SafeWriteSwap(stream, (uint64_t)(*iter).first);
-        SafeWrite(stream, (*iter).second->data, sizeof(Sector));
-        ++iter;
+        SafeWriteSwap(stream, (uint64_t)entry.first);
+        SafeWriteSwap(stream, extent.valid);
+        SafeWriteSwap(stream, zero);
+
+        for (unsigned idx = 0; idx < ExtentSectors; idx++) {
+            if ((extent.valid & ~zero) & (1ULL << idx))
+                SafeWrite(stream, store.get(extent.slot[idx])->data,
+                          sizeof(Sector));
+        }
     }
 
     stream.close();
@@ -376,12 +624,13 @@ CowDiskImage::save(const string &file) const
 void
 CowDiskImage::writeback()
 {
-    SectorTable::iterator i = table->begin();
-    SectorTable::iterator end = table->end();
-
-    while (i != end) {
-        child->write((*i).second->data, (*i).first);
-        ++i;
+    for (const auto &entry : table) {
+        const Extent &extent = entry.second;
+        for (unsigned idx = 0; idx < ExtentSectors; idx++) {
+            if (extent.valid & (1ULL << idx))
+                child->write(store.get(extent.slot[idx])->data,
+                             (entry.first << ExtentShift) + idx);
+        }
     }
 }
 
@@ -398,11 +647,11 @@ CowDiskImage::read(uint8_t *data, std::streampos offset) const
     if (offset > size())
         panic("access out of bounds");
 
-    SectorTable::const_iterator i = table->find(offset);
-    if (i == table->end())
+    const Sector *sector = findSector(offset);
+    if (sector == NULL)
         return child->read(data, offset);
     else {
-        memcpy(data, (*i).second->data, SectorSize);
+        memcpy(data, sector->data, SectorSize);
         DPRINTF(DiskImageRead, "read: offset=%d\n", (uint64_t)offset);
         DDUMP(DiskImageRead, data, SectorSize);
         return SectorSize;
@@ -418,14 +667,7 @@ CowDiskImage::write(const uint8_t *data, std::streampos offset)
     if (offset > size())
         panic("access out of bounds");
 
-    SectorTable::iterator i = table->find(offset);
-    if (i == table->end()) {
-        Sector *sector = new Sector;
-        memcpy(sector, data, SectorSize);
-        table->insert(make_pair(offset, sector));
-    } else {
-        memcpy((*i).second->data, data, SectorSize);
-    }
+    memcpy(getSector(offset)->data, data, SectorSize);
 
     DPRINTF(DiskImageWrite, "write: offset=%d\n", (uint64_t)offset);
     DDUMP(DiskImageWrite, data, SectorSize);
@@ -433,6 +675,64 @@ CowDiskImage::write(const uint8_t *data, std::streampos offset)
     return SectorSize;
 }
 
+std::streampos
+CowDiskImage::readSectors(uint8_t *data, std::streampos offset,
+                          unsigned count) const
+{
+    if (!initialized)
+        panic("CowDiskImage not initialized");
+
+    uint64_t first = offset;
+    if (first + count > (uint64_t)size())
+        panic("access out of bounds");
+
+    // Serve modified sectors from the table and hand runs of unmodified
+    // sectors to the child image in one request each
+    unsigned done = 0;
+    while (done < count) {
+        const Sector *sector = findSector(first + done);
+        if (sector) {
+            memcpy(data + done * SectorSize, sector->data, SectorSize);
+            ++done;
+            continue;
+        }
+
+        unsigned run = 1;
+        while (done + run < count && !findSector(first + done + run))
+            ++run;
+
+        std::streampos length = child->readSectors(data + done * SectorSize,
+                                                   first + done, run);
+        if (length != run * SectorSize)
+            return done * SectorSize + length;
+        done += run;
+    }
+
+    DPRINTF(DiskImageRead, "read: offset=%d count=%d\n", first, count);
+    return count * SectorSize;
+}
+
+std::streampos
+CowDiskImage::writeSectors(const uint8_t *data, std::streampos offset,
+                           unsigned count)
+{
+    if (!initialized)
+        panic("RawDiskImage not initialized");
+
+    uint64_t first = offset;
+    if (first + count > (uint64_t)size())
+        panic("access out of bounds");
+
+    for (unsigned i = 0; i < count; ++i)
+        memcpy(getSector(first + i)->data, data + i * SectorSize,
+               SectorSize);
+
+    DPRINTF(DiskImageWrite, "write: offset=%d count=%d\n", first, count);
+    DDUMP(DiskImageWrite, data, count * SectorSize);
+
+    return count * SectorSize;
+}
+
 void
 CowDiskImage::serialize(CheckpointOut &cp) const
 {
@@ -37,6 +37,7 @@
 
 #include <fstream>
 #include <unordered_map>
+#include <vector>
 
 #include "params/CowDiskImage.hh"
 #include "params/DiskImage.hh"
@@ -64,10 +65,32 @@ class DiskImage : public SimObject
                                 std::streampos offset) const = 0;
     virtual std::streampos write(const uint8_t *data,
                                  std::streampos offset) = 0;
+
+    /**
+     * Read a run of consecutive sectors. The default implementation
+     * reads one sector at a time, images that can serve a run in one
+     * go override it.
+     *
+     * @return Number of bytes read.
+     */
+    virtual std::streampos readSectors(uint8_t *data, std::streampos offset,
+                                       unsigned count) const;
+    /**
+     * Write a run of consecutive sectors.
+     *
+     * @return Number of bytes written.
+     */
+    virtual std::streampos writeSectors(const uint8_t *data,
+                                        std::streampos offset,
+                                        unsigned count);
 };
 
 /**
- * Specialization for accessing a raw disk image
+ * Specialization for accessing a raw disk image.
+ *
+ * The image file is memory mapped if possible so sector accesses are
+ * plain memory copies served by the host page cache. The stream based
+ * accessors are only used if the file cannot be mapped.
  */
 class RawDiskImage : public DiskImage
 {
@@ -77,6 +100,14 @@ class RawDiskImage : public DiskImage
     bool readonly;
     mutable std::streampos disk_size;
 
+    /** Start of the file mapping, NULL if the stream is used */
+    uint8_t *mapping;
+    /** Size of the file mapping in bytes */
+    size_t mappingSize;
+
+    /** Try to map the image file, returns false on failure */
+    bool map();
+
   public:
     typedef RawDiskImageParams Params;
     RawDiskImage(const Params *p);
@@ -91,6 +122,11 @@ class RawDiskImage : public DiskImage
 
     std::streampos read(uint8_t *data, std::streampos offset) const override;
     std::streampos write(const uint8_t *data, std::streampos offset) override;
+
+    std::streampos readSectors(uint8_t *data, std::streampos offset,
+                               unsigned count) const override;
+    std::streampos writeSectors(const uint8_t *data, std::streampos offset,
+                                unsigned count) override;
 };
 
 /**
@@ -113,12 +149,69 @@ class CowDiskImage : public DiskImage
     struct Sector {
         uint8_t data[SectorSize];
     };
-    typedef std::unordered_map<uint64_t, Sector *> SectorTable;
+
+    /**
+     * Modified sectors are indexed in two levels. The first level maps an
+     * extent (a naturally aligned group of ExtentSectors sectors) to its
+     * descriptor. The descriptor holds a bitmap of the modified sectors of
+     * the extent and the storage slot of each of them.
+     */
+    static const unsigned ExtentShift = 6;
+    static const unsigned ExtentSectors = 1 << ExtentShift;
+
+    struct Extent {
+        uint64_t valid;
+        uint32_t slot[ExtentSectors];
+
+        Extent() : valid(0) {}
+    };
+    typedef std::unordered_map<uint64_t, Extent> ExtentTable;
+
+    /**
+     * Storage for the modified sectors. Sectors are carved out of large
+     * anonymous memory mappings (chunks) so a modified sector costs no heap
+     * allocation and the sectors of an extent written in one go end up next
+     * to each other. Slots are never freed, freshly allocated slots are
+     * zero filled.
+     */
+    class SectorStore
+    {
+      private:
+        static const unsigned ChunkShift = 15;
+        static const unsigned ChunkSectors = 1 << ChunkShift;
+
+        std::vector<Sector *> chunks;
+        uint64_t used;
+
+      public:
+        SectorStore() : used(0) {}
+        ~SectorStore() { clear(); }
+
+        uint32_t alloc();
+        void clear();
+
+        Sector *
+        get(uint32_t slot) const
+        {
+            return chunks[slot >> ChunkShift] + (slot & (ChunkSectors - 1));
+        }
+
+        uint64_t size() const { return used; }
+    };
 
   protected:
     std::string filename;
     DiskImage *child;
-    SectorTable *table;
+    ExtentTable table;
+    SectorStore store;
+
+    /** Find a modified sector, returns NULL if it is not modified */
+    Sector *findSector(uint64_t offset) const;
+    /** Find a modified sector, allocate storage for it if needed */
+    Sector *getSector(uint64_t offset);
+
+    /** Load the legacy (version 1) per sector image format */
+    void loadV1(std::ifstream &stream);
 
   public:
     typedef CowDiskImageParams Params;
@@ -128,6 +221,7 @@ class CowDiskImage : public DiskImage
     void notifyFork() override;
 
     void initSectorTable(int hash_size);
+    void clearSectorTable();
     bool open(const std::string &file);
     void save() const;
     void save(const std::string &file) const;
@@ -140,6 +234,11 @@ class CowDiskImage : public DiskImage
 
     std::streampos read(uint8_t *data, std::streampos offset) const override;
     std::streampos write(const uint8_t *data, std::streampos offset) override;
+
+    std::streampos readSectors(uint8_t *data, std::streampos offset,
+                               unsigned count) const override;
+    std::streampos writeSectors(const uint8_t *data, std::streampos offset,
+                                unsigned count) override;
 };
 
 void SafeRead(std::ifstream &stream, void *data, int count);
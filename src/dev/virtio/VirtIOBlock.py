@@ -48,3 +48,7 @@ class VirtIOBlock(VirtIODeviceBase):
     queueSize = Param.Unsigned(128, "Output queue size (pages)")
 
     image = Param.DiskImage("Disk image")
+
+    latency = Param.Latency('0ns', "Fixed service time of a request")
+    bandwidth = Param.MemoryBandwidth('0GB/s', "Request data transfer "
+                                      "bandwidth (0 for no transfer time)")
@@ -37,6 +37,7 @@
  * Authors: Andreas Sandberg
  */
 
+#include "base/softerror.hh"
 #include "debug/VIO.hh"
 #include "dev/virtio/base.hh"
 #include "params/VirtIODeviceBase.hh"
@@ -148,6 +149,14 @@ VirtDescriptor::read(size_t offset, uint8_t *dst, size_t size) const
         panic("Trying to read from outgoing buffer\n");
 
     memProxy->readBlob(desc.addr + offset, dst, size);
+
+    // Descriptor transfers are the DMA of VirtIO devices
+    if (queue->injEnabled() &&
+        SoftError::dmaInjReady(desc.addr + offset, size)) {
+        const Addr addr = SoftError::injectDma("virtio", desc.addr + offset,
+                                               dst, size);
+        SoftError::dmaConsumed("virtio", addr);
+    }
 }
 
 void
@@ -159,6 +168,17 @@ VirtDescriptor::write(size_t offset, const uint8_t *src, size_t size)
     if (!isOutgoing())
         panic("Trying to write to incoming buffer\n");
 
+    if (queue->injEnabled() &&
+        SoftError::dmaInjReady(desc.addr + offset, size)) {
+        // Corrupt a copy, the source belongs to the device model
+        std::vector<uint8_t> data(src, src + size);
+        const Addr addr = SoftError::injectDma("virtio", desc.addr + offset,
+                                               data.data(), size);
+        memProxy->writeBlob(desc.addr + offset, data.data(), size);
+        SoftError::taintMem(addr, data[addr - desc.addr - offset]);
+        return;
+    }
+
     memProxy->writeBlob(desc.addr + offset, const_cast<uint8_t *>(src), size);
 }
 
@@ -223,7 +243,7 @@ VirtDescriptor::chainSize() const
 
 
 VirtQueue::VirtQueue(PortProxy &proxy, uint16_t size)
-    : _size(size), _address(0), memProxy(proxy),
+    : _size(size), _address(0), memProxy(proxy), _injEnabled(false),
       avail(proxy, size), used(proxy, size),
       _last_avail(0)
 {
@@ -284,6 +304,46 @@ VirtQueue::consumeDescriptor()
     return d;
 }
 
+void
+VirtQueue::consumeDescriptors(std::vector<VirtDescriptor *> &descs)
+{
+    avail.read();
+    DPRINTF(VIO, "consumeDescriptors: _last_avail: %i, avail.idx: %i\n",
+            _last_avail, avail.header.index);
+
+    while (_last_avail != avail.header.index) {
+        VirtDescriptor::Index index(
+            avail.ring[_last_avail % used.ring.size()]);
+        ++_last_avail;
+
+        VirtDescriptor *d(&descriptors[index]);
+        d->updateChain();
+        descs.push_back(d);
+    }
+}
+
+void
+VirtQueue::produceDescriptors(
+    const std::vector<std::pair<VirtDescriptor *, uint32_t>> &descs)
+{
+    if (descs.empty())
+        return;
+
+    used.readHeader();
+    for (const auto &d : descs) {
+        DPRINTF(VIO, "produceDescriptors: dscIdx: %i, len: %i, "
+                "used.idx: %i\n", d.first->index(), d.second,
+                used.header.index);
+
+        struct vring_used_elem &e(
+            used.ring[used.header.index % used.ring.size()]);
+        e.id = d.first->index();
+        e.len = d.second;
+        used.header.index += 1;
+    }
+    used.write();
+}
+
 void
 VirtQueue::produceDescriptor(VirtDescriptor *desc, uint32_t len)
 {
@@ -476,3 +536,10 @@ VirtIODeviceBase::registerQueue(VirtQueue &queue)
 {
     _queues.push_back(&queue);
 }
+
+void
+VirtIODeviceBase::enableInj()
+{
+    for (auto *queue : _queues)
+        queue->enableInj();
+}
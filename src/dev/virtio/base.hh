@@ -40,6 +40,9 @@
 #ifndef __DEV_VIRTIO_BASE_HH__
 #define __DEV_VIRTIO_BASE_HH__
 
+#include <utility>
+#include <vector>
+
 #include "arch/isa_traits.hh"
 #include "base/bitunion.hh"
 #include "base/callback.hh"
@@ -369,6 +372,16 @@ public:
      * descriptors are available.
      */
     VirtDescriptor *consumeDescriptor();
+    /**
+     * Get all pending incoming descriptor chains from the queue.
+     *
+     * This is equivalent to calling consumeDescriptor() until it
+     * returns NULL, but it only reads the available ring from guest
+     * memory once.
+     *
+     * @param descs Vector the descriptor chains are appended to.
+     */
+    void consumeDescriptors(std::vector<VirtDescriptor *> &descs);
     /**
      * Send a descriptor chain to the guest.
      *
@@ -388,6 +401,17 @@ public:
      * @param len Length of the produced data.
      */
     void produceDescriptor(VirtDescriptor *desc, uint32_t len);
+    /**
+     * Send a batch of descriptor chains to the guest.
+     *
+     * This is equivalent to calling produceDescriptor() for every
+     * chain in the batch, but it only writes the used ring to guest
+     * memory once.
+     *
+     * @param descs Pairs of descriptor chain start and produced length.
+     */
+    void produceDescriptors(
+        const std::vector<std::pair<VirtDescriptor *, uint32_t>> &descs);
     /** @} */
 
     /** @{
@@ -426,6 +450,12 @@ public:
     void dump() const;
     /** @} */
 
+    /** Make the descriptor transfers of this queue DMA fault injection
+     *  targets */
+    void enableInj() { _injEnabled = true; }
+    /** Are descriptor transfers of this queue injection targets? */
+    bool injEnabled() const { return _injEnabled; }
+
     /** @{ */
     /**
      * Page size used by VirtIO.\ It's hard-coded to 4096 bytes in
@@ -456,6 +486,8 @@ public:
     Addr _address;
     /** Guest physical memory proxy */
     PortProxy &memProxy;
+    /** Inject DMA faults into the descriptor transfers */
+    bool _injEnabled;
 
   private:
     /**
@@ -737,6 +769,14 @@ class VirtIODeviceBase : public SimObject
         transKick = c;
     }
 
+    /**
+     * Make the transfers of all queues DMA fault injection targets.
+     *
+     * Called by the transport, which owns the injection params, once
+     * the device model has registered its queues.
+     */
+    void enableInj();
+
 
     /**
      * Driver is requesting service.
@@ -45,7 +45,9 @@
 VirtIOBlock::VirtIOBlock(Params *params)
     : VirtIODeviceBase(params, ID_BLOCK, sizeof(Config), 0),
       qRequests(params->system->physProxy, params->queueSize, *this),
-      image(*params->image)
+      image(*params->image),
+      latency(params->latency), ticksPerByte(params->bandwidth),
+      busyUntil(0), completeEvent(this)
 {
     registerQueue(qRequests);
 
@@ -66,11 +68,16 @@ VirtIOBlock::readConfig(PacketPtr pkt, Addr cfgOffset)
     readConfigBlob(pkt, cfgOffset, (uint8_t *)&cfg_out);
 }
 
+DrainState
+VirtIOBlock::drain()
+{
+    return pending.empty() ? DrainState::Drained : DrainState::Draining;
+}
+
 VirtIOBlock::Status
 VirtIOBlock::read(const BlkRequest &req, VirtDescriptor *desc_chain,
                   size_t off_data, size_t size)
 {
-    uint8_t data[size];
     uint64_t sector(req.sector);
 
     DPRINTF(VIOBlock, "Read request starting @ sector %i (size: %i)\n",
@@ -79,15 +86,15 @@ VirtIOBlock::read(const BlkRequest &req, VirtDescriptor *desc_chain,
     if (size % SectorSize != 0)
         panic("Unexpected request/sector size relationship\n");
 
-    for (Addr offset = 0; offset < size; offset += SectorSize) {
-        if (image.read(data + offset, sector) != SectorSize) {
-            warn("Failed to read sector %i\n", sector);
-            return S_IOERR;
-        }
-        ++sector;
+    ioBuffer.resize(size);
+    if (image.readSectors(ioBuffer.data(), sector, size / SectorSize) !=
+        size) {
+        warn("Failed to read sectors %i-%i\n", sector,
+             sector + size / SectorSize - 1);
+        return S_IOERR;
     }
 
-    desc_chain->chainWrite(off_data, data, size);
+    desc_chain->chainWrite(off_data, ioBuffer.data(), size);
 
     return S_OK;
 }
@@ -96,7 +103,6 @@ VirtIOBlock::Status
 VirtIOBlock::write(const BlkRequest &req, VirtDescriptor *desc_chain,
                   size_t off_data, size_t size)
 {
-    uint8_t data[size];
     uint64_t sector(req.sector);
 
     DPRINTF(VIOBlock, "Write request starting @ sector %i (size: %i)\n",
@@ -105,15 +111,14 @@ VirtIOBlock::write(const BlkRequest &req, VirtDescriptor *desc_chain,
     if (size % SectorSize != 0)
         panic("Unexpected request/sector size relationship\n");
 
+    ioBuffer.resize(size);
+    desc_chain->chainRead(off_data, ioBuffer.data(), size);
 
-    desc_chain->chainRead(off_data, data, size);
-
-    for (Addr offset = 0; offset < size; offset += SectorSize) {
-        if (image.write(data + offset, sector) != SectorSize) {
-            warn("Failed to write sector %i\n", sector);
-            return S_IOERR;
-        }
-        ++sector;
+    if (image.writeSectors(ioBuffer.data(), sector, size / SectorSize) !=
+        size) {
+        warn("Failed to write sectors %i-%i\n", sector,
+             sector + size / SectorSize - 1);
+        return S_IOERR;
     }
 
     return S_OK;
@@ -121,7 +126,7 @@ VirtIOBlock::write(const BlkRequest &req, VirtDescriptor *desc_chain,
 }
 
 void
-VirtIOBlock::RequestQueue::onNotifyDescriptor(VirtDescriptor *desc)
+VirtIOBlock::serviceRequest(VirtDescriptor *desc)
 {
     DPRINTF(VIOBlock, "Got input data descriptor (len: %i)\n",
             desc->size());
@@ -140,11 +145,11 @@ VirtIOBlock::RequestQueue::onNotifyDescriptor(VirtDescriptor *desc)
 
     switch (req.type) {
       case T_IN:
-        status = parent.read(req, desc, sizeof(BlkRequest), data_size);
+        status = read(req, desc, sizeof(BlkRequest), data_size);
         break;
 
       case T_OUT:
-        status = parent.write(req, desc, sizeof(BlkRequest), data_size);
+        status = write(req, desc, sizeof(BlkRequest), data_size);
         break;
 
       case T_FLUSH:
@@ -160,9 +165,53 @@ VirtIOBlock::RequestQueue::onNotifyDescriptor(VirtDescriptor *desc)
     desc->chainWrite(sizeof(BlkRequest) + data_size,
                      &status, sizeof(status));
 
-    // Tell the guest that we are done with this descriptor.
-    produceDescriptor(desc, sizeof(BlkRequest) + data_size + sizeof(Status));
-    parent.kick();
+    // Requests are serviced in order, each one takes the fixed latency
+    // plus the time needed to transfer its data.
+    busyUntil = std::max(busyUntil, curTick()) + latency +
+        (Tick)(data_size * ticksPerByte);
+    pending.push_back(Completion{
+        busyUntil, desc,
+        (uint32_t)(sizeof(BlkRequest) + data_size + sizeof(Status))});
+}
+
+void
+VirtIOBlock::completeRequests()
+{
+    completed.clear();
+    while (!pending.empty() && pending.front().when <= curTick()) {
+        completed.emplace_back(pending.front().desc, pending.front().len);
+        pending.pop_front();
+    }
+
+    if (!completed.empty()) {
+        DPRINTF(VIOBlock, "Completing %i request(s)\n", completed.size());
+        // Tell the guest that we are done with these descriptors.
+        qRequests.produceDescriptors(completed);
+        kick();
+    }
+
+    if (!pending.empty()) {
+        if (!completeEvent.scheduled())
+            schedule(completeEvent, pending.front().when);
+    } else if (drainState() == DrainState::Draining) {
+        signalDrainDone();
+    }
+}
+
+void
+VirtIOBlock::RequestQueue::onNotify()
+{
+    batch.clear();
+    consumeDescriptors(batch);
+    DPRINTF(VIOBlock, "Got %i request(s)\n", batch.size());
+
+    for (VirtDescriptor *desc : batch)
+        parent.serviceRequest(desc);
+
+    // Requests without service time complete right away, the others are
+    // picked up by the completion event.
+    if (!parent.completeEvent.scheduled())
+        parent.completeRequests();
 }
 
 VirtIOBlock *
@@ -40,9 +40,14 @@
 #ifndef __DEV_VIRTIO_BLOCK_HH__
 #define __DEV_VIRTIO_BLOCK_HH__
 
+#include <deque>
+#include <utility>
+#include <vector>
+
 #include "dev/virtio/base.hh"
 #include "dev/storage/disk_image.hh"
 #include "dev/terminal.hh"
+#include "sim/eventq.hh"
 
 struct VirtIOBlockParams;
 
@@ -61,7 +66,13 @@ struct VirtIOBlockParams;
  *
  * The protocol supports asynchronous request completion by returning
  * descriptor chains when they have been populated by the backing
- * store. However, there is little point in doing so here.
+ * store. All the requests pending in the queue are handled in one batch
+ * when the guest notifies the device. The data is transferred to/from
+ * the disk image right away, while the completion of each request is
+ * delayed by a simple service time model (a fixed latency plus a
+ * bandwidth dependent transfer time, requests are serviced in order).
+ * Requests completing at the same tick are returned to the guest with a
+ * single used ring update and a single interrupt.
  *
  * @see https://github.com/rustyrussell/virtio-spec
  * @see http://docs.oasis-open.org/virtio/virtio/v1.0/virtio-v1.0.html
@@ -75,6 +86,8 @@ class VirtIOBlock : public VirtIODeviceBase
 
     void readConfig(PacketPtr pkt, Addr cfgOffset);
 
+    DrainState drain() override;
+
   protected:
     static const DeviceId ID_BLOCK = 0x02;
 
@@ -156,6 +169,20 @@ class VirtIOBlock : public VirtIODeviceBase
     Status write(const BlkRequest &req, VirtDescriptor *desc_chain,
                  size_t off_data, size_t size);
 
+    /**
+     * Handle a request and queue its completion according to the
+     * service time model.
+     *
+     * @param desc Start of the request descriptor chain.
+     */
+    void serviceRequest(VirtDescriptor *desc);
+
+    /**
+     * Return the requests whose service time has elapsed to the guest
+     * and schedule the next completion.
+     */
+    void completeRequests();
+
   protected:
     /**
      * Virtqueue for disk requests.
@@ -168,12 +195,15 @@ class VirtIOBlock : public VirtIODeviceBase
             : VirtQueue(proxy, size), parent(_parent) {}
         virtual ~RequestQueue() {}
 
-        void onNotifyDescriptor(VirtDescriptor *desc);
+        void onNotify() override;
 
         std::string name() const { return parent.name() + ".qRequests"; }
 
       protected:
         VirtIOBlock &parent;
+
+        /** Descriptor chains consumed in the current batch */
+        std::vector<VirtDescriptor *> batch;
     };
 
     /** Device I/O request queue */
@@ -181,6 +211,29 @@ class VirtIOBlock : public VirtIODeviceBase
 
     /** Image backing this device */
     DiskImage &image;
+
+    /** Fixed service time of a request */
+    const Tick latency;
+    /** Transfer time per byte (0 for infinitely fast transfers) */
+    const double ticksPerByte;
+    /** Tick when the last queued request completes */
+    Tick busyUntil;
+
+    /** A serviced request waiting for its completion tick */
+    struct Completion {
+        Tick when;
+        VirtDescriptor *desc;
+        uint32_t len;
+    };
+    /** Serviced requests in completion order */
+    std::deque<Completion> pending;
+    /** Requests returned to the guest by completeRequests() */
+    std::vector<std::pair<VirtDescriptor *, uint32_t>> completed;
+
+    EventWrapper<VirtIOBlock, &VirtIOBlock::completeRequests> completeEvent;
+
+    /** Bounce buffer for request data */
+    std::vector<uint8_t> ioBuffer;
 };
 
 #endif // __DEV_VIRTIO_BLOCK_HH__
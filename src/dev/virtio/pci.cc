@@ -51,6 +51,11 @@ PciVirtIO::PciVirtIO(const Params *params)
     BARSize[0] = BAR0_SIZE_BASE + vio.configSize;
 
     vio.registerKickCallback(&callbackKick);
+
+    // The device model moves its data through descriptors rather
+    // than the DMA port
+    if (params->injectFaultDma)
+        vio.enableInj();
 }
 
 PciVirtIO::~PciVirtIO()
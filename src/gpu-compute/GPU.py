@@ -136,6 +136,14 @@ class ComputeUnit(MemObject):
     vector_register_file = VectorParam.VectorRegisterFile("Vector register "\
                                                           "file")
 
+    # Fault injection into the GPU state of this CU
+    injectComp = Param.String('', "GPU state to inject a single-bit fault "\
+                              "into: vrf, lds or crf (none if empty)")
+    injectTime = Param.UInt64(0, "Time to inject fault")
+    injectLoc = Param.Unsigned(0, "Bit location to inject fault")
+    injectMaskedExit = Param.Bool(False, "Exit as soon as the fault is "\
+                                  "masked")
+
 class Shader(ClockedObject):
     type = 'Shader'
     cxx_class = 'Shader'
@@ -46,6 +46,7 @@
 #include "debug/GPUSync.hh"
 #include "debug/GPUTLB.hh"
 #include "gpu-compute/dispatcher.hh"
+#include "gpu-compute/gpu_fault_injector.hh"
 #include "gpu-compute/gpu_dyn_inst.hh"
 #include "gpu-compute/gpu_static_inst.hh"
 #include "gpu-compute/ndrange.hh"
@@ -153,6 +154,23 @@ ComputeUnit::ComputeUnit(const Params *p) : MemObject(p), fetchStage(p),
     }
 
     numVecRegsPerSimd = vrf[0]->numRegs();
+
+    if (!p->injectComp.empty()) {
+        SoftError::InjComp comp;
+        if (p->injectComp == "vrf") {
+            comp = SoftError::GPU_VRF;
+        } else if (p->injectComp == "lds") {
+            comp = SoftError::GPU_LDS;
+        } else if (p->injectComp == "crf") {
+            comp = SoftError::GPU_CRF;
+        } else {
+            fatal("Invalid GPU fault injection target %s (CU)\n",
+                  p->injectComp);
+        }
+        SoftError::registerGpuInj(p->injectTime, p->injectLoc, comp,
+                                  p->injectMaskedExit);
+        faultInjector = new GpuFaultInjector(this, comp);
+    }
 }
 
 ComputeUnit::~ComputeUnit()
@@ -171,6 +189,7 @@ ComputeUnit::~ComputeUnit()
     vectorAluInstAvail.clear();
     delete cuExitCallback;
     delete ldsPort;
+    delete faultInjector;
 }
 
 void
@@ -544,6 +563,9 @@ void
 ComputeUnit::exec()
 {
     updateEvents();
+    if (faultInjector) {
+        faultInjector->exec();
+    }
     // Execute pipeline stages in reverse order to simulate
     // the pipeline latency
     globalMemoryPipe.exec();
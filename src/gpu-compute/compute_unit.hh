@@ -58,6 +58,7 @@
 static const int MAX_REGS_FOR_NON_VEC_MEM_INST = 1;
 static const int MAX_WIDTH_FOR_MEM_INST = 32;
 
+class GpuFaultInjector;
 class NDRange;
 class Shader;
 class VectorRegisterFile;
@@ -137,6 +138,8 @@ class ComputeUnit : public MemObject
 
     // array of vector register files, one per SIMD
     std::vector<VectorRegisterFile*> vrf;
+    // fault injection into the VRF, LDS or condition registers, if any
+    GpuFaultInjector *faultInjector = nullptr;
     // Number of vector ALU units (SIMDs) in CU
     int numSIMDs;
     // number of pipe stages for bypassing data to next dependent single
@@ -73,6 +73,13 @@ class ConditionRegisterState
         c_reg[regIdx][threadId] = (bool)(value & 0x01);
     }
 
+    // Invert the value of a lane (fault injection)
+    void
+    flip(int regIdx, int threadId)
+    {
+        c_reg.at(regIdx).flip(threadId);
+    }
+
     void
     markReg(int regIdx, uint8_t value)
     {
@@ -0,0 +1,266 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gpu-compute/gpu_fault_injector.hh"
+
+#include "base/cprintf.hh"
+#include "base/trace.hh"
+#include "debug/FI.hh"
+#include "gpu-compute/compute_unit.hh"
+#include "gpu-compute/condition_register_state.hh"
+#include "gpu-compute/gpu_dyn_inst.hh"
+#include "gpu-compute/gpu_static_inst.hh"
+#include "gpu-compute/lds_state.hh"
+#include "gpu-compute/vector_register_file.hh"
+#include "gpu-compute/wavefront.hh"
+
+GpuFaultInjector::GpuFaultInjector(ComputeUnit *_computeUnit,
+                                   SoftError::InjComp _comp)
+    : computeUnit(_computeUnit),
+      _name(_computeUnit->name() + ".faultInjector"), comp(_comp),
+      owner(nullptr), ownerDynId(0), faultyReg(0), faultyLane(0)
+{
+}
+
+void
+GpuFaultInjector::exec()
+{
+    if (owner) {
+        // A fault in the registers of a finished wavefront can no longer
+        // be read
+        if (owner->status != Wavefront::S_RUNNING ||
+            owner->wfDynId != ownerDynId) {
+            stopTracking();
+            SoftError::faultMasked(csprintf("wave[%d] finished", ownerDynId));
+        }
+        return;
+    }
+
+    if (!SoftError::injReady() || SoftError::injComp != comp) {
+        return;
+    }
+    SoftError::injDone = true;
+
+    switch (comp) {
+      case SoftError::GPU_VRF:
+        injectVrf();
+        break;
+      case SoftError::GPU_LDS:
+        injectLds();
+        break;
+      case SoftError::GPU_CRF:
+        injectCrf();
+        break;
+      default:
+        panic("%s: not a GPU injection target\n", name());
+    }
+}
+
+Wavefront *
+GpuFaultInjector::vgprOwner(int simd, int reg) const
+{
+    const int num_regs = computeUnit->vrf[simd]->numRegs();
+
+    for (auto *w : computeUnit->wfList[simd]) {
+        if (w->status != Wavefront::S_RUNNING || !w->reservedVectorRegs) {
+            continue;
+        }
+        // The VGPRs of a wavefront may wrap around the end of the VRF
+        const int offset = (reg - (int)w->startVgprIndex + num_regs) %
+            num_regs;
+        if (offset < w->reservedVectorRegs) {
+            return w;
+        }
+    }
+
+    return nullptr;
+}
+
+void
+GpuFaultInjector::injectVrf()
+{
+    // Bit location: SIMD, physical 32-bit register, lane, bit
+    const int wf_size = computeUnit->wfSize();
+    const int num_regs = computeUnit->vrf[0]->numRegs();
+    const uint64_t reg_bits = (uint64_t)wf_size * 32;
+    const uint64_t simd_bits = reg_bits * num_regs;
+    uint64_t loc = SoftError::injLoc % (simd_bits * computeUnit->numSIMDs);
+
+    const int simd = loc / simd_bits;
+    loc %= simd_bits;
+    const int reg = loc / reg_bits;
+    const int lane = (loc / 32) % wf_size;
+    const int bit = loc % 32;
+
+    DPRINTF(FI, "Fault Injection into 'vrf' - Bit[%d] Flipped, CU%d "
+            "SIMD%d vreg[%d] lane %d\n", bit, computeUnit->cu_id, simd, reg,
+            lane);
+
+    Wavefront *w = vgprOwner(simd, reg);
+    if (!w) {
+        SoftError::faultMasked(csprintf("vreg[%d] not allocated", reg));
+        return;
+    }
+    if (!w->initMask[lane]) {
+        SoftError::faultMasked(csprintf("lane %d of wave[%d] inactive", lane,
+                                        w->wfDynId));
+        return;
+    }
+
+    // Double precision registers use two consecutive physical registers
+    // after the single precision ones of the wavefront
+    const int offset = (reg - (int)w->startVgprIndex + num_regs) % num_regs;
+    if (offset < (int)w->maxSpVgprs) {
+        computeUnit->vrf[simd]->flipBit<uint32_t>(reg, lane, bit);
+    } else {
+        const int half = (offset - w->maxSpVgprs) % 2;
+        computeUnit->vrf[simd]->flipBit<uint64_t>(
+            (reg - half + num_regs) % num_regs, lane, bit + 32 * half);
+    }
+
+    startTracking(w, reg, lane);
+}
+
+void
+GpuFaultInjector::injectLds()
+{
+    LdsState &lds = computeUnit->getLds();
+    const uint64_t loc = SoftError::injLoc %
+        ((uint64_t)lds.getMaximumSize() * 8);
+    const uint32_t offset = loc / 8;
+    const int bit = loc % 8;
+
+    DPRINTF(FI, "Fault Injection into 'lds' - Bit[%d] Flipped, CU%d LDS "
+            "byte %d\n", bit, computeUnit->cu_id, offset);
+
+    uint32_t index;
+    LdsChunk *chunk = lds.findChunk(offset, index);
+    if (!chunk) {
+        SoftError::faultMasked(csprintf("LDS byte %d not allocated", offset));
+        return;
+    }
+
+    // The chunk tracks the byte from now on
+    chunk->corrupt(index, bit);
+}
+
+void
+GpuFaultInjector::injectCrf()
+{
+    // Bit location: wavefront slot, lane, condition register. Each
+    // wavefront only has the condition registers its kernel uses.
+    const int wf_size = computeUnit->wfSize();
+    const int n_wf = computeUnit->wfList[0].size();
+    uint64_t loc = SoftError::injLoc;
+
+    const int slot = loc % (n_wf * computeUnit->numSIMDs);
+    loc /= n_wf * computeUnit->numSIMDs;
+    const int lane = loc % wf_size;
+    loc /= wf_size;
+
+    Wavefront *w = computeUnit->wfList[slot / n_wf][slot % n_wf];
+    const int num_cregs = w->condRegState->numRegs();
+    const int reg = num_cregs ? loc % num_cregs : 0;
+
+    DPRINTF(FI, "Fault Injection into 'crf' - Lane[%d] Flipped, CU%d "
+            "WF[%d][%d] creg[%d]\n", lane, computeUnit->cu_id, w->simdId,
+            w->wfSlotId, reg);
+
+    if (w->status != Wavefront::S_RUNNING || !num_cregs) {
+        SoftError::faultMasked(csprintf("WF[%d][%d] has no condition "
+                                        "registers", w->simdId,
+                                        w->wfSlotId));
+        return;
+    }
+    if (!w->initMask[lane]) {
+        SoftError::faultMasked(csprintf("lane %d of wave[%d] inactive", lane,
+                                        w->wfDynId));
+        return;
+    }
+
+    w->condRegState->flip(reg, lane);
+    startTracking(w, reg, lane);
+}
+
+void
+GpuFaultInjector::startTracking(Wavefront *w, int reg, int lane)
+{
+    owner = w;
+    ownerDynId = w->wfDynId;
+    faultyReg = reg;
+    faultyLane = lane;
+}
+
+void
+GpuFaultInjector::track(GPUDynInstPtr ii, Wavefront *w)
+{
+    if (w != owner || w->wfDynId != ownerDynId) {
+        return;
+    }
+
+    // The instruction neither reads nor writes the lanes it does not
+    // execute for
+    if (!w->getPred()[faultyLane]) {
+        return;
+    }
+
+    const int num_regs = computeUnit->vrf[w->simdId]->numRegs();
+    bool overwritten = false;
+
+    for (int i = 0; i < ii->getNumOperands(); ++i) {
+        bool hit;
+        if (comp == SoftError::GPU_VRF) {
+            if (!ii->isVectorRegister(i)) {
+                continue;
+            }
+            const int size = ii->getOperandSize(i);
+            const int reg = w->remap(ii->getRegisterIndex(i), size, 1);
+            hit = reg == faultyReg ||
+                (size > 4 && (reg + 1) % num_regs == faultyReg);
+        } else {
+            hit = ii->staticInstruction()->isCondRegister(i) &&
+                ii->getRegisterIndex(i) == faultyReg;
+        }
+
+        if (!hit) {
+            continue;
+        }
+        if (ii->isSrcOperand(i)) {
+            stopTracking();
+            SoftError::gpuConsumed(csprintf("%s (wave[%d] seq %d)",
+                                            ii->disassemble(), w->wfDynId,
+                                            ii->seqNum()));
+            return;
+        }
+        overwritten = overwritten || ii->isDstOperand(i);
+    }
+
+    if (overwritten) {
+        stopTracking();
+        SoftError::faultMasked(csprintf("overwritten by %s (wave[%d] seq "
+                                        "%d)", ii->disassemble(),
+                                        w->wfDynId, ii->seqNum()));
+    }
+}
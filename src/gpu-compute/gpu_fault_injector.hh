@@ -0,0 +1,88 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __GPU_FAULT_INJECTOR_HH__
+#define __GPU_FAULT_INJECTOR_HH__
+
+#include <cstdint>
+#include <string>
+
+#include "base/softerror.hh"
+#include "gpu-compute/misc.hh"
+
+class ComputeUnit;
+class Wavefront;
+
+/**
+ * Single-bit fault injection into the GPU state of a compute unit: the
+ * vector register files of its SIMDs (GPU_VRF), its local data share
+ * (GPU_LDS) and the condition registers of its wavefronts (GPU_CRF).
+ *
+ * The injection time and bit location are registered with SoftError like
+ * the CPU targets. A fault hitting state that no running work-item owns
+ * (an unallocated register, an inactive lane, a free part of the LDS) is
+ * reported as masked right away. Otherwise the corrupted register is
+ * followed through the instructions of its wavefront until it is either
+ * read (consumed) or overwritten (masked); LDS bytes are tracked by their
+ * LdsChunk.
+ */
+class GpuFaultInjector
+{
+  public:
+    GpuFaultInjector(ComputeUnit *_computeUnit, SoftError::InjComp _comp);
+
+    /** Inject the fault when it is time to, called every CU cycle */
+    void exec();
+
+    /** Check an instruction about to execute against the faulty register */
+    void track(GPUDynInstPtr ii, Wavefront *w);
+
+    const std::string &name() const { return _name; }
+
+  private:
+    void injectVrf();
+    void injectLds();
+    void injectCrf();
+
+    /** The wavefront owning physical VGPR reg of a SIMD, if any */
+    Wavefront *vgprOwner(int simd, int reg) const;
+
+    void startTracking(Wavefront *w, int reg, int lane);
+    void stopTracking() { owner = nullptr; }
+
+    ComputeUnit *computeUnit;
+    std::string _name;
+    SoftError::InjComp comp;
+
+    /** Wavefront reading the corrupted register, none if not tracking */
+    Wavefront *owner;
+    /** Dynamic id of the owner, slots get reused by later wavefronts */
+    uint64_t ownerDynId;
+    /** Physical VGPR or condition register holding the fault */
+    int faultyReg;
+    int faultyLane;
+};
+
+#endif // __GPU_FAULT_INJECTOR_HH__
@@ -35,10 +35,12 @@
 
 #include "gpu-compute/lds_state.hh"
 
+#include <algorithm>
 #include <array>
 #include <cstdio>
 #include <cstdlib>
 
+#include "base/cprintf.hh"
 #include "gpu-compute/compute_unit.hh"
 #include "gpu-compute/gpu_dyn_inst.hh"
 #include "gpu-compute/shader.hh"
@@ -331,3 +333,57 @@ LdsState::TickEvent::process()
 {
     ldsState->process();
 }
+
+void
+LdsChunk::corrupt(const uint32_t index, const int bit)
+{
+    fatal_if(index >= chunk.size(), "out-of-bounds access to an LDS chunk");
+    chunk[index] = BITFLIP(chunk[index], bit);
+    corruptedByte = index;
+}
+
+void
+LdsChunk::trackAccess(const uint32_t index, const uint32_t size,
+                      const bool isRead)
+{
+    if (corruptedByte < index || corruptedByte >= index + size) {
+        return;
+    }
+
+    corruptedByte = -1;
+    if (isRead) {
+        SoftError::gpuConsumed(csprintf("LDS read of [%d, %d)", index,
+                                        index + size));
+    } else {
+        SoftError::faultMasked(csprintf("LDS byte %d overwritten", index));
+    }
+}
+
+LdsChunk *
+LdsState::findChunk(uint32_t offset, uint32_t &index)
+{
+    typedef std::pair<std::pair<uint32_t, uint32_t>, LdsChunk*> Entry;
+    std::vector<Entry> chunks;
+
+    for (auto &dispatch : chunkMap) {
+        for (auto &workgroup : dispatch.second) {
+            chunks.emplace_back(std::make_pair(dispatch.first,
+                                               workgroup.first),
+                                &workgroup.second);
+        }
+    }
+
+    std::sort(chunks.begin(), chunks.end(),
+              [](const Entry &a, const Entry &b)
+              { return a.first < b.first; });
+
+    for (auto &entry : chunks) {
+        if (offset < entry.second->size()) {
+            index = offset;
+            return entry.second;
+        }
+        offset -= entry.second->size();
+    }
+
+    return nullptr;
+}
@@ -43,6 +43,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/softerror.hh"
 #include "enums/MemOpType.hh"
 #include "enums/MemType.hh"
 #include "gpu-compute/misc.hh"
@@ -75,6 +76,9 @@ class LdsChunk
     {
         fatal_if(!chunk.size(), "cannot read from an LDS chunk of size 0");
         fatal_if(index >= chunk.size(), "out-of-bounds access to an LDS chunk");
+        if (corruptedByte >= 0) {
+            trackAccess(index, sizeof(T), true);
+        }
         T *p0 = (T *) (&(chunk.at(index)));
         return *p0;
     }
@@ -88,6 +92,9 @@ class LdsChunk
     {
         fatal_if(!chunk.size(), "cannot write to an LDS chunk of size 0");
         fatal_if(index >= chunk.size(), "out-of-bounds access to an LDS chunk");
+        if (corruptedByte >= 0) {
+            trackAccess(index, sizeof(T), false);
+        }
         T *p0 = (T *) (&(chunk.at(index)));
         *p0 = value;
     }
@@ -101,9 +108,30 @@ class LdsChunk
         return chunk.size();
     }
 
+    /**
+     * flip a bit of a byte of this chunk (fault injection) and track the
+     * corrupted byte until it is either read or overwritten
+     */
+    void corrupt(const uint32_t index, const int bit);
+
+    /**
+     * does this chunk hold a corrupted byte nobody has read yet?
+     */
+    bool
+    corrupted() const
+    {
+        return corruptedByte >= 0;
+    }
+
   protected:
+    void trackAccess(const uint32_t index, const uint32_t size,
+                     const bool isRead);
+
     // the actual data store for this slice of the LDS
     std::vector<uint8_t> chunk;
+
+    // the index of the corrupted byte, -1 if there is none
+    int64_t corruptedByte = -1;
 };
 
 // Local Data Share (LDS) State per Wavefront (contents of the LDS region
@@ -436,6 +464,19 @@ class LdsState: public MemObject
         return range;
     }
 
+    int
+    getMaximumSize() const
+    {
+        return maximumSize;
+    }
+
+    /**
+     * find the chunk holding the byte at offset of the allocated part of
+     * the LDS, with the chunks laid out in (dispatch, workgroup) order.
+     * returns nullptr if the byte is not allocated to any workgroup
+     */
+    LdsChunk *findChunk(uint32_t offset, uint32_t &index);
+
     virtual BaseSlavePort &
     getSlavePort(const std::string& if_name, PortID idx)
     {
@@ -479,6 +520,10 @@ class LdsState: public MemObject
                  "releasing more space than was allocated");
 
         bytesAllocated -= chunkMap[x_dispatchId][x_wgId].size();
+        if (chunkMap[x_dispatchId][x_wgId].corrupted()) {
+            // nobody can read the corrupted byte anymore
+            SoftError::faultMasked("LDS chunk released");
+        }
         chunkMap[x_dispatchId].erase(chunkMap[x_dispatchId].find(x_wgId));
         return true;
     }
@@ -45,6 +45,8 @@
 class GPUDynInst;
 
 typedef std::bitset<std::numeric_limits<unsigned long long>::digits> VectorMask;
+// Maximum number of lanes in a wavefront, as bounded by VectorMask
+const int MaxWfSize = std::numeric_limits<unsigned long long>::digits;
 typedef std::shared_ptr<GPUDynInst> GPUDynInstPtr;
 
 class WaitClass
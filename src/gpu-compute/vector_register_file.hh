@@ -36,6 +36,7 @@
 #ifndef __VECTOR_REGISTER_FILE_HH__
 #define __VECTOR_REGISTER_FILE_HH__
 
+#include <cstring>
 #include <list>
 
 #include "base/statistics.hh"
@@ -86,6 +87,39 @@ class VectorRegisterFile : public SimObject
         vgprState->write<T>(regIdx, value, threadId);
     }
 
+    // Read all lanes of a register at once
+    template<typename T>
+    void
+    readLanes(int regIdx, T *values)
+    {
+        std::memcpy(values, vgprState->lanes<T>(regIdx),
+                    vgprState->wfSize() * sizeof(T));
+    }
+
+    // Write the lanes of a register that are set in mask at once
+    template<typename T>
+    void
+    writeLanes(int regIdx, const T *values, const VectorMask &mask)
+    {
+        if (DTRACE(GPUVRF)) {
+            for (int lane = 0; lane < vgprState->wfSize(); ++lane) {
+                if (mask[lane]) {
+                    DPRINTF(GPUVRF, "writing vreg[%d][%d] = %u\n", regIdx,
+                            lane, (uint64_t)values[lane]);
+                }
+            }
+        }
+        vgprState->writeLanes<T>(regIdx, values, mask);
+    }
+
+    // Flip a bit of a lane of a register (fault injection)
+    template<typename T>
+    void
+    flipBit(int regIdx, int threadId, int bit)
+    {
+        vgprState->lanes<T>(regIdx)[threadId] ^= (T)1 << bit;
+    }
+
     uint8_t regBusy(int idx, uint32_t operandSize) const;
     uint8_t regNxtBusy(int idx, uint32_t operandSize) const;
 
@@ -35,11 +35,93 @@
 
 #include "gpu-compute/vector_register_state.hh"
 
+#include <cstring>
 #include <limits>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "gpu-compute/compute_unit.hh"
 
-VecRegisterState::VecRegisterState() : computeUnit(nullptr)
+void
+maskedLaneCopy(uint32_t *dst, const uint32_t *src, uint64_t mask,
+               int num_lanes)
+{
+    const uint64_t all = num_lanes < 64 ? (1ULL << num_lanes) - 1 : ~0ULL;
+    mask &= all;
+
+    if (mask == all) {
+        std::memcpy(dst, src, num_lanes * sizeof(uint32_t));
+        return;
+    }
+
+    int lane = 0;
+#if defined(__AVX2__)
+    const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    for (; lane + 8 <= num_lanes; lane += 8) {
+        const int bits = (mask >> lane) & 0xff;
+        if (!bits)
+            continue;
+        const __m256i sel = _mm256_cmpeq_epi32(
+            _mm256_and_si256(_mm256_set1_epi32(bits), lane_bits), lane_bits);
+        _mm256_maskstore_epi32((int *)(dst + lane), sel,
+            _mm256_loadu_si256((const __m256i *)(src + lane)));
+    }
+#elif defined(__SSE2__)
+    const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+    for (; lane + 4 <= num_lanes; lane += 4) {
+        const int bits = (mask >> lane) & 0xf;
+        if (!bits)
+            continue;
+        const __m128i sel = _mm_cmpeq_epi32(
+            _mm_and_si128(_mm_set1_epi32(bits), lane_bits), lane_bits);
+        const __m128i old_val = _mm_loadu_si128((const __m128i *)(dst + lane));
+        const __m128i new_val = _mm_loadu_si128((const __m128i *)(src + lane));
+        _mm_storeu_si128((__m128i *)(dst + lane),
+                         _mm_or_si128(_mm_and_si128(sel, new_val),
+                                      _mm_andnot_si128(sel, old_val)));
+    }
+#endif
+    for (; lane < num_lanes; ++lane) {
+        if (mask & (1ULL << lane))
+            dst[lane] = src[lane];
+    }
+}
+
+void
+maskedLaneCopy(uint64_t *dst, const uint64_t *src, uint64_t mask,
+               int num_lanes)
+{
+    const uint64_t all = num_lanes < 64 ? (1ULL << num_lanes) - 1 : ~0ULL;
+    mask &= all;
+
+    if (mask == all) {
+        std::memcpy(dst, src, num_lanes * sizeof(uint64_t));
+        return;
+    }
+
+    int lane = 0;
+#if defined(__AVX2__)
+    const __m256i lane_bits = _mm256_setr_epi64x(1, 2, 4, 8);
+    for (; lane + 4 <= num_lanes; lane += 4) {
+        const long long bits = (mask >> lane) & 0xf;
+        if (!bits)
+            continue;
+        const __m256i sel = _mm256_cmpeq_epi64(
+            _mm256_and_si256(_mm256_set1_epi64x(bits), lane_bits), lane_bits);
+        _mm256_maskstore_epi64((long long *)(dst + lane), sel,
+            _mm256_loadu_si256((const __m256i *)(src + lane)));
+    }
+#endif
+    for (; lane < num_lanes; ++lane) {
+        if (mask & (1ULL << lane))
+            dst[lane] = src[lane];
+    }
+}
+
+VecRegisterState::VecRegisterState()
+    : computeUnit(nullptr), numRegs(0), wavefrontSize(0)
 {
     s_reg.clear();
     d_reg.clear();
@@ -55,17 +137,13 @@ VecRegisterState::setParent(ComputeUnit *_computeUnit)
 void
 VecRegisterState::init(uint32_t _size, uint32_t wf_size)
 {
-    s_reg.resize(_size);
     fatal_if(wf_size > std::numeric_limits<unsigned long long>::digits ||
              wf_size <= 0,
              "WF size is larger than the host can support or is zero");
     fatal_if((wf_size & (wf_size - 1)) != 0,
              "Wavefront size should be a power of 2");
-    for (int i = 0; i < s_reg.size(); ++i) {
-        s_reg[i].resize(wf_size, 0);
-    }
-    d_reg.resize(_size);
-    for (int i = 0; i < d_reg.size(); ++i) {
-        d_reg[i].resize(wf_size, 0);
-    }
+    numRegs = _size;
+    wavefrontSize = wf_size;
+    s_reg.assign(_size * wf_size, 0);
+    d_reg.assign(_size * wf_size, 0);
 }
@@ -36,8 +36,8 @@
 #ifndef __VECTOR_REGISTER_STATE_HH__
 #define __VECTOR_REGISTER_STATE_HH__
 
-#include <array>
 #include <cassert>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -45,8 +45,18 @@
 
 class ComputeUnit;
 
+// Copy the lanes of src selected by mask to dst. These are the kernels
+// used for whole-register writes; they use SIMD instructions when the
+// host supports them.
+void maskedLaneCopy(uint32_t *dst, const uint32_t *src, uint64_t mask,
+                    int num_lanes);
+void maskedLaneCopy(uint64_t *dst, const uint64_t *src, uint64_t mask,
+                    int num_lanes);
+
 // Vector Register State per SIMD unit (contents of the vector
-// registers in the VRF of the SIMD)
+// registers in the VRF of the SIMD). The lanes of each register are
+// stored contiguously, so that a whole register can be read or written
+// at once rather than lane by lane.
 class VecRegisterState
 {
   public:
@@ -61,41 +71,57 @@ class VecRegisterState
     template<typename T>
     T
     read(int regIdx, int threadId=0) {
-        T *p0;
+        return lanes<T>(regIdx)[threadId];
+    }
+
+    template<typename T>
+    void
+    write(unsigned int regIdx, T value, int threadId=0) {
+        lanes<T>(regIdx)[threadId] = value;
+    }
+
+    // Pointer to the first of the wfSize() lanes of a register
+    template<typename T>
+    T*
+    lanes(int regIdx) {
         assert(sizeof(T) == 4 || sizeof(T) == 8);
         if (sizeof(T) == 4) {
-            p0 = (T*)(&s_reg[regIdx][threadId]);
+            return (T*)(&s_reg[regIdx * wavefrontSize]);
         } else {
-            p0 = (T*)(&d_reg[regIdx][threadId]);
+            return (T*)(&d_reg[regIdx * wavefrontSize]);
         }
-
-        return *p0;
     }
 
+    // Write the lanes of a register that are set in mask
     template<typename T>
     void
-    write(unsigned int regIdx, T value, int threadId=0) {
-        T *p0;
+    writeLanes(int regIdx, const T *values, const VectorMask &mask) {
         assert(sizeof(T) == 4 || sizeof(T) == 8);
         if (sizeof(T) == 4) {
-            p0 = (T*)(&s_reg[regIdx][threadId]);
+            maskedLaneCopy((uint32_t*)lanes<T>(regIdx),
+                           (const uint32_t*)values, mask.to_ullong(),
+                           wavefrontSize);
         } else {
-            p0 = (T*)(&d_reg[regIdx][threadId]);
+            maskedLaneCopy((uint64_t*)lanes<T>(regIdx),
+                           (const uint64_t*)values, mask.to_ullong(),
+                           wavefrontSize);
         }
-
-        *p0 = value;
     }
 
     // (Single Precision) Vector Register File size.
-    int regSize() { return s_reg.size(); }
+    int regSize() { return numRegs; }
+
+    int wfSize() const { return wavefrontSize; }
 
   private:
     ComputeUnit *computeUnit;
     std::string _name;
-    // 32-bit Single Precision Vector Register State
-    std::vector<std::vector<uint32_t>> s_reg;
-    // 64-bit Double Precision Vector Register State
-    std::vector<std::vector<uint64_t>> d_reg;
+    int numRegs;
+    int wavefrontSize;
+    // 32-bit Single Precision Vector Register State, register-major
+    std::vector<uint32_t> s_reg;
+    // 64-bit Double Precision Vector Register State, register-major
+    std::vector<uint64_t> d_reg;
 };
 
 #endif // __VECTOR_REGISTER_STATE_HH__
@@ -40,6 +40,7 @@
 #include "gpu-compute/code_enums.hh"
 #include "gpu-compute/compute_unit.hh"
 #include "gpu-compute/gpu_dyn_inst.hh"
+#include "gpu-compute/gpu_fault_injector.hh"
 #include "gpu-compute/shader.hh"
 #include "gpu-compute/vector_register_file.hh"
 
@@ -751,6 +752,9 @@ Wavefront::exec()
     DPRINTF(GPUExec, "CU%d: WF[%d][%d]: wave[%d] Executing inst: %s "
             "(pc: %i)\n", computeUnit->cu_id, simdId, wfSlotId, wfDynId,
             ii->disassemble(), old_pc);
+    if (computeUnit->faultInjector) {
+        computeUnit->faultInjector->track(ii, this);
+    }
     ii->execute();
     // access the VRF
     computeUnit->vrf[simdId]->exec(ii, this);
@@ -44,6 +44,9 @@ class MemChecker(SimObject):
     type = 'MemChecker'
     cxx_header = "mem/mem_checker.hh"
 
+    gc_interval = Param.Unsigned(65536, "Number of finished transactions " \
+        "between sweeps releasing idle tracker storage (0 to disable)")
+
 class MemCheckerMonitor(MemObject):
     type = 'MemCheckerMonitor'
     cxx_header = "mem/mem_checker_monitor.hh"
@@ -44,6 +44,7 @@
 
 #include <vector>
 
+#include "base/softerror.hh"
 #include "cpu/base.hh"
 #include "cpu/thread_context.hh"
 #include "debug/LLSC.hh"
@@ -342,6 +343,14 @@ AbstractMemory::access(PacketPtr pkt)
 
     uint8_t *hostAddr = pmemAddr + pkt->getAddr() - range.start();
 
+    if (SoftError::memTainted) {
+        if (pkt->isRead())
+            SoftError::trackMemAccess(pkt->getAddr(), pkt->getSize(), NULL);
+        else if (pkt->isWrite() && !pkt->isInvalidate())
+            SoftError::trackMemAccess(pkt->getAddr(), pkt->getSize(),
+                                      pkt->getConstPtr<uint8_t>());
+    }
+
     if (pkt->cmd == MemCmd::SwapReq) {
         if (pkt->isAtomicOp()) {
             if (pmemAddr) {
@@ -431,6 +440,14 @@ AbstractMemory::functionalAccess(PacketPtr pkt)
 
     uint8_t *hostAddr = pmemAddr + pkt->getAddr() - range.start();
 
+    if (SoftError::memTainted) {
+        if (pkt->isRead())
+            SoftError::trackMemAccess(pkt->getAddr(), pkt->getSize(), NULL);
+        else if (pkt->isWrite())
+            SoftError::trackMemAccess(pkt->getAddr(), pkt->getSize(),
+                                      pkt->getConstPtr<uint8_t>());
+    }
+
     if (pkt->isRead()) {
         if (pmemAddr)
             memcpy(pkt->getPtr<uint8_t>(), hostAddr, pkt->getSize());
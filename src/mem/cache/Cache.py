@@ -82,6 +82,11 @@ class BaseCache(MemObject):
 
     system = Param.System(Parent.any, "System we belong to")
 
+    # Model ECC protection of the data array. This only adds stats
+    # counting the ECC check and update events, e.g. for use in power
+    # model expressions, the timing of the cache is not affected.
+    ecc = Param.Bool(False, "Data array is ECC protected")
+
 # Enum for cache clusivity, currently mostly inclusive or mostly
 # exclusive.
 class Clusivity(Enum): vals = ['mostly_incl', 'mostly_excl']
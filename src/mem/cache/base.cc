@@ -79,6 +79,7 @@ BaseCache::BaseCache(const BaseCacheParams *p, unsigned blk_size)
       numTarget(p->tgts_per_mshr),
       forwardSnoops(true),
       isReadOnly(p->is_read_only),
+      ecc(p->ecc),
       blocked(0),
       order(0),
       noTargetMSHR(nullptr),
@@ -453,6 +454,30 @@ BaseCache::regStats()
         writebacks.subname(i, system->getMasterName(i));
     }
 
+    if (ecc) {
+        eccChecks.reset(new Stats::Formula);
+        (*eccChecks)
+            .name(name() + ".ecc_checks")
+            .desc("number of ECC checks (hits and writebacks)")
+            .flags(total | nozero | nonan)
+            ;
+        *eccChecks = overallHits + writebacks;
+        for (int i = 0; i < system->maxMasters(); i++) {
+            eccChecks->subname(i, system->getMasterName(i));
+        }
+
+        eccUpdates.reset(new Stats::Formula);
+        (*eccUpdates)
+            .name(name() + ".ecc_updates")
+            .desc("number of ECC updates (fills and write hits)")
+            .flags(total | nozero | nonan)
+            ;
+        *eccUpdates = overallMisses + hits[MemCmd::WriteReq];
+        for (int i = 0; i < system->maxMasters(); i++) {
+            eccUpdates->subname(i, system->getMasterName(i));
+        }
+    }
+
     // MSHR statistics
     // MSHR hit statistics
     for (int access_idx = 0; access_idx < MemCmd::NUM_MEM_CMDS; ++access_idx) {
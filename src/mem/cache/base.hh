@@ -52,6 +52,7 @@
 
 #include <algorithm>
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -295,6 +296,9 @@ class BaseCache : public MemObject
      */
     const bool isReadOnly;
 
+    /** Is the data array ECC protected? */
+    const bool ecc;
+
     /**
      * Bit vector of the blocking reasons for the access path.
      * @sa #BlockedCause
@@ -389,6 +393,14 @@ class BaseCache : public MemObject
     /** Number of blocks written back per thread. */
     Stats::Vector writebacks;
 
+    /**
+     * ECC checks: data array reads on hits and writebacks. Only
+     * created with ecc, as every constructed stat must be registered.
+     */
+    std::unique_ptr<Stats::Formula> eccChecks;
+    /** ECC updates: data array writes on fills and write hits. */
+    std::unique_ptr<Stats::Formula> eccUpdates;
+
     /** Number of misses that hit in the MSHRs per command and thread. */
     Stats::Vector mshr_hits[MemCmd::NUM_MEM_CMDS];
     /** Demand misses that hit in the MSHRs. */
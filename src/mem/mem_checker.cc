@@ -38,10 +38,22 @@
  *          Marco Elver
  */
 
+#include <algorithm>
 #include <cassert>
 
 #include "mem/mem_checker.hh"
 
+const MemChecker::Transaction MemChecker::ByteTracker::initialObservation(
+    SERIAL_INITIAL, TICK_INITIAL, TICK_INITIAL, DATA_INITIAL);
+
+std::vector<MemChecker::Transaction>::iterator
+MemChecker::WriteCluster::findWrite(MemChecker::Serial serial)
+{
+    return std::find_if(writes.begin(), writes.end(),
+                        [serial](const Transaction &write)
+                        { return write.serial == serial; });
+}
+
 void
 MemChecker::WriteCluster::startWrite(MemChecker::Serial serial, Tick _start,
                                      uint8_t data)
@@ -65,14 +77,13 @@ MemChecker::WriteCluster::startWrite(MemChecker::Serial serial, Tick _start,
     }
 
     // Create new transaction, and denote completion time to be in the future.
-    writes.insert(std::make_pair(serial,
-                  MemChecker::Transaction(serial, _start, TICK_FUTURE, data)));
+    writes.emplace_back(serial, _start, TICK_FUTURE, data);
 }
 
 void
 MemChecker::WriteCluster::completeWrite(MemChecker::Serial serial, Tick _complete)
 {
-    auto it = writes.find(serial);
+    auto it = findWrite(serial);
 
     if (it == writes.end()) {
         warn("Could not locate write transaction: serial = %d, complete = %d\n",
@@ -81,8 +92,8 @@ MemChecker::WriteCluster::completeWrite(MemChecker::Serial serial, Tick _complet
     }
 
     // Record completion time of the write
-    assert(it->second.complete == TICK_FUTURE);
-    it->second.complete = _complete;
+    assert(it->complete == TICK_FUTURE);
+    it->complete = _complete;
 
     // Update max completion time for the cluster
     if (completeMax < _complete) {
@@ -103,11 +114,15 @@ MemChecker::WriteCluster::completeWrite(MemChecker::Serial serial, Tick _complet
 void
 MemChecker::WriteCluster::abortWrite(MemChecker::Serial serial)
 {
-    if (!writes.erase(serial)) {
+    auto it = findWrite(serial);
+
+    if (it == writes.end()) {
         warn("Could not locate write transaction: serial = %d\n", serial);
         return;
     }
 
+    writes.erase(it);
+
     if (--numIncomplete == 0 && !writes.empty()) {
         // This write cluster is now complete, and we can assign the current
         // completeMax value.
@@ -119,33 +134,46 @@ MemChecker::WriteCluster::abortWrite(MemChecker::Serial serial)
     // getIncompleteWriteCluster().
 }
 
+std::string
+MemChecker::ByteTracker::name() const
+{
+    return (parent != NULL ? parent->name() : "") +
+        csprintf(".ByteTracker@%#llx", addr);
+}
+
 void
 MemChecker::ByteTracker::startRead(MemChecker::Serial serial, Tick start)
 {
-    outstandingReads.insert(std::make_pair(serial,
-            MemChecker::Transaction(serial, start, TICK_FUTURE)));
+    assert(outstandingReads.empty() ||
+           outstandingReads.back().serial < serial);
+    outstandingReads.emplace_back(serial, start, TICK_FUTURE);
 }
 
 bool
-MemChecker::ByteTracker::inExpectedData(Tick start, Tick complete, uint8_t data)
+MemChecker::ByteTracker::inExpectedData(Tick start, Tick complete, uint8_t data,
+                                        std::vector<uint8_t> *expected)
 {
-    _lastExpectedData.clear();
+    expected->clear();
 
     bool wc_overlap = true;
 
-    // Find the last value read from the location
-    const Transaction& last_obs =
-        *lastCompletedTransaction(&readObservations, start);
-    bool last_obs_valid = (last_obs.complete != TICK_INITIAL);
+    // Find the last value read from the location; the initial observation
+    // precedes all others as long as it has not been pruned.
+    const Transaction* last_obs = &initialObservation;
+    if (!readObservations.empty()) {
+        auto it = lastCompletedTransaction(&readObservations, start);
+        if (!hasInitialObservation || it->complete < start)
+            last_obs = &*it;
+    }
+    bool last_obs_valid = (last_obs->complete != TICK_INITIAL);
 
     // Scan backwards through the write clusters to find the closest younger
     // preceding & overlapping writes.
     for (auto cluster = writeClusters.rbegin();
          cluster != writeClusters.rend() && wc_overlap; ++cluster) {
-        for (const auto& addr_write : cluster->writes) {
-            const Transaction& write = addr_write.second;
+        for (const auto& write : cluster->writes) {
 
-            if (write.complete < last_obs.start) {
+            if (write.complete < last_obs->start) {
                 // If this write transaction completed before the last
                 // observation, we ignore it as the last_observation has the
                 // correct value
@@ -158,7 +186,7 @@ MemChecker::ByteTracker::inExpectedData(Tick start, Tick complete, uint8_t data)
             }
 
             // Record possible, but non-matching data for debugging
-            _lastExpectedData.push_back(write.data);
+            expected->push_back(write.data);
 
             if (write.complete > start) {
                 // This write overlapped with the transaction we want to check
@@ -171,7 +199,7 @@ MemChecker::ByteTracker::inExpectedData(Tick start, Tick complete, uint8_t data)
             // write-cluster -> set the exit condition for the outer loop
             wc_overlap = false;
 
-            if (last_obs.complete < write.start) {
+            if (last_obs->complete < write.start) {
                 // We found a write which started after the last observed read,
                 // therefore we can not longer consider the value seen by the
                 // last observation as a valid expected value.
@@ -188,13 +216,13 @@ MemChecker::ByteTracker::inExpectedData(Tick start, Tick complete, uint8_t data)
     if (last_obs_valid) {
         // The last observation is not outdated according to the writes we have
         // seen so far.
-        assert(last_obs.complete <= start);
-        if (last_obs.data == data) {
+        assert(last_obs->complete <= start);
+        if (last_obs->data == data) {
             // Matched data from last observation -> all good
             return true;
         }
         // Record non-matching, but possible value
-        _lastExpectedData.push_back(last_obs.data);
+        expected->push_back(last_obs->data);
     } else {
         // We have not seen any valid observation, and the only writes
         // observed are overlapping, so anything (in particular the
@@ -208,8 +236,8 @@ MemChecker::ByteTracker::inExpectedData(Tick start, Tick complete, uint8_t data)
         }
     }
 
-    if (_lastExpectedData.empty()) {
-        assert(last_obs.complete == TICK_INITIAL);
+    if (expected->empty()) {
+        assert(last_obs->complete == TICK_INITIAL);
         // We have not found any possible (non-matching data). Can happen in
         // initial system state
         DPRINTF(MemChecker, "no last observation nor write! start = %d, "\
@@ -221,22 +249,25 @@ MemChecker::ByteTracker::inExpectedData(Tick start, Tick complete, uint8_t data)
 
 bool
 MemChecker::ByteTracker::completeRead(MemChecker::Serial serial,
-                                      Tick complete, uint8_t data)
+                                      Tick complete, uint8_t data,
+                                      std::vector<uint8_t> *expected)
 {
-    auto it = outstandingReads.find(serial);
+    auto it = std::lower_bound(outstandingReads.begin(),
+                               outstandingReads.end(),
+                               Transaction(serial, TICK_INITIAL, TICK_FUTURE));
 
-    if (it == outstandingReads.end()) {
+    if (it == outstandingReads.end() || it->serial != serial) {
         // Can happen if concurrent with reset_address_range
         warn("Could not locate read transaction: serial = %d, complete = %d\n",
              serial, complete);
         return true;
     }
 
-    Tick start = it->second.start;
+    Tick start = it->start;
     outstandingReads.erase(it);
 
     // Verify data
-    const bool result = inExpectedData(start, complete, data);
+    const bool result = inExpectedData(start, complete, data, expected);
 
     readObservations.emplace_back(serial, start, complete, data);
     pruneTransactions();
@@ -281,11 +312,17 @@ MemChecker::ByteTracker::pruneTransactions()
     // reads, we use curTick(), i.e. we will remove all readObservation except
     // the most recent one.
     const Tick before = outstandingReads.empty() ? curTick() :
-                        outstandingReads.begin()->second.start;
-
-    // Pruning of readObservations
-    readObservations.erase(readObservations.begin(),
-                           lastCompletedTransaction(&readObservations, before));
+                        outstandingReads.front().start;
+
+    // Pruning of readObservations; once a real observation completed before
+    // the first outstanding read, the initial one is superseded as well.
+    if (!readObservations.empty()) {
+        auto it = lastCompletedTransaction(&readObservations, before);
+        if (it->complete < before) {
+            readObservations.erase(readObservations.begin(), it);
+            hasInitialObservation = false;
+        }
+    }
 
     // Pruning of writeClusters
     if (!writeClusters.empty()) {
@@ -294,6 +331,18 @@ MemChecker::ByteTracker::pruneTransactions()
     }
 }
 
+void
+MemChecker::ByteTracker::compact()
+{
+    pruneTransactions();
+
+    outstandingReads.shrink_to_fit();
+    readObservations.shrink_to_fit();
+    writeClusters.shrink_to_fit();
+    for (auto &cluster : writeClusters)
+        cluster.writes.shrink_to_fit();
+}
+
 bool
 MemChecker::completeRead(MemChecker::Serial serial, Tick complete,
                          Addr addr, size_t size, uint8_t *data)
@@ -307,7 +356,8 @@ MemChecker::completeRead(MemChecker::Serial serial, Tick complete,
     for (size_t i = 0; i < size; ++i) {
         ByteTracker *tracker = getByteTracker(addr + i);
 
-        if (!tracker->completeRead(serial, complete, data[i])) {
+        if (!tracker->completeRead(serial, complete, data[i],
+                                   &lastExpectedData)) {
             // Generate error message, and aggregate all failures for the bytes
             // considered in this transaction in one message.
             if (result) {
@@ -321,16 +371,18 @@ MemChecker::completeRead(MemChecker::Serial serial, Tick complete,
                                      "failed: received %#x, expected ",
                                      (unsigned long long)(addr + i), data[i]);
 
-            for (size_t j = 0; j < tracker->lastExpectedData().size(); ++j) {
+            for (size_t j = 0; j < lastExpectedData.size(); ++j) {
                 errorMessage +=
                     csprintf("%#x%s",
-                             tracker->lastExpectedData()[j],
-                             (j == tracker->lastExpectedData().size() - 1)
+                             lastExpectedData[j],
+                             (j == lastExpectedData.size() - 1)
                              ? "" : "|");
             }
         }
     }
 
+    transactionDone();
+
     if (!result) {
         DPRINTF(MemChecker, "read of %#llx @ cycle %d failed:\n%s\n", addr,
                 complete, errorMessage);
@@ -342,9 +394,47 @@ MemChecker::completeRead(MemChecker::Serial serial, Tick complete,
 void
 MemChecker::reset(Addr addr, size_t size)
 {
-    for (size_t i = 0; i < size; ++i) {
-        byte_trackers.erase(addr + i);
+    const Addr mask = ~Addr(TRACKER_BLOCK_SIZE - 1);
+
+    for (Addr block_addr = addr & mask; block_addr < addr + size;
+         block_addr += TRACKER_BLOCK_SIZE) {
+        auto it = trackerBlocks.find(block_addr);
+        if (it == trackerBlocks.end())
+            continue;
+
+        TrackerBlock &block = it->second;
+        const Addr lo = std::max(addr, block_addr);
+        const Addr hi = std::min(addr + size, block_addr + TRACKER_BLOCK_SIZE);
+        for (Addr a = lo; a < hi; ++a)
+            block.trackers[a - block_addr] = ByteTracker(a, this);
+
+        if (block.pristine()) {
+            trackerBlocks.erase(it);
+            lastBlock = NULL;
+        }
+    }
+}
+
+void
+MemChecker::collectGarbage()
+{
+    const size_t num_blocks = trackerBlocks.size();
+
+    for (auto it = trackerBlocks.begin(); it != trackerBlocks.end(); ) {
+        for (auto &tracker : it->second.trackers)
+            tracker.compact();
+
+        if (it->second.pristine())
+            it = trackerBlocks.erase(it);
+        else
+            ++it;
     }
+
+    lastBlock = NULL;
+    completedSinceGc = 0;
+
+    DPRINTF(MemChecker, "garbage collection freed %d of %d tracker blocks\n",
+            num_blocks - trackerBlocks.size(), num_blocks);
 }
 
 MemChecker*
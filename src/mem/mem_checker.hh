@@ -41,10 +41,10 @@
 #ifndef __MEM_MEM_CHECKER_HH__
 #define __MEM_MEM_CHECKER_HH__
 
-#include <list>
-#include <map>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "base/misc.hh"
@@ -126,7 +126,8 @@ class MemChecker : public SimObject
         uint8_t data;
 
         /**
-         * Orders Transactions for use with std::map.
+         * Orders Transactions by serial, e.g. for searching the sorted
+         * outstanding reads.
          */
         bool operator<(const Transaction& rhs) const
         { return serial < rhs.serial; }
@@ -181,39 +182,54 @@ class MemChecker : public SimObject
         Tick complete;  //!< Completion of last write in cluster
 
         /**
-         * Map of Serial --> Transaction of all writes in cluster; contains
-         * all, in-flight or already completed.
+         * All writes in cluster, in the order they were started; contains
+         * all, in-flight or already completed. Clusters rarely hold more
+         * than a handful of writes, so a linear search by serial beats
+         * hashing and keeps the storage in one allocation.
          */
-        std::unordered_map<Serial, Transaction> writes;
+        std::vector<Transaction> writes;
 
       private:
+        /**
+         * @return Iterator to the write with the given serial, or
+         *         writes.end() if there is none.
+         */
+        std::vector<Transaction>::iterator findWrite(Serial serial);
+
         Tick completeMax;
         size_t numIncomplete;
     };
 
-    typedef std::list<Transaction> TransactionList;
-    typedef std::list<WriteCluster> WriteClusterList;
+    /**
+     * Transactions and write clusters are kept in vectors used as queues:
+     * new entries are appended at the back and pruning drops a prefix.
+     * Once pruned, these hold very few entries, and a vector costs a
+     * single allocation rather than one per node.
+     */
+    typedef std::vector<Transaction> TransactionList;
+    typedef std::vector<WriteCluster> WriteClusterList;
 
     /**
      * The ByteTracker keeps track of transactions for the *same byte* -- all
      * outstanding reads, the completed reads (and what they observed) and write
      * clusters (see WriteCluster).
+     *
+     * Trackers are allocated a cache line at a time (see TrackerBlock), and
+     * one that has never been accessed owns no heap storage.
      */
-    class ByteTracker : public Named
+    class ByteTracker
     {
       public:
 
-        ByteTracker(Addr addr = 0, const MemChecker *parent = NULL)
-            : Named((parent != NULL ? parent->name() : "") +
-                     csprintf(".ByteTracker@%#llx", addr))
-        {
-            // The initial transaction has start == complete == TICK_INITIAL,
-            // indicating that there has been no real write to this location;
-            // therefore, upon checking, we do not expect any particular value.
-            readObservations.emplace_back(
-                    Transaction(SERIAL_INITIAL, TICK_INITIAL, TICK_INITIAL,
-                                DATA_INITIAL));
-        }
+        ByteTracker(Addr _addr = 0, const MemChecker *_parent = NULL)
+            : addr(_addr), parent(_parent), hasInitialObservation(true)
+        {}
+
+        /**
+         * Name used for debug output. Built on demand, as storing a name
+         * per byte would dominate the memory footprint of the checker.
+         */
+        std::string name() const;
 
         /**
          * Starts a read transaction.
@@ -244,10 +260,14 @@ class MemChecker : public SimObject
          * @param start     Start time of transaction to validate.
          * @param complete  End time of transaction to validate.
          * @param data      The value that we have actually seen.
+         * @param expected  Filled with the expected data iterated through.
+         *                  If true is returned, the set may be incomplete;
+         *                  if false is returned, it contains the full set.
          *
          * @return          True if a match is found, false otherwise.
          */
-        bool inExpectedData(Tick start, Tick complete, uint8_t data);
+        bool inExpectedData(Tick start, Tick complete, uint8_t data,
+                            std::vector<uint8_t> *expected);
 
         /**
          * Completes a read transaction that is still outstanding.
@@ -255,8 +275,10 @@ class MemChecker : public SimObject
          * @param serial   Unique identifier of a read *previously started*.
          * @param complete When the read got a response.
          * @param data     The data returned by the memory subsystem.
+         * @param expected See inExpectedData().
          */
-        bool completeRead(Serial serial, Tick complete, uint8_t data);
+        bool completeRead(Serial serial, Tick complete, uint8_t data,
+                          std::vector<uint8_t> *expected);
 
         /**
          * Starts a write transaction. Wrapper to startWrite of WriteCluster
@@ -287,16 +309,20 @@ class MemChecker : public SimObject
         void abortWrite(Serial serial);
 
         /**
-         * This function returns the expected data that inExpectedData iterated
-         * through in the last call. If inExpectedData last returned true, the
-         * set may be incomplete; if inExpectedData last returned false, the
-         * vector will contain the full set.
-         *
-         * @return Reference to internally maintained vector maintaining last
-         *         expected data that inExpectedData iterated through.
+         * Prunes transactions that are no longer needed and releases any
+         * spare capacity left behind by earlier bursts of activity.
          */
-        const std::vector<uint8_t>& lastExpectedData() const
-        { return _lastExpectedData; }
+        void compact();
+
+        /**
+         * @return true if this tracker holds no state, i.e. it is
+         *         equivalent to a freshly constructed one.
+         */
+        bool pristine() const
+        {
+            return hasInitialObservation && outstandingReads.empty() &&
+                readObservations.empty() && writeClusters.empty();
+        }
 
       private:
 
@@ -343,15 +369,31 @@ class MemChecker : public SimObject
          */
         void pruneTransactions();
 
+        /**
+         * The initial observation has start == complete == TICK_INITIAL,
+         * indicating that there has been no real write to this location;
+         * therefore, upon checking, we do not expect any particular value.
+         * It is shared by all trackers, see hasInitialObservation.
+         */
+        static const Transaction initialObservation;
+
       private:
 
+        Addr addr;                  //!< Tracked location
+        const MemChecker *parent;   //!< Owning checker, for name()
+
         /**
-         * Maintains a map of Serial -> Transaction for all outstanding reads.
-         *
-         * Use an ordered map here, as this makes pruneTransactions() more
-         * efficient (find first outstanding read).
+         * Whether initialObservation logically precedes readObservations.
+         * It does until pruning finds a later observation to keep instead.
+         */
+        bool hasInitialObservation;
+
+        /**
+         * All outstanding reads, sorted by serial. Serials are handed out in
+         * increasing order, so starting a read appends, and the front is
+         * the oldest outstanding read as needed by pruneTransactions().
          */
-        std::map<Serial, Transaction> outstandingReads;
+        TransactionList outstandingReads;
 
         /**
          * List of completed reads, i.e. observations of reads.
@@ -362,18 +404,52 @@ class MemChecker : public SimObject
          * List of write clusters for this address.
          */
         WriteClusterList writeClusters;
+    };
+
+    /**
+     * Number of bytes covered by a TrackerBlock, as a power of two.
+     */
+    static const unsigned TRACKER_BLOCK_BITS = 6;
+    static const unsigned TRACKER_BLOCK_SIZE = 1 << TRACKER_BLOCK_BITS;
+
+    /**
+     * The ByteTrackers of one naturally aligned, cache-line sized block of
+     * memory. Tracking storage is allocated and looked up per block, which
+     * turns the byte-by-byte accesses of a transaction into one hash lookup
+     * per line.
+     */
+    class TrackerBlock
+    {
+      public:
+        TrackerBlock(Addr base, const MemChecker *parent)
+        {
+            for (unsigned i = 0; i < TRACKER_BLOCK_SIZE; ++i)
+                trackers[i] = ByteTracker(base + i, parent);
+        }
 
         /**
-         * See lastExpectedData().
+         * @return true if none of the trackers in the block holds state.
          */
-        std::vector<uint8_t> _lastExpectedData;
+        bool pristine() const
+        {
+            for (unsigned i = 0; i < TRACKER_BLOCK_SIZE; ++i) {
+                if (!trackers[i].pristine())
+                    return false;
+            }
+            return true;
+        }
+
+      public:
+        ByteTracker trackers[TRACKER_BLOCK_SIZE];
     };
 
   public:
 
     MemChecker(const MemCheckerParams *p)
         : SimObject(p),
-          nextSerial(SERIAL_INITIAL)
+          nextSerial(SERIAL_INITIAL),
+          gcInterval(p->gc_interval), completedSinceGc(0),
+          lastBlockAddr(0), lastBlock(NULL)
     {}
 
     virtual ~MemChecker() {}
@@ -449,7 +525,10 @@ class MemChecker : public SimObject
      * the reset with serial S.
      */
     void reset()
-    { byte_trackers.clear(); }
+    {
+        trackerBlocks.clear();
+        lastBlock = NULL;
+    }
 
     /**
      * Resets an address-range. This may be useful in case other unmonitored
@@ -475,17 +554,45 @@ class MemChecker : public SimObject
   private:
     /**
      * Returns the instance of ByteTracker for the requested location.
+     * Consecutive bytes of a transaction hit the same block, so the block
+     * found last is remembered to avoid repeating the hash lookup.
      */
     ByteTracker* getByteTracker(Addr addr)
     {
-        auto it = byte_trackers.find(addr);
-        if (it == byte_trackers.end()) {
-            it = byte_trackers.insert(
-                std::make_pair(addr, ByteTracker(addr, this))).first;
+        const Addr block_addr = addr & ~Addr(TRACKER_BLOCK_SIZE - 1);
+
+        if (lastBlock == NULL || lastBlockAddr != block_addr) {
+            auto it = trackerBlocks.find(block_addr);
+            if (it == trackerBlocks.end()) {
+                it = trackerBlocks.emplace(std::piecewise_construct,
+                                           std::forward_as_tuple(block_addr),
+                                           std::forward_as_tuple(block_addr,
+                                                                 this)).first;
+            }
+            lastBlockAddr = block_addr;
+            lastBlock = &it->second;
         }
-        return &it->second;
+
+        return &lastBlock->trackers[addr - block_addr];
     };
 
+    /**
+     * Counts a finished transaction and, at the end of each epoch of
+     * gcInterval transactions, runs collectGarbage().
+     */
+    void transactionDone()
+    {
+        if (gcInterval != 0 && ++completedSinceGc >= gcInterval)
+            collectGarbage();
+    }
+
+    /**
+     * Sweeps all tracker blocks: prunes and compacts each tracker, and
+     * frees the blocks left without any state. This bounds the memory held
+     * by trackers that were busy once but have since gone quiet.
+     */
+    void collectGarbage();
+
   private:
     /**
      * Detailed error message of the last violation in completeRead.
@@ -499,8 +606,20 @@ class MemChecker : public SimObject
     Serial nextSerial;
 
     /**
-     * Maintain a map of address --> byte-tracker. Per-byte entries are
-     * initialized as needed.
+     * Number of finished transactions per garbage collection epoch, zero if
+     * garbage collection is disabled.
+     */
+    const unsigned gcInterval;
+
+    /**
+     * Number of transactions finished in the current epoch.
+     */
+    unsigned completedSinceGc;
+
+    /**
+     * Maintain a map of block address --> tracker block. Blocks are
+     * initialized as needed. Being node based, the map never moves a block
+     * once inserted, so pointers to trackers stay valid until it is erased.
      *
      * The required space for this obviously grows with the number of distinct
      * addresses used for a particular workload. The used size is independent on
@@ -509,7 +628,20 @@ class MemChecker : public SimObject
      *
      * Access via getByteTracker()!
      */
-    std::unordered_map<Addr, ByteTracker> byte_trackers;
+    std::unordered_map<Addr, TrackerBlock> trackerBlocks;
+
+    /**
+     * Address and instance of the block most recently looked up by
+     * getByteTracker(). Must be invalidated whenever blocks are erased.
+     */
+    Addr lastBlockAddr;
+    TrackerBlock *lastBlock;
+
+    /**
+     * Expected data of the byte checked last, shared by all trackers. See
+     * ByteTracker::inExpectedData().
+     */
+    std::vector<uint8_t> lastExpectedData;
 };
 
 inline MemChecker::Serial
@@ -551,6 +683,8 @@ MemChecker::completeWrite(MemChecker::Serial serial, Tick complete,
     for (size_t i = 0; i < size; ++i) {
         getByteTracker(addr + i)->completeWrite(serial, complete);
     }
+
+    transactionDone();
 }
 
 inline void
@@ -563,6 +697,8 @@ MemChecker::abortWrite(MemChecker::Serial serial, Addr addr, size_t size)
     for (size_t i = 0; i < size; ++i) {
         getByteTracker(addr + i)->abortWrite(serial);
     }
+
+    transactionDone();
 }
 
 #endif // __MEM_MEM_CHECKER_HH__
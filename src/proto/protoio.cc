@@ -37,13 +37,23 @@
  * Authors: Andreas Hansson
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
 #include "base/misc.hh"
 #include "proto/protoio.hh"
 
 using namespace std;
 using namespace google::protobuf;
 
-ProtoOutputStream::ProtoOutputStream(const string& filename) :
+ProtoOutputStream::ProtoOutputStream(const string& filename,
+                                     int compression_level) :
     fileStream(filename.c_str(), ios::out | ios::binary | ios::trunc),
     wrappedFileStream(NULL), gzipStream(NULL), zeroCopyStream(NULL)
 {
@@ -56,7 +66,9 @@ ProtoOutputStream::ProtoOutputStream(const string& filename) :
     wrappedFileStream = new io::OstreamOutputStream(&fileStream);
     if (filename.find_last_of('.') != string::npos &&
         filename.substr(filename.find_last_of('.') + 1) == "gz") {
-        gzipStream = new io::GzipOutputStream(wrappedFileStream);
+        io::GzipOutputStream::Options options;
+        options.compression_level = compression_level;
+        gzipStream = new io::GzipOutputStream(wrappedFileStream, options);
         zeroCopyStream = gzipStream;
     } else {
         zeroCopyStream = wrappedFileStream;
@@ -94,10 +106,184 @@ ProtoOutputStream::write(const Message& msg)
     msg.SerializeWithCachedSizes(&codedStream);
 }
 
+bool
+MappedInputStream::Next(const void** buf, int* buf_size)
+{
+    if (pos == size) {
+        lastSize = 0;
+        return false;
+    }
+
+    lastSize = (int)min<uint64_t>(blockSize, size - pos);
+    *buf = data + pos;
+    *buf_size = lastSize;
+    pos += lastSize;
+    return true;
+}
+
+void
+MappedInputStream::BackUp(int count)
+{
+    assert(count >= 0 && count <= lastSize);
+    pos -= count;
+    lastSize -= count;
+}
+
+bool
+MappedInputStream::Skip(int count)
+{
+    assert(count >= 0);
+    lastSize = 0;
+    if ((uint64_t)count > size - pos) {
+        pos = size;
+        return false;
+    }
+    pos += count;
+    return true;
+}
+
+PrefetchInputStream::PrefetchInputStream(io::ZeroCopyInputStream* _source,
+                                         size_t buffer_size,
+                                         size_t num_buffers)
+    : source(_source), ring(num_buffers), head(0), filled(0),
+      sourceDone(false), stop(false), holding(false), backedUp(0),
+      consumed(0)
+{
+    assert(num_buffers > 0 && buffer_size > 0);
+    for (auto& buf : ring) {
+        buf.data.resize(buffer_size);
+        buf.size = 0;
+    }
+
+    // Start the helper thread last, once the ring is in place
+    worker = thread(&PrefetchInputStream::fill, this);
+}
+
+PrefetchInputStream::~PrefetchInputStream()
+{
+    {
+        lock_guard<mutex> lock(ringMutex);
+        stop = true;
+    }
+    ringCond.notify_all();
+    worker.join();
+}
+
+size_t
+PrefetchInputStream::fillBuffer(vector<char>& buf)
+{
+    size_t size = 0;
+    const void* chunk;
+    int chunk_size;
+
+    while (size < buf.size() && source->Next(&chunk, &chunk_size)) {
+        size_t n = min<size_t>(chunk_size, buf.size() - size);
+        memcpy(buf.data() + size, chunk, n);
+        size += n;
+        // Hand back what did not fit, it goes into the next buffer
+        if (n < (size_t)chunk_size)
+            source->BackUp(chunk_size - n);
+    }
+
+    return size;
+}
+
+void
+PrefetchInputStream::fill()
+{
+    while (true) {
+        Buffer* buf;
+        {
+            unique_lock<mutex> lock(ringMutex);
+            ringCond.wait(lock,
+                          [this] { return stop || filled < ring.size(); });
+            if (stop)
+                return;
+            // The consumer never touches buffers beyond the filled
+            // ones, so this one can be filled without holding the lock
+            buf = &ring[(head + filled) % ring.size()];
+        }
+
+        buf->size = fillBuffer(buf->data);
+
+        {
+            lock_guard<mutex> lock(ringMutex);
+            if (buf->size > 0)
+                ++filled;
+            sourceDone = buf->size < buf->data.size();
+        }
+        ringCond.notify_all();
+
+        if (sourceDone)
+            return;
+    }
+}
+
+bool
+PrefetchInputStream::Next(const void** buf, int* buf_size)
+{
+    if (backedUp > 0) {
+        const Buffer& cur = ring[head];
+        *buf = cur.data.data() + cur.size - backedUp;
+        *buf_size = backedUp;
+        consumed += backedUp;
+        backedUp = 0;
+        return true;
+    }
+
+    unique_lock<mutex> lock(ringMutex);
+    if (holding) {
+        // Done with the current buffer, pass it back to the helper
+        head = (head + 1) % ring.size();
+        --filled;
+        holding = false;
+        ringCond.notify_all();
+    }
+
+    ringCond.wait(lock, [this] { return filled > 0 || sourceDone; });
+    if (filled == 0)
+        return false;
+
+    holding = true;
+    const Buffer& cur = ring[head];
+    *buf = cur.data.data();
+    *buf_size = cur.size;
+    consumed += cur.size;
+    return true;
+}
+
+void
+PrefetchInputStream::BackUp(int count)
+{
+    assert(holding && count >= 0 && backedUp + count <= (int)ring[head].size);
+    backedUp += count;
+    consumed -= count;
+}
+
+bool
+PrefetchInputStream::Skip(int count)
+{
+    const void* buf;
+    int size;
+
+    while (count > 0) {
+        if (!Next(&buf, &size))
+            return false;
+        if (size > count) {
+            BackUp(size - count);
+            return true;
+        }
+        count -= size;
+    }
+
+    return true;
+}
+
 ProtoInputStream::ProtoInputStream(const string& filename) :
     fileStream(filename.c_str(), ios::in | ios::binary), fileName(filename),
-    useGzip(false),
-    wrappedFileStream(NULL), gzipStream(NULL), zeroCopyStream(NULL)
+    useGzip(false), mapping(NULL), mappingSize(0),
+    wrappedFileStream(NULL), gzipStream(NULL), prefetchStream(NULL),
+    zeroCopyStream(NULL)
 {
     if (!fileStream.good())
         panic("Could not open %s for reading\n", filename);
@@ -111,23 +297,58 @@ ProtoInputStream::ProtoInputStream(const string& filename) :
     fileStream.clear();
     fileStream.seekg(0, ifstream::beg);
 
+    mapFile();
     createStreams();
 }
 
+void
+ProtoInputStream::mapFile()
+{
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        return;
+    }
+
+    void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        warn("Could not map %s (%s), using file I/O instead\n",
+             fileName, strerror(errno));
+        return;
+    }
+
+    // Traces are read front to back, let the kernel read ahead
+    madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+    mapping = (uint8_t*)addr;
+    mappingSize = st.st_size;
+}
+
 void
 ProtoInputStream::createStreams()
 {
     // All streams should be NULL at this point
     assert(wrappedFileStream == NULL && gzipStream == NULL &&
-           zeroCopyStream == NULL);
+           prefetchStream == NULL && zeroCopyStream == NULL);
+
+    // Wrap the mapped or plain input file in a zero copy stream, that
+    // in turn is wrapped in a gzip stream, inflated ahead on a helper
+    // thread, if the file is compressed. The latter stream is in turn
+    // wrapped in a coded stream
+    if (mapping != NULL)
+        wrappedFileStream = new MappedInputStream(mapping, mappingSize);
+    else
+        wrappedFileStream = new io::IstreamInputStream(&fileStream);
 
-    // Wrap the input file in a zero copy stream, that in turn is
-    // wrapped in a gzip stream if the filename ends with .gz. The
-    // latter stream is in turn wrapped in a coded stream
-    wrappedFileStream = new io::IstreamInputStream(&fileStream);
     if (useGzip) {
         gzipStream = new io::GzipInputStream(wrappedFileStream);
-        zeroCopyStream = gzipStream;
+        prefetchStream = new PrefetchInputStream(gzipStream);
+        zeroCopyStream = prefetchStream;
     } else {
         zeroCopyStream = wrappedFileStream;
     }
@@ -143,7 +364,12 @@ ProtoInputStream::createStreams()
 void
 ProtoInputStream::destroyStreams()
 {
-    // As the compression is optional, see if the stream exists
+    // As the compression is optional, see if the streams exist. The
+    // read-ahead stream goes first, as its helper reads from the others
+    if (prefetchStream != NULL) {
+        delete prefetchStream;
+        prefetchStream = NULL;
+    }
     if (gzipStream != NULL) {
         delete gzipStream;
         gzipStream = NULL;
@@ -158,6 +384,8 @@ ProtoInputStream::destroyStreams()
 ProtoInputStream::~ProtoInputStream()
 {
     destroyStreams();
+    if (mapping != NULL)
+        munmap(mapping, mappingSize);
     fileStream.close();
 }
 
@@ -51,7 +51,11 @@
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/message.h>
 
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 /**
  * A ProtoStream provides the shared functionality of the input and
@@ -99,8 +103,11 @@ class ProtoOutputStream : public ProtoStream
      * ends with .gz then the file will be compressed accordinly.
      *
      * @param filename Path to the file to create or truncate
+     * @param compression_level zlib compression level of a compressed
+     *        stream, -1 for the zlib default
      */
-    ProtoOutputStream(const std::string& filename);
+    ProtoOutputStream(const std::string& filename,
+                      int compression_level = -1);
 
     /**
      * Destruct the output stream, and also flush and close the
@@ -132,12 +139,153 @@ class ProtoOutputStream : public ProtoStream
 
 };
 
+/**
+ * A zero-copy input stream over a memory-mapped file. The mapping is
+ * handed out in blocks, as the size of a single block is limited to an
+ * int, whereas traces may be several GB in size.
+ */
+class MappedInputStream : public google::protobuf::io::ZeroCopyInputStream
+{
+
+  public:
+
+    /**
+     * Create a stream over an existing mapping, which must outlive
+     * the stream.
+     *
+     * @param _data Start of the mapping
+     * @param _size Size of the mapping in bytes
+     */
+    MappedInputStream(const uint8_t* _data, uint64_t _size)
+        : data(_data), size(_size), pos(0), lastSize(0)
+    {}
+
+    bool Next(const void** buf, int* buf_size) override;
+
+    void BackUp(int count) override;
+
+    bool Skip(int count) override;
+
+    google::protobuf::int64 ByteCount() const override { return pos; }
+
+  private:
+
+    /// Largest block returned by a single call to Next
+    static const int blockSize = 1 << 20;
+
+    const uint8_t* const data;
+    const uint64_t size;
+
+    /// Current read position
+    uint64_t pos;
+
+    /// Size of the block last returned, bounds BackUp
+    int lastSize;
+
+};
+
+/**
+ * A zero-copy input stream that reads ahead of its consumer. A helper
+ * thread pulls data from the wrapped stream, typically a decompressor,
+ * into a ring of fixed-size buffers that the simulation thread then
+ * consumes without waiting for the file system or for inflation.
+ */
+class PrefetchInputStream : public google::protobuf::io::ZeroCopyInputStream
+{
+
+  public:
+
+    /**
+     * Create a read-ahead stream and start its helper thread.
+     *
+     * @param _source Stream to read ahead from, must outlive this stream
+     * @param buffer_size Size of each buffer in the ring
+     * @param num_buffers Number of buffers in the ring
+     */
+    PrefetchInputStream(google::protobuf::io::ZeroCopyInputStream* _source,
+                        size_t buffer_size = 1 << 20,
+                        size_t num_buffers = 4);
+
+    /**
+     * Stop the helper thread and wait for it to finish.
+     */
+    ~PrefetchInputStream();
+
+    bool Next(const void** buf, int* buf_size) override;
+
+    void BackUp(int count) override;
+
+    bool Skip(int count) override;
+
+    google::protobuf::int64 ByteCount() const override { return consumed; }
+
+  private:
+
+    /**
+     * Main loop of the helper thread, filling buffers until the source
+     * is exhausted or the stream is destroyed.
+     */
+    void fill();
+
+    /**
+     * Copy data from the source until the buffer is full or the source
+     * ends.
+     *
+     * @param buf Buffer to fill
+     * @return Number of bytes copied
+     */
+    size_t fillBuffer(std::vector<char>& buf);
+
+    struct Buffer
+    {
+        std::vector<char> data;
+        size_t size;
+    };
+
+    google::protobuf::io::ZeroCopyInputStream* source;
+
+    /// Ring of buffers, only ever accessed at indices owned by a side
+    std::vector<Buffer> ring;
+
+    /// Index of the oldest filled buffer, owned by the consumer
+    size_t head;
+
+    /// Number of filled buffers, starting at head
+    size_t filled;
+
+    /// Set by the helper thread once the source is exhausted
+    bool sourceDone;
+
+    /// Set by the consumer to make the helper thread exit
+    bool stop;
+
+    std::mutex ringMutex;
+    std::condition_variable ringCond;
+
+    /// Whether the consumer is still reading from the buffer at head
+    bool holding;
+
+    /// Bytes of the buffer at head handed back by BackUp
+    int backedUp;
+
+    /// Total number of bytes consumed
+    google::protobuf::int64 consumed;
+
+    std::thread worker;
+
+};
+
 /**
  * A ProtoInputStream wraps a coded stream, potentially with
  * decompression, based on looking at the file name. Reading from the
  * stream is done on a per-message basis to avoid having to deal with
  * huge data structures. The latter assumes the length of each message
  * is encoded in the stream when it is written.
+ *
+ * Regular files are memory mapped rather than read through the STL
+ * stream, and compressed files are inflated ahead of the reader on a
+ * helper thread (see PrefetchInputStream), so that parsing messages is
+ * the only work left on the simulation thread.
  */
 class ProtoInputStream : public ProtoStream
 {
@@ -173,6 +321,13 @@ class ProtoInputStream : public ProtoStream
 
   private:
 
+    /**
+     * Try to memory map the input file. Leaves the mapping empty if the
+     * file is not a regular file or cannot be mapped, in which case it
+     * is read through the file stream instead.
+     */
+    void mapFile();
+
     /**
      * Create the internal streams that are wrapping the input file.
      */
@@ -192,12 +347,19 @@ class ProtoInputStream : public ProtoStream
     /// Boolean flag to remember whether we use gzip or not
     bool useGzip;
 
-    /// Zero Copy stream wrapping the STL input stream
-    google::protobuf::io::IstreamInputStream* wrappedFileStream;
+    /// Memory mapped input file, if mapping succeeded
+    uint8_t* mapping;
+    uint64_t mappingSize;
+
+    /// Zero Copy stream wrapping the mapping or the STL input stream
+    google::protobuf::io::ZeroCopyInputStream* wrappedFileStream;
 
     /// Optional Gzip stream to wrap the Zero Copy stream
     google::protobuf::io::GzipInputStream* gzipStream;
 
+    /// Read-ahead stream wrapping the Gzip stream, if there is one
+    PrefetchInputStream* prefetchStream;
+
     /// Top-level zero-copy stream, either with compression or not
     google::protobuf::io::ZeroCopyInputStream* zeroCopyStream;
 
@@ -109,12 +109,17 @@ def dump():
 
     prepare()
 
-    for output in outputList:
-        if output.valid():
-            output.begin()
-            for stat in stats_list:
-                output.visit(stat)
-            output.end()
+    # Formula results are cached until the last output is done
+    internal.stats.beginDump()
+    try:
+        for output in outputList:
+            if output.valid():
+                output.begin()
+                for stat in stats_list:
+                    output.visit(stat)
+                output.end()
+    finally:
+        internal.stats.endDump()
 
 def reset():
     '''Reset all statistics to the base state'''
@@ -148,6 +148,8 @@ void updateEvents();
 
 void processResetQueue();
 void processDumpQueue();
+void beginDump();
+void endDump();
 void enable();
 bool enabled();
 
@@ -76,3 +76,9 @@ class Root(SimObject):
     time_sync_period = Param.Clock("100ms", "how often to sync with real time")
     time_sync_spin_threshold = \
             Param.Clock("100us", "when less than this much time is left, spin")
+
+    # Host time profiling attributes the host cycles spent processing
+    # each event to the owning SimObject and the event type.
+    host_profile = Param.Bool(False, "Profile host time per SimObject")
+    host_profile_file = Param.String("host_profile.folded",
+        "Folded stacks of the host profile for flamegraph.pl")
@@ -0,0 +1,51 @@
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.SimObject import SimObject
+from m5.params import *
+
+class StatSampler(SimObject):
+    type = 'StatSampler'
+    cxx_header = "sim/stat_sampler.hh"
+
+    @classmethod
+    def export_methods(cls, code):
+        code('''
+      void dumpSamples();
+''')
+
+    stats = VectorParam.String("Names of the stats to sample, a name ending "
+                               "in '*' selects all stats with that prefix")
+    period = Param.Latency('1us', "Sampling period")
+    capacity = Param.Unsigned(1024, "Number of samples kept, older samples "
+                              "are overwritten")
+    dump_ticks = VectorParam.Tick([], "Ticks at which the samples are dumped")
+    dump_at_exit = Param.Bool(True, "Dump the samples when the simulation "
+                              "exits")
+    output = Param.String("stat_samples.txt", "Output file")
+    start = Param.Tick(0, "Sample from window samples before this tick on")
+    window = Param.Unsigned(0, "Samples dumped before and after each event "
+                            "marked with StatSampler::mark(), 0 to ignore "
+                            "marks")
+    deltas = Param.Bool(False, "Write the change since the previous row "
+                        "instead of the values")
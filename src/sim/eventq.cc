@@ -44,6 +44,7 @@
 #include "debug/Checkpoint.hh"
 #include "sim/core.hh"
 #include "sim/eventq_impl.hh"
+#include "sim/host_profile.hh"
 
 using namespace std;
 
@@ -80,6 +81,9 @@ Event::~Event()
 {
     assert(!scheduled());
     flags = 0;
+
+    if (HostProfiler::active)
+        HostProfiler::forget(this);
 }
 
 const std::string
@@ -224,8 +228,18 @@ EventQueue::serviceOne()
     if (!event->squashed()) {
         // forward current cycle to the time when this event occurs.
         setCurTick(event->when());
+        ++_numServiced;
+
+        if (HostProfiler::active) {
+            // Look up the site first, processing may delete the event
+            HostProfiler::Site *site = HostProfiler::site(event);
+            uint64_t start = HostProfiler::now();
+            event->process();
+            HostProfiler::record(site, HostProfiler::now() - start);
+        } else {
+            event->process();
+        }
 
-        event->process();
         if (event->isExitEvent()) {
             assert(!event->flags.isSet(Event::AutoDelete) ||
                    !event->flags.isSet(Event::IsMainQueue)); // would be silly
@@ -415,7 +429,7 @@ Event::dump() const
 }
 
 EventQueue::EventQueue(const string &n)
-    : objName(n), head(NULL), _curTick(0)
+    : objName(n), head(NULL), _curTick(0), _numServiced(0)
 {
 }
 
@@ -448,6 +448,8 @@ class EventQueue
     std::string objName;
     Event *head;
     Tick _curTick;
+    //! Number of events processed, used to measure simulator throughput
+    Counter _numServiced;
 
     //! Mutex to protect async queue.
     std::mutex async_queue_mutex;
@@ -573,6 +575,7 @@ class EventQueue
     void setCurTick(Tick newVal) { _curTick = newVal; }
     Tick getCurTick() const { return _curTick; }
     Event *getHead() const { return head; }
+    Counter numServiced() const { return _numServiced; }
 
     Event *serviceOne();
 
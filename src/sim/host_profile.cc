@@ -0,0 +1,322 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/host_profile.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+
+#include "base/callback.hh"
+#include "base/misc.hh"
+#include "base/output.hh"
+#include "sim/core.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+bool HostProfiler::active = false;
+HostProfiler::ProfileStats *HostProfiler::stats = nullptr;
+std::string HostProfiler::foldedName;
+std::unordered_map<const Event *, HostProfiler::Site *>
+    HostProfiler::eventSites;
+std::unordered_map<std::string, HostProfiler::Site *> HostProfiler::namedSites;
+std::unordered_map<std::string, HostProfiler::Site *> HostProfiler::sites;
+std::unordered_map<const char *, unsigned> HostProfiler::descIndices;
+std::unordered_map<std::string, unsigned> HostProfiler::objIndices;
+unsigned HostProfiler::numDescs = 0;
+std::mutex HostProfiler::lock;
+uint64_t HostProfiler::startCycles = 0;
+std::chrono::steady_clock::time_point HostProfiler::startTime;
+
+namespace {
+
+/** Name of the bucket for events without an owning object */
+const std::string unattributed("unattributed");
+
+/** Stat subnames may only contain identifier characters */
+std::string
+statName(const std::string &name)
+{
+    std::string s(name);
+    std::replace_if(s.begin(), s.end(),
+                    [](char c) { return !isalnum(c) && c != '_'; }, '_');
+    return s;
+}
+
+struct DumpFoldedCallback : public Callback
+{
+    void process() override { HostProfiler::dumpFolded(); }
+};
+
+std::unique_lock<std::mutex>
+guard(std::mutex &m)
+{
+    std::unique_lock<std::mutex> l(m, std::defer_lock);
+    if (numMainEventQueues > 1)
+        l.lock();
+    return l;
+}
+
+} // anonymous namespace
+
+void
+HostProfiler::enable(const std::string &fname)
+{
+    if (active)
+        return;
+
+    active = true;
+    foldedName = fname;
+    startCycles = now();
+    startTime = std::chrono::steady_clock::now();
+
+    registerExitCallback(new DumpFoldedCallback);
+}
+
+double
+HostProfiler::secondsPerCycle()
+{
+    uint64_t cycles = now() - startCycles;
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - startTime;
+
+    return cycles ? elapsed.count() / cycles : 0.0;
+}
+
+unsigned
+HostProfiler::descIndex(const char *desc)
+{
+    auto it = descIndices.find(desc);
+    if (it != descIndices.end())
+        return it->second;
+
+    // Descriptions are usually string literals, but equal strings may
+    // still live at different addresses
+    for (auto &d : descIndices) {
+        if (strcmp(d.first, desc) == 0) {
+            descIndices[desc] = d.second;
+            return d.second;
+        }
+    }
+
+    unsigned index = numDescs < maxDescs ? numDescs++ : maxDescs;
+    descIndices[desc] = index;
+    if (stats && index < maxDescs) {
+        stats->descCycles.subname(index, statName(desc));
+        stats->descEvents.subname(index, statName(desc));
+    }
+
+    return index;
+}
+
+HostProfiler::Site *
+HostProfiler::newSite(const Event *event)
+{
+    const char *desc = event->description();
+    std::string name(event->name());
+
+    // Events that don't override name() are named Event_<n> and
+    // can't be attributed to an object
+    bool named = name.compare(0, 6, "Event_") != 0;
+    std::string named_key(name + ";" + desc);
+    if (named) {
+        auto it = namedSites.find(named_key);
+        if (it != namedSites.end())
+            return it->second;
+    }
+
+    std::string owner(unattributed);
+    if (named) {
+        for (size_t pos = name.rfind('.'); pos != std::string::npos;
+             pos = name.rfind('.', pos - 1)) {
+            std::string prefix(name, 0, pos);
+            if (SimObject::find(prefix.c_str())) {
+                owner = prefix;
+                break;
+            }
+            if (pos == 0)
+                break;
+        }
+        if (owner == unattributed && SimObject::find(name.c_str()))
+            owner = name;
+    }
+
+    std::string key(owner + ";" + desc);
+    Site *&site = sites[key];
+    if (!site) {
+        auto obj = objIndices.find(owner);
+        site = new Site{owner, desc,
+                        obj != objIndices.end() ?
+                            obj->second : (unsigned)objIndices.size(),
+                        descIndex(desc), 0, 0};
+    }
+
+    if (named)
+        namedSites[named_key] = site;
+
+    return site;
+}
+
+HostProfiler::Site *
+HostProfiler::site(const Event *event)
+{
+    auto l = guard(lock);
+    Site *&site = eventSites[event];
+    if (!site)
+        site = newSite(event);
+
+    return site;
+}
+
+void
+HostProfiler::record(Site *site, uint64_t cycles)
+{
+    auto l = guard(lock);
+    site->cycles += cycles;
+    ++site->count;
+
+    if (stats) {
+        stats->objCycles[site->objIndex] += cycles;
+        stats->objEvents[site->objIndex]++;
+        stats->descCycles[site->descIndex] += cycles;
+        stats->descEvents[site->descIndex]++;
+    }
+}
+
+void
+HostProfiler::forget(const Event *event)
+{
+    auto l = guard(lock);
+    eventSites.erase(event);
+}
+
+void
+HostProfiler::regStats()
+{
+    if (!active || stats)
+        return;
+
+    stats = new ProfileStats;
+
+    // One bucket per object plus one for unattributed events
+    const unsigned num_objs = SimObject::simObjectList.size() + 1;
+    for (unsigned i = 0; i < num_objs - 1; ++i)
+        objIndices[SimObject::simObjectList[i]->name()] = i;
+
+    stats->objCycles
+        .init(num_objs)
+        .name("host_profile.obj_cycles")
+        .desc("Host cycles spent processing the events of each object")
+        .flags(Stats::nozero)
+        ;
+
+    stats->objEvents
+        .init(num_objs)
+        .name("host_profile.obj_events")
+        .desc("Number of events processed for each object")
+        .flags(Stats::nozero)
+        ;
+
+    for (auto &obj : objIndices) {
+        stats->objCycles.subname(obj.second, statName(obj.first));
+        stats->objEvents.subname(obj.second, statName(obj.first));
+    }
+    stats->objCycles.subname(num_objs - 1, unattributed);
+    stats->objEvents.subname(num_objs - 1, unattributed);
+
+    stats->descCycles
+        .init(maxDescs + 1)
+        .name("host_profile.event_cycles")
+        .desc("Host cycles spent processing each type of event")
+        .flags(Stats::nozero)
+        ;
+
+    stats->descEvents
+        .init(maxDescs + 1)
+        .name("host_profile.event_count")
+        .desc("Number of events processed of each type")
+        .flags(Stats::nozero)
+        ;
+
+    for (auto &d : descIndices) {
+        if (d.second < maxDescs) {
+            stats->descCycles.subname(d.second, statName(d.first));
+            stats->descEvents.subname(d.second, statName(d.first));
+        }
+    }
+    stats->descCycles.subname(maxDescs, "other");
+    stats->descEvents.subname(maxDescs, "other");
+
+    stats->cycleTime
+        .functor(secondsPerCycle)
+        .name("host_profile.cycle_time")
+        .desc("Host seconds per profiler cycle")
+        .precision(12)
+        ;
+
+    stats->objSeconds
+        .name("host_profile.obj_seconds")
+        .desc("Host seconds spent processing the events of each object")
+        .flags(Stats::nozero)
+        .precision(6)
+        ;
+    stats->objSeconds = stats->objCycles * stats->cycleTime;
+
+    stats->descSeconds
+        .name("host_profile.event_seconds")
+        .desc("Host seconds spent processing each type of event")
+        .flags(Stats::nozero)
+        .precision(6)
+        ;
+    stats->descSeconds = stats->descCycles * stats->cycleTime;
+}
+
+void
+HostProfiler::dumpFolded()
+{
+    if (!active)
+        return;
+
+    // Aggregate sites with the same owner and sanitized description,
+    // and sort them so that the output is stable between runs
+    std::map<std::string, uint64_t> stacks;
+    for (auto &s : sites) {
+        const Site *site = s.second;
+        std::string stack(site->owner);
+        std::replace(stack.begin(), stack.end(), '.', ';');
+
+        std::string desc(site->desc);
+        std::replace(desc.begin(), desc.end(), ';', ':');
+        stacks[stack + ";" + desc] += site->cycles;
+    }
+
+    OutputStream *os = simout.create(foldedName);
+    for (auto &s : stacks) {
+        if (s.second)
+            *os->stream() << s.first << " " << s.second << "\n";
+    }
+    simout.close(os);
+}
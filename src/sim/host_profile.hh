@@ -0,0 +1,160 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SIM_HOST_PROFILE_HH__
+#define __SIM_HOST_PROFILE_HH__
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "base/statistics.hh"
+
+class Event;
+class SimObject;
+
+/**
+ * Host time accounting for the simulator itself. When enabled,
+ * EventQueue::serviceOne() reads the host cycle counter around every
+ * event it processes and attributes the cycles to the SimObject that
+ * owns the event and to the event's description().
+ *
+ * The owner is found from the event name, which by convention is the
+ * name of the owning object followed by the name of the event. Events
+ * without such a name are accounted to an "unattributed" bucket. The
+ * (owner, description) pair of an event is resolved the first time it
+ * is serviced and cached per event object, so the cost in steady state
+ * is two cycle counter reads and a hash lookup per event.
+ *
+ * The results are available as stats under host_profile and as a
+ * folded stack file (one "obj;child;description cycles" line per
+ * site) that can be fed to flamegraph.pl.
+ */
+class HostProfiler
+{
+  public:
+    /** Accounting for one (owner, description) pair */
+    struct Site
+    {
+        std::string owner;
+        const char *desc;
+        /** Index into the per-object stats */
+        unsigned objIndex;
+        /** Index into the per-description stats */
+        unsigned descIndex;
+        /** Totals since enable(), not affected by stat resets */
+        uint64_t cycles;
+        uint64_t count;
+    };
+
+    /** Set while profiling, checked before any other call */
+    static bool active;
+
+    /** Start profiling, the folded stacks are written to fname at exit */
+    static void enable(const std::string &fname);
+
+    /** Host cycle counter, falls back to nanoseconds */
+    static uint64_t
+    now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+     * Find the accounting site of an event. This must be called before
+     * the event is processed since processing may delete it.
+     */
+    static Site *site(const Event *event);
+
+    /** Account the host cycles spent processing an event */
+    static void record(Site *site, uint64_t cycles);
+
+    /** Drop the cached site of an event that is being destroyed */
+    static void forget(const Event *event);
+
+    /** Register the host_profile stats, called from Root::regStats() */
+    static void regStats();
+
+    /** Write the folded stacks for flamegraph.pl */
+    static void dumpFolded();
+
+  private:
+    /** Descriptions beyond this are accounted as "other" */
+    static const unsigned maxDescs = 255;
+
+    /** Stats, only allocated while profiling */
+    struct ProfileStats
+    {
+        Stats::Vector objCycles;
+        Stats::Vector objEvents;
+        Stats::Vector descCycles;
+        Stats::Vector descEvents;
+        Stats::Value cycleTime;
+        Stats::Formula objSeconds;
+        Stats::Formula descSeconds;
+    };
+
+    static ProfileStats *stats;
+
+    static std::string foldedName;
+
+    /** Sites of the events serviced so far */
+    static std::unordered_map<const Event *, Site *> eventSites;
+    /** Sites keyed by event name and description */
+    static std::unordered_map<std::string, Site *> namedSites;
+    /** Sites keyed by owner and description */
+    static std::unordered_map<std::string, Site *> sites;
+    static std::unordered_map<const char *, unsigned> descIndices;
+    /** Number of distinct descriptions seen */
+    static unsigned numDescs;
+    static std::unordered_map<std::string, unsigned> objIndices;
+
+    /** Only taken when there are several event queues */
+    static std::mutex lock;
+
+    /** Cycle counter and wall clock when profiling started */
+    static uint64_t startCycles;
+    static std::chrono::steady_clock::time_point startTime;
+
+    /** Host seconds per cycle counter tick since enable() */
+    static double secondsPerCycle();
+
+    static Site *newSite(const Event *event);
+    static unsigned descIndex(const char *desc);
+};
+
+#endif // __SIM_HOST_PROFILE_HH__
@@ -165,6 +165,81 @@ MathExpr::eval(const Node *n, EvalCallback fn) const {
     return 0;
 }
 
+void
+MathExpr::compile(ResolveCallback fn) {
+    code.clear();
+    stack.resize(compile(root, fn));
+}
+
+unsigned
+MathExpr::compile(const Node *n, ResolveCallback &fn) {
+    switch (n->op) {
+      case sValue:
+        code.push_back(Instr {sValue, n->value, 0});
+        return 1;
+      case sVariable:
+        code.push_back(Instr {sVariable, 0, fn(n->variable)});
+        return 1;
+      case uNeg: {
+        const unsigned depth = compile(n->r, fn);
+        code.push_back(Instr {uNeg, 0, 0});
+        return depth;
+      }
+      case nInvalid:
+        panic("Invalid node!\n");
+      default: {
+        // The left operand stays on the stack while the right one is
+        // evaluated
+        const unsigned l_depth = compile(n->l, fn);
+        const unsigned r_depth = compile(n->r, fn);
+        code.push_back(Instr {n->op, 0, 0});
+        return std::max(l_depth, r_depth + 1);
+      }
+    }
+}
+
+double
+MathExpr::evalCompiled(const double *vars) const {
+    double *sp = stack.data();
+    for (const auto &i : code) {
+        switch (i.op) {
+          case sValue:
+            *sp++ = i.value;
+            break;
+          case sVariable:
+            *sp++ = vars[i.var];
+            break;
+          case uNeg:
+            sp[-1] = -sp[-1];
+            break;
+          case bAdd:
+            --sp;
+            sp[-1] += sp[0];
+            break;
+          case bSub:
+            --sp;
+            sp[-1] -= sp[0];
+            break;
+          case bMul:
+            --sp;
+            sp[-1] *= sp[0];
+            break;
+          case bDiv:
+            --sp;
+            sp[-1] /= sp[0];
+            break;
+          case bPow:
+            --sp;
+            sp[-1] = std::pow(sp[-1], sp[0]);
+            break;
+          default:
+            panic("Invalid instruction!\n");
+        }
+    }
+
+    return stack[0];
+}
+
 std::string
 MathExpr::toStr(Node *n, std::string prefix) const {
     std::string ret;
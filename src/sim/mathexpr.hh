@@ -44,6 +44,7 @@
 #include <array>
 #include <functional>
 #include <string>
+#include <vector>
 
 class MathExpr {
   public:
@@ -68,6 +69,29 @@ class MathExpr {
      */
     double eval(EvalCallback fn) const { return eval(root, fn); }
 
+    typedef std::function<unsigned(std::string)> ResolveCallback;
+
+    /**
+     * Compiles the expression tree into postfix code for evalCompiled()
+     *
+     * @param fn A callback function mapping each variable to its index
+     *           in the value array passed to evalCompiled(), it is called
+     *           once per variable occurrence
+     */
+    void compile(ResolveCallback fn);
+
+    /**
+     * Evaluates the compiled expression without any allocation
+     *
+     * @param vars Values of the variables, indexed as resolved by compile()
+     *
+     * @return The value for this expression
+     */
+    double evalCompiled(const double *vars) const;
+
+    /** Has the expression been compiled? */
+    bool compiled() const { return !code.empty(); }
+
   private:
     enum Operator {
         bAdd, bSub, bMul, bDiv, bPow, uNeg, sValue, sVariable, nInvalid
@@ -121,6 +145,23 @@ class MathExpr {
 
     /** Eval a node */
     double eval(const Node *n, EvalCallback fn) const;
+
+    /** Postfix code instruction */
+    struct Instr {
+        Operator op;
+        /** Constant for sValue, variable index for sVariable */
+        double value;
+        unsigned var;
+    };
+
+    /** Emit the code of a node, returns the stack depth it needs */
+    unsigned compile(const Node *n, ResolveCallback &fn);
+
+    /** Compiled expression */
+    std::vector<Instr> code;
+
+    /** Evaluation stack of the compiled expression */
+    mutable std::vector<double> stack;
 };
 
 #endif
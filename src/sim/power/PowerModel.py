@@ -59,3 +59,6 @@ class PowerModel(SimObject):
     # Need a reference to the system so we can query the thermal domain
     # about temperature (temperature is needed for leakage calculation)
     subsystem = Param.SubSystem(Parent.any, "subsystem")
+
+    # Power is sampled at this period and integrated into the energy stats
+    energy_period = Param.Latency('1us', "Energy integration period")
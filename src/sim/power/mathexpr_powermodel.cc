@@ -65,6 +65,68 @@ MathExprPowerModel::startup()
     for (auto & i: Stats::statsList())
         if (i->name.find(basename) == 0)
             stats_map[i->name.substr(basename.size())] = i;
+
+    // Compile the expressions so that evaluating them does not need any
+    // name lookup
+    auto resolve_fn = std::bind(&MathExprPowerModel::resolve, this,
+                                std::placeholders::_1);
+    dyn_expr.compile(resolve_fn);
+    st_expr.compile(resolve_fn);
+    values.resize(vars.size());
+}
+
+unsigned
+MathExprPowerModel::resolve(const std::string &name)
+{
+    using namespace Stats;
+
+    auto it = var_index.find(name);
+    if (it != var_index.end())
+        return it->second;
+
+    Variable var {Variable::Temp, NULL, NULL};
+    if (name != "temp") {
+        auto info = stats_map.find(name);
+        if (info == stats_map.end())
+            fatal("%s: Unknown stat %s in power expression\n", this->name(),
+                  name);
+
+        // Only these stat types are supported right now
+        if ((var.scalar = dynamic_cast<ScalarInfo*>(info->second)))
+            var.kind = Variable::Scalar;
+        else if ((var.formula = dynamic_cast<FormulaInfo*>(info->second)))
+            var.kind = Variable::Formula;
+        else
+            panic("Unknown stat type!\n");
+    }
+
+    vars.push_back(var);
+    var_index[name] = vars.size() - 1;
+    return vars.size() - 1;
+}
+
+double
+MathExprPowerModel::eval(const MathExpr &expr) const
+{
+    if (!expr.compiled())
+        return expr.eval(std::bind(&MathExprPowerModel::getStatValue,
+                                   this, std::placeholders::_1));
+
+    for (unsigned i = 0; i < vars.size(); i++) {
+        switch (vars[i].kind) {
+          case Variable::Temp:
+            values[i] = _temp;
+            break;
+          case Variable::Scalar:
+            values[i] = vars[i].scalar->value();
+            break;
+          case Variable::Formula:
+            values[i] = vars[i].formula->total();
+            break;
+        }
+    }
+
+    return expr.evalCompiled(values.data());
 }
 
 double
@@ -64,24 +64,14 @@ class MathExprPowerModel : public PowerModelState
      *
      * @return Power (Watts) consumed by this object (dynamic component)
      */
-    double getDynamicPower() const {
-        return dyn_expr.eval(
-            std::bind(&MathExprPowerModel::getStatValue,
-                this, std::placeholders::_1)
-        );
-    }
+    double getDynamicPower() const { return eval(dyn_expr); }
 
     /**
      * Get the static power consumption.
      *
      * @return Power (Watts) consumed by this object (static component)
      */
-    double getStaticPower() const {
-        return st_expr.eval(
-            std::bind(&MathExprPowerModel::getStatValue,
-                this, std::placeholders::_1)
-        );
-    }
+    double getStaticPower() const { return eval(st_expr); }
 
     /**
      * Get the value for a variable (maps to a stat)
@@ -98,9 +88,31 @@ class MathExprPowerModel : public PowerModelState
 
   private:
 
+    /**
+     * Evaluate one of the expressions, using the compiled code once the
+     * stats have been resolved at startup
+     */
+    double eval(const MathExpr &expr) const;
+
+    /** Resolve a variable to an index in vars, used to compile */
+    unsigned resolve(const std::string &name);
+
+    /** A variable of the expressions, resolved to its source */
+    struct Variable {
+        enum Kind { Temp, Scalar, Formula };
+        Kind kind;
+        const Stats::ScalarInfo *scalar;
+        const Stats::FormulaInfo *formula;
+    };
+
     // Math expressions for dynamic and static power
     MathExpr dyn_expr, st_expr;
 
+    // Variables of both expressions and their current values
+    std::vector<Variable> vars;
+    mutable std::vector<double> values;
+    std::unordered_map<std::string, unsigned> var_index;
+
     // Basename of the object in the gem5 stats hierachy
     std::string basename;
 
@@ -39,9 +39,11 @@
 
 #include "sim/power/power_model.hh"
 
+#include "base/callback.hh"
 #include "base/statistics.hh"
 #include "params/PowerModel.hh"
 #include "params/PowerModelState.hh"
+#include "sim/core.hh"
 #include "sim/sim_object.hh"
 #include "sim/sub_system.hh"
 
@@ -51,14 +53,101 @@ PowerModelState::PowerModelState(const Params *p)
 }
 
 PowerModel::PowerModel(const Params *p)
-    : SimObject(p), states_pm(p->pm), subsystem(p->subsystem),
-      clocked_object(NULL)
+    : SimObject(p), energyEvent(this), energyPeriod(p->energy_period),
+      dynEnergy(0), stEnergy(0), lastEnergyUpdate(0), states_pm(p->pm),
+      subsystem(p->subsystem), clocked_object(NULL)
 {
     panic_if(subsystem == NULL,
              "Subsystem is NULL! This is not acceptable for a PowerModel!\n");
+    panic_if(energyPeriod == 0, "%s: the energy period can't be 0\n",
+             name());
     subsystem->registerPowerProducer(this);
 }
 
+void
+PowerModel::regStats()
+{
+    SimObject::regStats();
+
+    dynamicPower
+      .method(this, &PowerModel::getDynamicPower)
+      .name(params()->name + ".dynamic_power")
+      .desc("Dynamic power for this power state")
+    ;
+
+    staticPower
+      .method(this, &PowerModel::getStaticPower)
+      .name(params()->name + ".static_power")
+      .desc("Static power for this power state")
+    ;
+
+    dynamicEnergy
+      .method(this, &PowerModel::getDynamicEnergy)
+      .name(params()->name + ".dynamic_energy")
+      .desc("Dynamic energy since the last stats reset (Joules)")
+    ;
+
+    staticEnergy
+      .method(this, &PowerModel::getStaticEnergy)
+      .name(params()->name + ".static_energy")
+      .desc("Static energy since the last stats reset (Joules)")
+    ;
+
+    Stats::registerResetCallback(
+        new MakeCallback<PowerModel, &PowerModel::resetEnergy>(this));
+}
+
+void
+PowerModel::startup()
+{
+    // A model that belongs to no object has no power to integrate
+    lastEnergyUpdate = curTick();
+    if (clocked_object)
+        schedule(energyEvent, curTick() + energyPeriod);
+}
+
+void
+PowerModel::updateEnergy()
+{
+    double dyn, st;
+    getPower(dyn, st);
+
+    const double seconds =
+        double(curTick() - lastEnergyUpdate) / SimClock::Frequency;
+    dynEnergy += dyn * seconds;
+    stEnergy += st * seconds;
+    lastEnergyUpdate = curTick();
+
+    schedule(energyEvent, curTick() + energyPeriod);
+}
+
+void
+PowerModel::resetEnergy()
+{
+    dynEnergy = 0;
+    stEnergy = 0;
+    lastEnergyUpdate = curTick();
+}
+
+double
+PowerModel::getDynamicEnergy() const
+{
+    // Include the part of the current period that has passed
+    if (!clocked_object)
+        return 0;
+    return dynEnergy + getDynamicPower() *
+        double(curTick() - lastEnergyUpdate) / SimClock::Frequency;
+}
+
+double
+PowerModel::getStaticEnergy() const
+{
+    if (!clocked_object)
+        return 0;
+    return stEnergy + getStaticPower() *
+        double(curTick() - lastEnergyUpdate) / SimClock::Frequency;
+}
+
 void
 PowerModel::setClockedObject(ClockedObject * clkobj)
 {
@@ -136,3 +225,27 @@ PowerModel::getStaticPower() const
 
     return power;
 }
+
+void
+PowerModel::getPower(double &dyn, double &st) const
+{
+    assert(clocked_object);
+
+    std::vector<double> w = clocked_object->pwrStateWeights();
+
+    // Same number of states (excluding UNDEFINED)
+    assert(w.size() - 1 == states_pm.size());
+
+    // Make sure we have no UNDEFINED state
+    warn_if(w[Enums::PwrState::UNDEFINED] > 0,
+        "SimObject in UNDEFINED power state! Power figures might be wrong!\n");
+
+    dyn = 0;
+    st = 0;
+    for (unsigned i = 0; i < states_pm.size(); i++) {
+        if (w[i + 1] > 0.0f) {
+            dyn += states_pm[i]->getDynamicPower() * w[i + 1];
+            st += states_pm[i]->getStaticPower() * w[i + 1];
+        }
+    }
+}
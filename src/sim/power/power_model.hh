@@ -132,19 +132,27 @@ class PowerModel : public SimObject
      */
     double getStaticPower() const;
 
-    void regStats() {
-        dynamicPower
-          .method(this, &PowerModel::getDynamicPower)
-          .name(params()->name + ".dynamic_power")
-          .desc("Dynamic power for this power state")
-        ;
+    /**
+     * Get both power components at once, the power state weights are
+     * only computed once.
+     *
+     * @param dyn Dynamic power (Watts)
+     * @param st Static power (Watts)
+     */
+    void getPower(double &dyn, double &st) const;
 
-        staticPower
-          .method(this, &PowerModel::getStaticPower)
-          .name(params()->name + ".static_power")
-          .desc("Static power for this power state")
-        ;
-    }
+    /**
+     * Energy since the last stats reset, the power sampled every energy
+     * period integrated over time.
+     *
+     * @return Energy (Joules) consumed by this object
+     */
+    double getDynamicEnergy() const;
+    double getStaticEnergy() const;
+
+    void regStats() override;
+
+    void startup() override;
 
     void setClockedObject(ClockedObject *clkobj);
 
@@ -171,6 +179,18 @@ class PowerModel : public SimObject
     };
 
     Stats::Value dynamicPower, staticPower;
+    Stats::Value dynamicEnergy, staticEnergy;
+
+    /** Sample the power and add the energy since the last update */
+    void updateEnergy();
+    EventWrapper<PowerModel, &PowerModel::updateEnergy> energyEvent;
+    /** Restart the energy integration on a stats reset */
+    void resetEnergy();
+
+    const Tick energyPeriod;
+    /** Integrated energy (Joules) up to lastEnergyUpdate */
+    double dynEnergy, stEnergy;
+    Tick lastEnergyUpdate;
 
     /** Actual power models (one per power state) */
     std::vector<PowerModelState*> states_pm;
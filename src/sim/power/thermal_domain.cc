@@ -110,7 +110,7 @@ LinearEquation
 ThermalDomain::getEquation(ThermalNode * tn, unsigned n, double step) const
 {
     LinearEquation eq(n);
-    double power = subsystem->getDynamicPower() + subsystem->getStaticPower();
+    double power = subsystem->getPower();
     if (tn == node)
         eq[eq.cnt()] = power;
     return eq;
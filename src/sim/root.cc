@@ -36,6 +36,7 @@
 #include "config/the_isa.hh"
 #include "debug/TimeSync.hh"
 #include "sim/full_system.hh"
+#include "sim/host_profile.hh"
 #include "sim/root.hh"
 
 Root *Root::_root = NULL;
@@ -114,6 +115,17 @@ Root::Root(RootParams *p) : SimObject(p), _enabled(false),
     lastTime.setTimer();
 
     simQuantum = p->sim_quantum;
+
+    if (p->host_profile)
+        HostProfiler::enable(p->host_profile_file);
+}
+
+void
+Root::regStats()
+{
+    SimObject::regStats();
+
+    HostProfiler::regStats();
 }
 
 void
@@ -112,6 +112,9 @@ class Root : public SimObject
      */
     void initState() override;
 
+    /** Register the host profiler stats, if profiling is enabled */
+    void regStats() override;
+
     void serialize(CheckpointOut &cp) const override;
     void unserialize(CheckpointIn &cp) override;
 };
@@ -45,14 +45,23 @@
  *          Andreas Sandberg
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cctype>
 #include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <list>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "base/framebuffer.hh"
@@ -168,6 +177,113 @@ int Serializable::ckptCount = 0;
 int Serializable::ckptPrevCount = -1;
 std::stack<std::string> Serializable::path;
 
+//
+// Large arrays of numbers are stored in the binary side file.  The
+// type code (as in Python's struct module) lets tools decode them and
+// catches restoring into an array of another type.
+//
+template <class T>
+struct BinaryArray
+{
+    static const bool value = std::is_arithmetic<T>::value &&
+        !std::is_same<T, bool>::value;
+
+    static char
+    typeCode()
+    {
+        static const char codes[] = "bhiq";
+        int log_size = (sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 :
+                        sizeof(T) == 4 ? 2 : 3);
+
+        if (std::is_floating_point<T>::value)
+            return sizeof(T) == 4 ? 'f' : 'd';
+        else if (std::is_signed<T>::value)
+            return codes[log_size];
+        else
+            return toupper(codes[log_size]);
+    }
+};
+
+static const char binaryMagic[8] = {
+    'M', '5', 'C', 'P', 'T', 'B', 'I', 'N'
+};
+static const uint32_t binaryByteOrder = 0x01020304;
+
+template <class T>
+typename std::enable_if<BinaryArray<T>::value, bool>::type
+binaryArrayOut(CheckpointOut &os, const string &name,
+               const T *param, size_t size)
+{
+    uint64_t offset;
+
+    if (size < CheckpointIn::binaryArrayMin ||
+        !CheckpointIn::binaryOut(param, size * sizeof(T), offset))
+    {
+        return false;
+    }
+
+    os << name << "=@bin " << offset << " " << size << " "
+       << BinaryArray<T>::typeCode() << "\n";
+    return true;
+}
+
+template <class T>
+typename std::enable_if<!BinaryArray<T>::value, bool>::type
+binaryArrayOut(CheckpointOut &os, const string &name,
+               const T *param, size_t size)
+{
+    return false;
+}
+
+template <class T>
+typename std::enable_if<BinaryArray<T>::value, bool>::type
+binaryArrayOut(CheckpointOut &os, const string &name,
+               const vector<T> &param)
+{
+    return binaryArrayOut(os, name, param.data(), param.size());
+}
+
+template <class T>
+typename std::enable_if<!BinaryArray<T>::value, bool>::type
+binaryArrayOut(CheckpointOut &os, const string &name,
+               const vector<T> &param)
+{
+    return false;
+}
+
+// If str refers to an array in the binary side file, return its data
+// and number of elements.  Returns NULL for text arrays.
+template <class T>
+const T *
+binaryArrayIn(CheckpointIn &cp, const string &section, const string &name,
+              const string &str, size_t &count)
+{
+    if (!BinaryArray<T>::value || str.compare(0, 5, "@bin ") != 0)
+        return NULL;
+
+    uint64_t offset, size;
+    char type;
+    if (sscanf(str.c_str(), "@bin %" SCNu64 " %" SCNu64 " %c",
+               &offset, &size, &type) != 3) {
+        fatal("Can't parse binary array reference '%s:%s'\n",
+              section, name);
+    }
+
+    if (type != BinaryArray<T>::typeCode()) {
+        fatal("Binary array '%s:%s' has type %c, expected %c\n",
+              section, name, type, BinaryArray<T>::typeCode());
+    }
+
+    const T *data = (const T *)cp.binaryIn(offset, size * sizeof(T));
+    if (!data) {
+        fatal("Binary array '%s:%s' isn't in %s%s\n", section, name,
+              cp.cptDir, CheckpointIn::binFilename);
+    }
+
+    count = size;
+    return data;
+}
+
 template <class T>
 void
 paramOut(CheckpointOut &os, const string &name, const T &param)
@@ -181,6 +297,9 @@ template <class T>
 void
 arrayParamOut(CheckpointOut &os, const string &name, const vector<T> &param)
 {
+    if (binaryArrayOut(os, name, param))
+        return;
+
     typename vector<T>::size_type size = param.size();
     os << name << "=";
     if (size > 0)
@@ -259,6 +378,9 @@ void
 arrayParamOut(CheckpointOut &os, const string &name,
               const T *param, unsigned size)
 {
+    if (binaryArrayOut(os, name, param, size))
+        return;
+
     os << name << "=";
     if (size > 0)
         showParam(os, param[0]);
@@ -280,6 +402,14 @@ arrayParamIn(CheckpointIn &cp, const string &name, T *param, unsigned size)
         fatal("Can't unserialize '%s:%s'\n", section, name);
     }
 
+    size_t count;
+    if (const T *data = binaryArrayIn<T>(cp, section, name, str, count)) {
+        if (count != size)
+            fatal("Array size mismatch on %s:%s'\n", section, name);
+        std::copy(data, data + size, param);
+        return;
+    }
+
     // code below stolen from VectorParam<T>::parse().
     // it would be nice to unify these somehow...
 
@@ -324,6 +454,12 @@ arrayParamIn(CheckpointIn &cp, const string &name, vector<T> &param)
         fatal("Can't unserialize '%s:%s'\n", section, name);
     }
 
+    size_t count;
+    if (const T *data = binaryArrayIn<T>(cp, section, name, str, count)) {
+        param.assign(data, data + count);
+        return;
+    }
+
     // code below stolen from VectorParam<T>::parse().
     // it would be nice to unify these somehow...
 
@@ -601,9 +737,13 @@ Serializable::serializeAll(const string &cpt_dir)
         fatal("Unable to open file %s for writing\n", cpt_file.c_str());
     outstream << "## checkpoint generated: " << ctime(&t);
 
+    CheckpointIn::openBinaryOut();
+
     globals.serializeSection(outstream, "Globals");
 
     SimObject::serializeAll(outstream);
+
+    CheckpointIn::closeBinaryOut();
 }
 
 void
@@ -656,8 +796,12 @@ Serializable::currentSection()
 }
 
 const char *CheckpointIn::baseFilename = "m5.cpt";
+const char *CheckpointIn::binFilename = "m5.cpt.bin";
+const unsigned CheckpointIn::binaryArrayMin;
 
 string CheckpointIn::currentDirectory;
+ofstream *CheckpointIn::binOut = NULL;
+uint64_t CheckpointIn::binOutSize = 0;
 
 string
 CheckpointIn::setDir(const string &name)
@@ -677,18 +821,104 @@ CheckpointIn::dir()
     return currentDirectory;
 }
 
+void
+CheckpointIn::openBinaryOut()
+{
+    string bin_file = currentDirectory + binFilename;
+
+    binOut = new ofstream(bin_file.c_str(), ios::binary);
+    if (!binOut->is_open())
+        fatal("Unable to open file %s for writing\n", bin_file);
+
+    binOut->write(binaryMagic, sizeof(binaryMagic));
+    binOut->write((const char *)&binaryByteOrder, sizeof(binaryByteOrder));
+    binOutSize = sizeof(binaryMagic) + sizeof(binaryByteOrder);
+}
+
+void
+CheckpointIn::closeBinaryOut()
+{
+    binOut->close();
+    if (binOut->fail())
+        fatal("Error writing %s%s\n", currentDirectory, binFilename);
+
+    delete binOut;
+    binOut = NULL;
+}
+
+bool
+CheckpointIn::binaryOut(const void *data, size_t bytes, uint64_t &offset)
+{
+    if (!binOut)
+        return false;
+
+    // keep the arrays 8-byte aligned in the mapped file
+    static const char padding[8] = {};
+    size_t pad = -binOutSize & 7;
+    binOut->write(padding, pad);
+
+    offset = binOutSize + pad;
+    binOut->write((const char *)data, bytes);
+    binOutSize = offset + bytes;
+    return true;
+}
+
+const uint8_t *
+CheckpointIn::binaryIn(uint64_t offset, size_t bytes) const
+{
+    if (!binData || offset > binSize || bytes > binSize - offset)
+        return NULL;
+
+    return binData + offset;
+}
+
 
 CheckpointIn::CheckpointIn(const string &cpt_dir, SimObjectResolver &resolver)
-    : db(new IniFile), objNameResolver(resolver), cptDir(setDir(cpt_dir))
+    : db(new IniFile), objNameResolver(resolver),
+      binData(NULL), binSize(0), cptDir(setDir(cpt_dir))
 {
     string filename = cptDir + "/" + CheckpointIn::baseFilename;
     if (!db->load(filename)) {
         fatal("Can't load checkpoint file '%s'\n", filename);
     }
+
+    // Checkpoints with only text arrays have no side file
+    string bin_file = cptDir + "/" + CheckpointIn::binFilename;
+    int fd = open(bin_file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat sb;
+    if (fstat(fd, &sb) < 0 || sb.st_size == 0) {
+        close(fd);
+        return;
+    }
+
+    void *data = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        fatal("Can't map checkpoint file '%s'\n", bin_file);
+
+    binData = (uint8_t *)data;
+    binSize = sb.st_size;
+
+    uint32_t byte_order;
+    if (binSize < sizeof(binaryMagic) + sizeof(byte_order) ||
+        memcmp(binData, binaryMagic, sizeof(binaryMagic)) != 0)
+    {
+        fatal("'%s' isn't a binary checkpoint file\n", bin_file);
+    }
+
+    memcpy(&byte_order, binData + sizeof(binaryMagic), sizeof(byte_order));
+    if (byte_order != binaryByteOrder)
+        fatal("'%s' was written with another byte order\n", bin_file);
 }
 
 CheckpointIn::~CheckpointIn()
 {
+    if (binData)
+        munmap(binData, binSize);
+
     delete db;
 }
 
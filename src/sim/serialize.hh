@@ -347,6 +347,11 @@ class CheckpointIn
 
     SimObjectResolver &objNameResolver;
 
+    /** Memory mapped binary side file (binFilename), NULL if the
+     *  checkpoint has none */
+    uint8_t *binData;
+    size_t binSize;
+
   public:
     CheckpointIn(const std::string &cpt_dir, SimObjectResolver &resolver);
     ~CheckpointIn();
@@ -361,6 +366,16 @@ class CheckpointIn
 
     bool sectionExists(const std::string &section);
 
+    /**
+     * Data of an array in the binary side file.
+     *
+     * @param offset Offset of the array in the side file.
+     * @param bytes Size of the array.
+     * @return Pointer into the mapped side file, NULL if the checkpoint
+     *         has no side file or the array isn't inside it.
+     */
+    const uint8_t *binaryIn(uint64_t offset, size_t bytes) const;
+
     // The following static functions have to do with checkpoint
     // creation rather than restoration.  This class makes a handy
     // namespace for them though.  Currently no Checkpoint object is
@@ -372,6 +387,11 @@ class CheckpointIn
     // current directory we're serializing into.
     static std::string currentDirectory;
 
+    // binary side file of the checkpoint being created, NULL when no
+    // checkpoint is being created, and its size so far.
+    static std::ofstream *binOut;
+    static uint64_t binOutSize;
+
   public:
     // Set the current directory.  This function takes care of
     // inserting curTick() if there's a '%d' in the argument, and
@@ -386,6 +406,23 @@ class CheckpointIn
 
     // Filename for base checkpoint file within directory.
     static const char *baseFilename;
+
+    // Filename for the binary side file within directory.  Arrays of
+    // at least binaryArrayMin numbers are stored there rather than as
+    // text in the base file, which refers to them as
+    // "@bin <offset> <count> <type>".
+    static const char *binFilename;
+    static const unsigned binaryArrayMin = 64;
+
+    // Create the binary side file in the current directory before
+    // serializing, and complete it afterwards.
+    static void openBinaryOut();
+    static void closeBinaryOut();
+
+    // Append an array to the binary side file of the checkpoint being
+    // created.  Returns false, writing nothing, if there is no side
+    // file.
+    static bool binaryOut(const void *data, size_t bytes, uint64_t &offset);
 };
 
 #endif // __SERIALIZE_HH__
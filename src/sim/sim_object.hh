@@ -102,6 +102,9 @@ class SimObject : public EventManager, public Serializable, public Drainable
     /** List of all instantiated simulation objects. */
     static SimObjectList simObjectList;
 
+    /** The host profiler creates per-object stats from the list */
+    friend class HostProfiler;
+
     /** Manager coordinates hooking up probe points with listeners. */
     ProbeManager *probeManager;
 
@@ -69,15 +69,27 @@ namespace Stats {
 
 Time statTime(true);
 Tick startTick;
+Counter startEvents;
 
 GlobalEvent *dumpEvent;
 
+Counter
+totalServicedEvents()
+{
+    Counter total = 0;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        total += mainEventQueue[i]->numServiced();
+
+    return total;
+}
+
 struct SimTicksReset : public Callback
 {
     void process()
     {
         statTime.setTimer();
         startTick = curTick();
+        startEvents = totalServicedEvents();
     }
 };
 
@@ -103,6 +115,12 @@ statFinalTick()
     return curTick();
 }
 
+Counter
+statServicedEvents()
+{
+    return totalServicedEvents() - startEvents;
+}
+
 SimTicksReset simTicksReset;
 
 struct Global
@@ -110,8 +128,10 @@ struct Global
     Stats::Formula hostInstRate;
     Stats::Formula hostOpRate;
     Stats::Formula hostTickRate;
+    Stats::Formula hostEventRate;
     Stats::Value hostMemory;
     Stats::Value hostSeconds;
+    Stats::Value hostEvents;
 
     Stats::Value simInsts;
     Stats::Value simOps;
@@ -195,10 +215,24 @@ Global::Global()
         .precision(0)
         ;
 
+    hostEvents
+        .functor(statServicedEvents)
+        .name("host_events")
+        .desc("Number of events processed by the simulator")
+        .precision(0)
+        ;
+
+    hostEventRate
+        .name("host_event_rate")
+        .desc("Simulator event rate (events/s)")
+        .precision(0)
+        ;
+
     simSeconds = simTicks / simFreq;
     hostInstRate = simInsts / hostSeconds;
     hostOpRate = simOps / hostSeconds;
     hostTickRate = simTicks / hostSeconds;
+    hostEventRate = hostEvents / hostSeconds;
 
     registerResetCallback(&simTicksReset);
 }
@@ -0,0 +1,301 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/stat_sampler.hh"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/callback.hh"
+#include "base/cprintf.hh"
+#include "base/misc.hh"
+#include "sim/sim_exit.hh"
+
+using namespace std;
+
+vector<StatSampler *> StatSampler::samplers;
+
+StatSampler::StatSampler(const StatSamplerParams *p)
+    : SimObject(p), patterns(p->stats), period(p->period),
+      capacity(p->capacity), dumpTicks(p->dump_ticks),
+      outputName(p->output), window(p->window), deltas(p->deltas),
+      dumpAtExit(p->dump_at_exit), start(p->start),
+      head(0), count(0), dumps(0), output(nullptr), markWritten(false),
+      sampleEvent(this), dumpEvent(this, false, Event::Stat_Event_Pri),
+      nextDump(0), markEvent(this, false, Event::Stat_Event_Pri)
+{
+    if (period == 0)
+        fatal("%s: the sampling period can't be 0\n", name());
+    if (capacity == 0)
+        fatal("%s: the capacity can't be 0\n", name());
+    if (capacity < 2 * window + 1) {
+        fatal("%s: a window of %d samples needs a capacity of at least "
+              "%d\n", name(), window, 2 * window + 1);
+    }
+
+    sort(dumpTicks.begin(), dumpTicks.end());
+
+    // Start sampling early enough to cover the window before start
+    start -= min<Tick>(start, window * period);
+
+    samplers.push_back(this);
+    registerExitCallback(
+        new MakeCallback<StatSampler, &StatSampler::exitCallback>(this));
+}
+
+void
+StatSampler::addStat(const Stats::Info *info)
+{
+    Source source;
+    source.scalar = dynamic_cast<const Stats::ScalarInfo *>(info);
+    source.vector = dynamic_cast<const Stats::VectorInfo *>(info);
+    if (source.scalar) {
+        source.size = 1;
+        columns.push_back(info->name);
+    } else if (source.vector) {
+        source.size = source.vector->size();
+        for (Stats::off_type i = 0; i < source.size; ++i) {
+            const vector<string> &subnames = source.vector->subnames;
+            if (i < subnames.size() && !subnames[i].empty())
+                columns.push_back(info->name + "::" + subnames[i]);
+            else
+                columns.push_back(csprintf("%s::%d", info->name, i));
+        }
+    } else {
+        warn("%s: can't sample %s, only scalars, vectors and formulas "
+             "are supported\n", name(), info->name);
+        return;
+    }
+    sources.push_back(source);
+}
+
+void
+StatSampler::resolve()
+{
+    const Stats::NameMapType &names = Stats::nameMap();
+    for (const auto &pattern : patterns) {
+        if (!pattern.empty() && pattern.back() == '*') {
+            string prefix = pattern.substr(0, pattern.size() - 1);
+            auto it = names.lower_bound(prefix);
+            bool found = false;
+            for (; it != names.end() &&
+                     it->first.compare(0, prefix.size(), prefix) == 0;
+                 ++it) {
+                addStat(it->second);
+                found = true;
+            }
+            if (!found)
+                warn("%s: no stat matches %s\n", name(), pattern);
+        } else {
+            auto it = names.find(pattern);
+            if (it == names.end())
+                fatal("%s: unknown stat %s\n", name(), pattern);
+            addStat(it->second);
+        }
+    }
+}
+
+void
+StatSampler::startup()
+{
+    resolve();
+    if (columns.empty()) {
+        warn("%s: no stats to sample\n", name());
+        return;
+    }
+
+    ticks.resize(capacity);
+    values.resize(capacity * columns.size());
+
+    startSampling(max(start, curTick() + 1));
+
+    nextDump = lower_bound(dumpTicks.begin(), dumpTicks.end(), curTick()) -
+        dumpTicks.begin();
+    if (nextDump < dumpTicks.size())
+        schedule(dumpEvent, dumpTicks[nextDump]);
+}
+
+void
+StatSampler::startSampling(Tick from)
+{
+    // Align the samples to multiples of the period so that the rows of
+    // different runs of the same workload line up
+    schedule(sampleEvent, (from + period - 1) / period * period);
+}
+
+bool
+StatSampler::done() const
+{
+    // A sampler that only writes mark windows has nothing left to write
+    // once the windows of all marks so far are written, until the next
+    // mark. Nothing is known about marks to come before the first one.
+    return window && !dumpAtExit && markWritten && marks.empty() &&
+        nextDump >= dumpTicks.size();
+}
+
+void
+StatSampler::sample()
+{
+    ticks[head] = curTick();
+    Stats::Result *row = &values[head * columns.size()];
+    for (const auto &source : sources) {
+        if (source.scalar) {
+            *row++ = source.scalar->result();
+            continue;
+        }
+
+        // A formula may yield fewer elements than it had at startup
+        const Stats::VResult &result = source.vector->result();
+        Stats::size_type n = min<Stats::size_type>(source.size,
+                                                   result.size());
+        row = copy(result.begin(), result.begin() + n, row);
+        row = fill_n(row, source.size - n, NAN);
+    }
+
+    head = (head + 1) % capacity;
+    if (count < capacity)
+        ++count;
+
+    if (!done())
+        schedule(sampleEvent, curTick() + period);
+}
+
+void
+StatSampler::triggerDump()
+{
+    dumpSamples();
+
+    // Several dump ticks can be the same
+    while (nextDump < dumpTicks.size() && dumpTicks[nextDump] <= curTick())
+        ++nextDump;
+    if (nextDump < dumpTicks.size())
+        schedule(dumpEvent, dumpTicks[nextDump]);
+}
+
+void
+StatSampler::mark(const string &what)
+{
+    for (auto sampler : samplers) {
+        if (!sampler->window || sampler->columns.empty())
+            continue;
+
+        sampler->marks.emplace_back(what, curTick());
+        // Sampling stopped after the previous window, only the samples
+        // from here on are written for this mark
+        if (!sampler->sampleEvent.scheduled())
+            sampler->startSampling(curTick() + 1);
+        if (!sampler->markEvent.scheduled()) {
+            sampler->schedule(sampler->markEvent,
+                              curTick() + sampler->window * sampler->period);
+        }
+    }
+}
+
+void
+StatSampler::dumpMark()
+{
+    const Tick span = window * period;
+    const string what = marks.front().first;
+    const Tick when = marks.front().second;
+    marks.pop_front();
+
+    writeSamples(csprintf("%s at tick %d", what, when),
+                 when - min(when, span), when + span);
+    markWritten = true;
+
+    if (!marks.empty())
+        schedule(markEvent, max(curTick(), marks.front().second + span));
+}
+
+void
+StatSampler::dumpSamples()
+{
+    writeSamples(csprintf("dump %d at tick %d", dumps++, curTick()),
+                 0, MaxTick);
+}
+
+void
+StatSampler::exitCallback()
+{
+    // Marks too close to the end to have their whole window sampled
+    while (!marks.empty()) {
+        const Tick span = window * period;
+        const Tick when = marks.front().second;
+        writeSamples(csprintf("%s at tick %d", marks.front().first, when),
+                     when - min(when, span), MaxTick);
+        marks.pop_front();
+    }
+
+    if (dumpAtExit)
+        dumpSamples();
+}
+
+void
+StatSampler::writeSamples(const string &title, Tick from, Tick to)
+{
+    if (columns.empty())
+        return;
+
+    if (!output) {
+        output = simout.create(outputName);
+        ostream &os = *output->stream();
+        ccprintf(os, "# %s: %d stats every %d ticks%s\n", name(),
+                 columns.size(), period,
+                 deltas ? ", changes since the previous row" : "");
+        os << "tick";
+        for (const auto &column : columns)
+            os << " " << column;
+        os << "\n";
+    }
+
+    ostream &os = *output->stream();
+    ccprintf(os, "# %s\n", title);
+
+    const size_t width = columns.size();
+    const Stats::Result *prev = nullptr;
+
+    // Oldest sample first
+    unsigned slot = (head + capacity - count) % capacity;
+    for (unsigned i = 0; i < count; ++i, slot = (slot + 1) % capacity) {
+        if (ticks[slot] < from || ticks[slot] > to)
+            continue;
+
+        const Stats::Result *row = &values[slot * width];
+        os << ticks[slot];
+        for (size_t c = 0; c < width; ++c)
+            ccprintf(os, " %.12g", prev ? row[c] - prev[c] : row[c]);
+        os << "\n";
+
+        if (deltas)
+            prev = row;
+    }
+    os.flush();
+}
+
+StatSampler *
+StatSamplerParams::create()
+{
+    return new StatSampler(this);
+}
@@ -0,0 +1,155 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SIM_STAT_SAMPLER_HH__
+#define __SIM_STAT_SAMPLER_HH__
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/statistics.hh"
+#include "params/StatSampler.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+/**
+ * Time series of a few selected stats. Every period the current values
+ * of the stats are copied into a ring buffer that holds the last
+ * capacity samples, and the buffer is written as one table row per
+ * sample at the configured dump ticks, on request, and at exit.
+ *
+ * Unlike periodic stats dumps this neither walks the whole stats tree
+ * nor resets the stats, so it is cheap enough to sample every few
+ * thousand cycles, e.g. to get the IPC and miss rate curves around a
+ * fault injection. Stats are sampled as they are, so counters are
+ * cumulative and formulas like IPC are averages since the last reset;
+ * per interval rates are the difference of consecutive rows, which the
+ * sampler can write instead of the values.
+ *
+ * Code can mark events of interest, e.g. a fault injection, with
+ * mark(). A sampler with a window then writes the window samples
+ * before and after each mark once they have been taken. If it has
+ * nothing else to write (no dump ticks left, no dump at exit), it stops
+ * sampling after that until the next mark, whose window then lacks the
+ * samples before it.
+ */
+class StatSampler : public SimObject
+{
+  public:
+    StatSampler(const StatSamplerParams *p);
+
+    void startup() override;
+
+    /** Write the samples currently in the ring buffer */
+    void dumpSamples();
+
+    /**
+     * Mark an event of interest at the current tick, every sampler with
+     * a window dumps the samples around it.
+     * @param what Name of the event in the dump.
+     */
+    static void mark(const std::string &what);
+
+  private:
+    /** A sampled stat, scalars fill one column and vectors size ones */
+    struct Source
+    {
+        const Stats::ScalarInfo *scalar;
+        const Stats::VectorInfo *vector;
+        Stats::size_type size;
+    };
+
+    /** Stat names and prefixes (ending in '*') to sample */
+    const std::vector<std::string> patterns;
+    const Tick period;
+    const unsigned capacity;
+    /** Dump ticks in increasing order */
+    std::vector<Tick> dumpTicks;
+    const std::string outputName;
+    /** Samples dumped before and after a mark */
+    const unsigned window;
+    /** Write the change since the previous row instead of the values */
+    const bool deltas;
+    const bool dumpAtExit;
+    /** Tick of the first sample */
+    Tick start;
+
+    std::vector<Source> sources;
+    std::vector<std::string> columns;
+
+    /** Ticks of the samples, capacity entries */
+    std::vector<Tick> ticks;
+    /** Sample values, one row of columns.size() values per tick */
+    std::vector<Stats::Result> values;
+    /** Slot of the next sample */
+    unsigned head;
+    /** Number of valid samples */
+    unsigned count;
+    /** Number of dumps written so far */
+    unsigned dumps;
+
+    OutputStream *output;
+
+    /** All samplers, for mark() */
+    static std::vector<StatSampler *> samplers;
+
+    /** Marks waiting for their window to be sampled, oldest first */
+    std::deque<std::pair<std::string, Tick>> marks;
+    /** The window of a mark was written */
+    bool markWritten;
+
+    /** Find the sampled stats, called once all stats are registered */
+    void resolve();
+    void addStat(const Stats::Info *info);
+
+    /** Write the samples with ticks in [from, to] */
+    void writeSamples(const std::string &title, Tick from, Tick to);
+
+    /** Write the pending marks and, if asked to, all samples */
+    void exitCallback();
+
+    /** Schedule the first sample at or after from */
+    void startSampling(Tick from);
+    /** Nothing is left to sample for, stop until the next mark */
+    bool done() const;
+
+    void sample();
+    EventWrapper<StatSampler, &StatSampler::sample> sampleEvent;
+
+    /** Dump at the next dump tick and schedule the one after it */
+    void triggerDump();
+    EventWrapper<StatSampler, &StatSampler::triggerDump> dumpEvent;
+    /** Index of the next dump tick */
+    unsigned nextDump;
+
+    /** Dump the window of the oldest mark */
+    void dumpMark();
+    EventWrapper<StatSampler, &StatSampler::dumpMark> markEvent;
+};
+
+#endif // __SIM_STAT_SAMPLER_HH__
@@ -70,6 +70,18 @@ SubSystem::getStaticPower() const
     return ret;
 }
 
+double
+SubSystem::getPower() const
+{
+    double ret = 0.0f;
+    for (auto &obj: powerProducers) {
+        double dyn, st;
+        obj->getPower(dyn, st);
+        ret += dyn + st;
+    }
+    return ret;
+}
+
 SubSystem *
 SubSystemParams::create()
 {
@@ -67,6 +67,9 @@ class SubSystem : public SimObject
 
     double getStaticPower() const;
 
+    /** Total (dynamic + static) power of all the power producers */
+    double getPower() const;
+
     void registerPowerProducer(PowerModel *pm) {
         powerProducers.push_back(pm);
     }
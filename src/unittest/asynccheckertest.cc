@@ -0,0 +1,100 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/async_checker.hh"
+#include "base/cprintf.hh"
+#include "unittest/unittest.hh"
+
+struct Access
+{
+    uint64_t addr;
+    uint8_t data;
+    bool write;
+};
+
+// Reference model sharded by worker, as a memory tester would use it
+std::vector<std::unordered_map<uint64_t, uint8_t>> reference;
+
+std::string
+check(unsigned shard, const Access &access)
+{
+    if (access.write) {
+        reference[shard][access.addr] = access.data;
+        return "";
+    }
+
+    const uint8_t expected = reference[shard][access.addr];
+    if (access.data != expected) {
+        return csprintf("read of %#x returns %#x, expected %#x", access.addr,
+                        access.data, expected);
+    }
+    return "";
+}
+
+int
+main(int argc, char *argv[])
+{
+    const unsigned num_shards = 4;
+
+    UnitTest::setCase("In order checks of each key");
+    {
+        reference.assign(num_shards, {});
+        // A small ring makes the producer wait for the workers
+        AsyncChecker<Access> checker(num_shards, check, 8);
+        EXPECT_EQ(checker.numShards(), num_shards);
+
+        for (unsigned i = 0; i < 10000; ++i) {
+            const uint64_t addr = i % 64;
+            const uint8_t data = i;
+            checker.push(addr, Access{addr, data, true});
+            checker.push(addr, Access{addr, data, false});
+        }
+        checker.flush();
+        EXPECT_FALSE(checker.failed());
+    }
+
+    UnitTest::setCase("First mismatch is reported");
+    {
+        reference.assign(num_shards, {});
+        AsyncChecker<Access> checker(num_shards, check);
+
+        checker.push(0x10, Access{0x10, 0x5, true});
+        checker.push(0x10, Access{0x10, 0x6, false});
+        checker.flush();
+        EXPECT_TRUE(checker.failed());
+        EXPECT_EQ(checker.error(), "read of 0x10 returns 0x6, expected 0x5");
+
+        // Later mismatches do not replace the first one
+        checker.push(0x20, Access{0x20, 0x1, false});
+        checker.flush();
+        EXPECT_EQ(checker.error(), "read of 0x10 returns 0x6, expected 0x5");
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,84 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sim/mathexpr.hh"
+#include "unittest/unittest.hh"
+
+const char *exprs[] = {
+    "1 + 2 * 3",
+    "(1 + 2) * 3",
+    "a - b - c",
+    "a / b / c",
+    "-a + b",
+    "2 ^ 3 ^ 2",
+    "a * (b + -c) / 2.5",
+    "1e-3 * a + b.c\\d",
+};
+
+int
+main(int argc, char *argv[])
+{
+    std::map<std::string, double> values {
+        {"a", 3.0}, {"b", -2.0}, {"c", 0.5}, {"b.c\\d", 7.0}
+    };
+
+    UnitTest::setCase("Compiled evaluation matches the expression tree");
+    for (auto e : exprs) {
+        MathExpr expr(e);
+
+        // Variables are resolved to indices in order of appearance
+        std::map<std::string, unsigned> index;
+        std::vector<double> vars;
+        expr.compile([&](std::string name) {
+            auto it = index.find(name);
+            if (it != index.end())
+                return it->second;
+            vars.push_back(values.at(name));
+            return index[name] = vars.size() - 1;
+        });
+        EXPECT_TRUE(expr.compiled());
+
+        const double tree = expr.eval([&](std::string name) {
+            return values.at(name);
+        });
+        EXPECT_EQ(expr.evalCompiled(vars.data()), tree);
+    }
+
+    UnitTest::setCase("Compiled values");
+    {
+        MathExpr expr("x * x - 1");
+        expr.compile([](std::string name) { return 0; });
+        double x = 4;
+        EXPECT_EQ(expr.evalCompiled(&x), 15);
+        x = -1;
+        EXPECT_EQ(expr.evalCompiled(&x), 0);
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,219 @@
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Numeric comparison of gem5 stat files.
+
+The stat differ parses a stats.txt file into one dictionary per stat
+dump and compares values numerically rather than textually. Each stat
+can be given a relative and absolute tolerance. The default tolerance
+is zero, i.e., the comparison is exact, which matches the behavior of
+the diff-out script.
+
+"""
+
+import math
+import re
+
+# Stats that describe the host rather than the simulated system. These
+# differ between every run and are never compared.
+default_ignore = (
+    re.compile(r"^host_"),
+)
+
+_dump_begin = re.compile(r"^-+ Begin Simulation Statistics +-+")
+_dump_end = re.compile(r"^-+ End Simulation Statistics +-+")
+
+def _parse_value(value):
+    try:
+        return float(value)
+    except ValueError:
+        # Stats such as 'no_value' for empty distributions
+        return value
+
+def parse_stats(fname):
+    """Parse a stat file into a list of dumps.
+
+    Each dump is a dictionary mapping a stat name to its first value,
+    which is the count for distribution buckets. Values are floats
+    unless the stat couldn't be converted to a number.
+
+    """
+
+    dumps = []
+    dump = None
+    with open(fname, "r") as f:
+        for line in f:
+            if _dump_begin.match(line):
+                dump = {}
+                dumps.append(dump)
+                continue
+            elif _dump_end.match(line):
+                dump = None
+                continue
+            elif dump is None:
+                continue
+
+            fields = line.split("#", 1)[0].split()
+            if len(fields) < 2:
+                continue
+
+            dump[fields[0]] = _parse_value(fields[1])
+
+    return dumps
+
+class StatChange(object):
+    """A stat that differs between the reference and the output"""
+
+    def __init__(self, dump, name, ref, out):
+        self.dump = dump
+        self.name = name
+        self.ref = ref
+        self.out = out
+
+    def numeric(self):
+        return isinstance(self.ref, float) and isinstance(self.out, float)
+
+    def delta(self):
+        return self.out - self.ref if self.numeric() else float("nan")
+
+    def rel_delta(self):
+        if not self.numeric():
+            return float("nan")
+        elif self.ref == 0:
+            return float("inf")
+        else:
+            return self.delta() / abs(self.ref)
+
+    def __str__(self):
+        if self.numeric():
+            return "%-50s %16g %16g %+9.2f%%" % (
+                self.name, self.ref, self.out, self.rel_delta() * 100)
+        else:
+            return "%-50s %16s %16s" % (self.name, self.ref, self.out)
+
+class StatDiffResult(object):
+    def __init__(self, ref_dumps, out_dumps):
+        self.ref_dumps = len(ref_dumps)
+        self.out_dumps = len(out_dumps)
+        self.changed = []
+        self.missing = []
+        self.added = []
+
+    def __nonzero__(self):
+        return self.ref_dumps == self.out_dumps and \
+            not (self.changed or self.missing or self.added)
+
+    def report(self, max_changes=30):
+        """Generate a human-readable summary of the differences"""
+
+        if self:
+            return "-- ref/stats.txt and out/stats.txt match --\n"
+
+        lines = []
+        if self.ref_dumps != self.out_dumps:
+            lines.append("Number of stat dumps differ: ref %i, out %i" % (
+                self.ref_dumps, self.out_dumps))
+
+        if self.changed:
+            # The largest relative differences are the most likely to
+            # point at the cause of the mismatch
+            changed = sorted(self.changed,
+                             key=lambda c: abs(c.rel_delta()),
+                             reverse=True)
+            lines.append("%i statistics differ:" % len(changed))
+            lines.append("%-50s %16s %16s %10s" % (
+                "Name", "Reference", "Output", "Delta"))
+            last_dump = None
+            for c in changed[:max_changes]:
+                if c.dump != last_dump and self.ref_dumps > 1:
+                    lines.append("[dump %i]" % c.dump)
+                    last_dump = c.dump
+                lines.append(str(c))
+            if len(changed) > max_changes:
+                lines.append("(%i more)" % (len(changed) - max_changes))
+
+        for title, stats in (("Missing statistics", self.missing),
+                             ("Added statistics", self.added)):
+            if stats:
+                lines.append("%s:" % title)
+                lines += [ "  [dump %i] %s" % s for s in stats ]
+
+        return "\n".join(lines) + "\n"
+
+class StatDiff(object):
+    """Compare stat dumps using per-stat tolerances.
+
+    A stat matches if |out - ref| <= max(abs_tol, rel_tol * |ref|).
+    Tolerances for individual stats can be overridden by passing a
+    list of (regex, rel_tol, abs_tol) tuples; the first matching regex
+    wins.
+
+    """
+
+    def __init__(self, rel_tol=0.0, abs_tol=0.0, overrides=(),
+                 ignore=default_ignore):
+        self.rel_tol = rel_tol
+        self.abs_tol = abs_tol
+        self.overrides = [ (re.compile(r), rt, at) for r, rt, at in overrides ]
+        self.ignore = ignore
+
+    def ignored(self, name):
+        return any(r.match(name) for r in self.ignore)
+
+    def tolerance(self, name):
+        for rex, rel_tol, abs_tol in self.overrides:
+            if rex.match(name):
+                return rel_tol, abs_tol
+
+        return self.rel_tol, self.abs_tol
+
+    def equal(self, name, ref, out):
+        if not isinstance(ref, float) or not isinstance(out, float):
+            return ref == out
+        elif math.isnan(ref) or math.isnan(out):
+            return math.isnan(ref) and math.isnan(out)
+        elif ref == out:
+            return True
+
+        rel_tol, abs_tol = self.tolerance(name)
+        return abs(out - ref) <= max(abs_tol, rel_tol * abs(ref))
+
+    def diff(self, ref_dumps, out_dumps):
+        result = StatDiffResult(ref_dumps, out_dumps)
+        for dump, (ref, out) in enumerate(zip(ref_dumps, out_dumps)):
+            for name in sorted(ref):
+                if self.ignored(name):
+                    continue
+                elif name not in out:
+                    result.missing.append((dump, name))
+                elif not self.equal(name, ref[name], out[name]):
+                    result.changed.append(
+                        StatChange(dump, name, ref[name], out[name]))
+
+            result.added += [ (dump, name) for name in sorted(out)
+                              if name not in ref and not self.ignored(name) ]
+
+        return result
+
+    def diff_files(self, ref_file, out_file):
+        return self.diff(parse_stats(ref_file), parse_stats(out_file))
@@ -38,7 +38,9 @@
 # Authors: Andreas Sandberg
 
 from abc import ABCMeta, abstractmethod
+import hashlib
 import os
+import re
 from collections import namedtuple
 from units import *
 from results import TestResult
@@ -164,6 +166,50 @@ generic_configs = (
 all_categories = ("quick", "long")
 all_modes = ("fs", "se")
 
+_digest_cache = {}
+
+def file_digest(path):
+    """SHA1 of a file's contents.
+
+    Digests are memoized on (path, size, mtime) since the gem5 binary
+    is hashed once per test. Runners that fork workers should hash the
+    binary before forking to share the result.
+
+    """
+
+    st = os.stat(path)
+    key = (os.path.abspath(path), st.st_size, st.st_mtime)
+    if key not in _digest_cache:
+        h = hashlib.sha1()
+        with open(path, "rb") as f:
+            for block in iter(lambda: f.read(1 << 20), b""):
+                h.update(block)
+        _digest_cache[key] = h.hexdigest()
+
+    return _digest_cache[key]
+
+def _tree_files(top, rex=None):
+    for root, dirs, files in os.walk(top):
+        dirs.sort()
+        for f in sorted(files):
+            if rex is None or rex.search(f):
+                yield os.path.join(root, f)
+
+def _system_files():
+    """Kernels and disk images full system configs may load
+
+    Mirrors the search path of configs/common/SysPaths.py.
+
+    """
+
+    path = os.environ.get("M5_PATH",
+                          "/dist/m5/system:/n/poolfs/z/dist/m5/system")
+    for p in path.split(":"):
+        p = os.path.expanduser(p)
+        for sub in ("binaries", "disks"):
+            for f in _tree_files(os.path.join(p, sub)):
+                yield f
+
 class Test(object):
     """Test case base class.
 
@@ -245,7 +291,8 @@ class ClassicTest(Test):
 
     def __init__(self, gem5, output_dir, config_tuple,
                  timeout=None,
-                 skip=False, skip_diff_out=False, skip_diff_stat=False):
+                 skip=False, skip_diff_out=False, skip_diff_stat=False,
+                 cache_dir=None, stat_rel_tol=0.0, stat_abs_tol=0.0):
 
         super(ClassicTest, self).__init__("/".join(config_tuple))
 
@@ -263,6 +310,54 @@ class ClassicTest(Test):
         self.skip_run = skip
         self.skip_diff_out = skip or skip_diff_out
         self.skip_diff_stat = skip or skip_diff_stat
+        self.cache_dir = cache_dir
+        self.stat_rel_tol = stat_rel_tol
+        self.stat_abs_tol = stat_abs_tol
+
+    def input_files(self):
+        """Files, other than gem5 itself, that affect the output of a run"""
+
+        ct = self.config_tuple
+        yield self.script
+        yield os.path.join(_test_base, ct.category, ct.mode, ct.workload,
+                           "test.py")
+
+        py = re.compile(r"\.py$")
+        for f in _tree_files(os.path.join(_test_base, "configs"), py):
+            yield f
+        for f in _tree_files(os.path.join(_test_base, "..", "configs"), py):
+            yield f
+
+        # Workload binaries and inputs (see binpath() in run.py)
+        test_progs = os.environ.get("M5_TEST_PROGS",
+                                    "/dist/m5/regression/test-progs")
+        if not os.path.isdir(test_progs):
+            test_progs = os.path.join(_test_base, "test-progs")
+        app = re.sub(r"^\d+\.", "", ct.workload)
+        for f in _tree_files(os.path.join(test_progs, app)):
+            yield f
+
+    def cache_key(self):
+        """Key identifying the output of the run phase of this test"""
+
+        h = hashlib.sha1()
+        h.update(file_digest(self.gem5))
+        h.update("/".join(self.config_tuple))
+        h.update(os.environ.get("M5_PATH", ""))
+        for f in self.input_files():
+            if os.path.isfile(f):
+                h.update(os.path.relpath(f, _test_base))
+                h.update(file_digest(f))
+
+        # Disk images are too large to hash for every test, a replaced
+        # image or kernel shows up in its size and modification time
+        if self.config_tuple.mode == "fs":
+            for f in _system_files():
+                if os.path.isfile(f):
+                    st = os.stat(f)
+                    h.update("%s %d %r" % (f, st.st_size, st.st_mtime))
+
+        return h.hexdigest()
 
     def ref_files(self):
         ref_dir = os.path.abspath(self.ref_dir)
@@ -278,10 +373,15 @@ class ClassicTest(Test):
             "/".join(self.config_tuple),
         ]
 
+        cache_key = None
+        if self.cache_dir and not self.skip_run:
+            cache_key = self.cache_key()
+
         return [
             RunGem5(self.gem5, args,
                     ref_dir=self.ref_dir, test_dir=self.output_dir,
-                    skip=self.skip_run),
+                    skip=self.skip_run,
+                    cache_dir=self.cache_dir, cache_key=cache_key),
         ]
 
     def verify_units(self):
@@ -290,7 +390,9 @@ class ClassicTest(Test):
         if "stats.txt" in ref_files:
             units.append(
                 DiffStatFile(ref_dir=self.ref_dir, test_dir=self.output_dir,
-                             skip=self.skip_diff_stat))
+                             skip=self.skip_diff_stat,
+                             rel_tol=self.stat_rel_tol,
+                             abs_tol=self.stat_abs_tol))
         units += [
             DiffOutFile(f,
                         ref_dir=self.ref_dir, test_dir=self.output_dir,
@@ -43,12 +43,14 @@ import difflib
 import functools
 import os
 import re
+import shutil
 import subprocess
 import sys
 import traceback
 
 from results import UnitResult
 from helpers import *
+from statdiff import StatDiff
 
 _test_base = os.path.join(os.path.dirname(__file__), "..")
 
@@ -134,15 +136,59 @@ class RunGem5(TestUnit):
     Possible non-failure results:
        - exit code == 0 -> STATE_OK
        - exit code == 2 -> STATE_SKIPPED
+
+    If a cache directory and key are provided, the output directory of
+    a successful run is stored in the cache under the key. A later run
+    with the same key restores the cached output instead of running
+    gem5. The key must cover everything the output depends on (see
+    ClassicTest.cache_key()).
     """
 
-    def __init__(self, gem5, gem5_args, timeout=0, **kwargs):
+    def __init__(self, gem5, gem5_args, timeout=0,
+                 cache_dir=None, cache_key=None, **kwargs):
         super(RunGem5, self).__init__("gem5", **kwargs)
         self.gem5 = gem5
         self.args = gem5_args
         self.timeout = timeout
+        self.cache_entry = os.path.join(cache_dir, cache_key) \
+                           if cache_dir and cache_key else None
+
+    @staticmethod
+    def _copy_files(src, dst):
+        for root, dirs, files in os.walk(src):
+            out_root = os.path.join(dst, os.path.relpath(root, src))
+            if not os.path.isdir(out_root):
+                os.makedirs(out_root)
+            for f in files:
+                shutil.copy2(os.path.join(root, f), out_root)
+
+    def _store(self):
+        # Populate a private directory first and rename it into place
+        # so that concurrent runners never see a partial entry.
+        tmp = "%s.tmp%i" % (self.cache_entry, os.getpid())
+        shutil.rmtree(tmp, ignore_errors=True)
+        self._copy_files(self.test_dir, tmp)
+        try:
+            os.rename(tmp, self.cache_entry)
+        except OSError:
+            # Another runner stored the same entry first
+            shutil.rmtree(tmp, ignore_errors=True)
 
     def _run(self):
+        if self.cache_entry and os.path.isdir(self.cache_entry):
+            self._copy_files(self.cache_entry, self.test_dir)
+            return self.ok(
+                stdout="*** gem5 output restored from %s ***\n%s" % (
+                    self.cache_entry, self._read_output("simout")),
+                stderr=self._read_output("simerr"))
+
+        result = self._run_gem5()
+        if self.cache_entry and result.state == UnitResult.STATE_OK:
+            self._store()
+
+        return result
+
+    def _run_gem5(self):
         gem5_cmd = [
             self.gem5,
             "-d", self.test_dir,
@@ -261,30 +307,33 @@ class DiffOutFile(TestUnit):
                            % (fname, fname))
 
 class DiffStatFile(TestUnit):
-    """Test unit comparing two gem5 stat files."""
+    """Test unit comparing two gem5 stat files.
+
+    Stats are compared numerically (see statdiff.StatDiff). The
+    default tolerances are zero, which makes the comparison exact.
+
+    """
 
-    def __init__(self, **kwargs):
+    def __init__(self, rel_tol=0.0, abs_tol=0.0, **kwargs):
         super(DiffStatFile, self).__init__("stat_diff", **kwargs)
 
-        self.stat_diff = os.path.join(_test_base, "diff-out")
+        self.differ = StatDiff(rel_tol=rel_tol, abs_tol=abs_tol)
 
     def _run(self):
         stats = "stats.txt"
+        ref = self.ref_file(stats)
+        out = self.out_file(stats)
 
-        cmd = [
-            self.stat_diff,
-            self.ref_file(stats), self.out_file(stats),
-        ]
-        with ProcessHelper(cmd,
-                           stdout=subprocess.PIPE,
-                           stderr=subprocess.PIPE) as p:
-            status, stdout, stderr = p.call()
+        if not os.path.exists(ref):
+            return self.error("%s doesn't exist in reference directory" \
+                              % stats)
 
-        if status == 0:
-            return self.ok(stdout=stdout, stderr=stderr)
-        if status == 1:
-            return self.failure("Statistics mismatch",
-                                stdout=stdout, stderr=stderr)
+        if not os.path.exists(out):
+            return self.error("%s doesn't exist in output directory" % stats)
+
+        result = self.differ.diff_files(ref, out)
+        if result:
+            return self.ok(stdout=result.report())
         else:
-            return self.error("diff-out returned an error: %i" % status,
-                              stdout=stdout, stderr=stderr)
+            return self.failure("Statistics mismatch",
+                                stdout=result.report())
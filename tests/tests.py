@@ -38,6 +38,7 @@
 # Authors: Andreas Sandberg
 
 import argparse
+import multiprocessing
 import sys
 import os
 import pickle
@@ -147,6 +148,12 @@ def _run_tests_args(subparsers):
         (e.g., "tests.py list arm/quick" or one of the scons test list
         targets (e.g., "scons build/ARM/tests/opt/quick.list").
 
+        Tests are run in parallel using one worker per host core by
+        default. When a cache directory is specified, the output of a
+        gem5 run is stored in the cache and reused by later runs with
+        the same gem5 binary, configuration scripts, and workload
+        inputs. Output verification is never cached.
+
         The test results can be stored in multiple different output
         formats. See the help for the show command for more details
         about output formatting.""")
@@ -171,14 +178,40 @@ def _run_tests_args(subparsers):
     parser.add_argument("--skip-diff-stat", action="store_true",
                         help="Skip stat diffing stage")
 
+    parser.add_argument("--jobs", "-j",
+                        type=int, default=multiprocessing.cpu_count(),
+                        help="Number of tests to run in parallel")
+
+    parser.add_argument("--cache", type=str, default=None, metavar="DIR",
+                        help="Reuse gem5 outputs stored in DIR")
+
+    parser.add_argument("--stat-rel-tol", type=float, default=0.0,
+                        metavar="TOL",
+                        help="Relative tolerance when comparing stats")
+
+    parser.add_argument("--stat-abs-tol", type=float, default=0.0,
+                        metavar="TOL",
+                        help="Absolute tolerance when comparing stats")
+
     _add_format_args(parser)
 
+def _run_test(job):
+    testno, test = job
+    return testno, test.run()
+
 def _run_tests(args):
     formatter = _create_formatter(args)
 
     out_base = os.path.abspath(args.directory)
     if not os.path.exists(out_base):
         os.mkdir(out_base)
+    cache_dir = os.path.abspath(args.cache) if args.cache else None
+    if cache_dir:
+        if not os.path.exists(cache_dir):
+            os.makedirs(cache_dir)
+        # Hash the binary once here rather than in every worker
+        file_digest(args.gem5)
+
     tests = []
     for test_name in args.test:
         config = ClassicConfig(*test_name.split("/"))
@@ -187,14 +220,28 @@ def _run_tests(args):
             ClassicTest(args.gem5, out_dir, config,
                         timeout=args.timeout,
                         skip_diff_stat=args.skip_diff_stat,
-                        skip_diff_out=args.skip_diff_out))
+                        skip_diff_out=args.skip_diff_out,
+                        cache_dir=cache_dir,
+                        stat_rel_tol=args.stat_rel_tol,
+                        stat_abs_tol=args.stat_abs_tol))
+
+    all_results = [ None ] * len(tests)
+    jobs = max(1, min(args.jobs, len(tests)))
+    print "Running %i tests using %i jobs" % (len(tests), jobs)
+    if jobs == 1:
+        results = ( _run_test(j) for j in enumerate(tests) )
+    else:
+        pool = multiprocessing.Pool(jobs)
+        results = pool.imap_unordered(_run_test, enumerate(tests))
 
-    all_results = []
-    print "Running %i tests" % len(tests)
-    for testno, test in enumerate(tests):
-        print "%i: Running '%s'..." % (testno, test)
+    for done, (testno, result) in enumerate(results):
+        print "[%i/%i] %s: %s" % (done + 1, len(tests), tests[testno],
+                                  "OK" if result else "FAILED")
+        all_results[testno] = result
 
-        all_results.append(test.run())
+    if jobs > 1:
+        pool.close()
+        pool.join()
 
     formatter.dump_suites(all_results)
 
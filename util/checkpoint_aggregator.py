@@ -34,6 +34,8 @@ import gzip
 
 import sys, re, os
 
+from cpt_binary import expand_binary_arrays
+
 class myCP(ConfigParser):
     def __init__(self):
         ConfigParser.__init__(self)
@@ -63,6 +65,7 @@ def aggregate(output_dir, cpts, no_compress, memory_size):
         merged_config = myCP()
         config = myCP()
         config.readfp(open(cpts[i] + "/m5.cpt"))
+        expand_binary_arrays(config, cpts[i])
 
         for sec in config.sections():
             if re.compile("cpu").search(sec):
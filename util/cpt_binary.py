@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Checkpoints store large arrays of numbers in a binary side file,
+# m5.cpt.bin, next to m5.cpt. The m5.cpt entry of such an array is
+# "@bin <offset> <count> <type>" where type is a struct module format
+# character. This module expands the references back into the text
+# form, for scripts that edit m5.cpt (cpt_upgrader.py,
+# checkpoint_aggregator.py), and can be run to convert a checkpoint
+# to text only:
+#
+#   cpt_binary.py <checkpoint directory>
+
+import ConfigParser
+import os.path as osp
+import struct
+import sys
+
+BIN_FILENAME = 'm5.cpt.bin'
+MAGIC = 'M5CPTBIN'
+
+def expand_binary_arrays(cpt, cpt_dir):
+    """Replace the binary array references of the ConfigParser cpt, read
+    from cpt_dir, by their values. Returns the number of arrays
+    expanded."""
+    path = osp.join(cpt_dir, BIN_FILENAME)
+    if not osp.isfile(path):
+        return 0
+
+    data = open(path, 'rb').read()
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("%s isn't a binary checkpoint file" % path)
+
+    # The byte order mark is 0x01020304 in the writer's byte order
+    order = '<' if data[8:12] == '\x04\x03\x02\x01' else '>'
+
+    expanded = 0
+    for sec in cpt.sections():
+        for name, value in cpt.items(sec, raw=True):
+            if not value.startswith('@bin '):
+                continue
+            offset, count, type = value.split()[1:]
+            values = struct.unpack_from('%s%d%s' % (order, int(count), type),
+                                        data, int(offset))
+            cpt.set(sec, name, ' '.join(repr(v) if type in 'fd' else str(v)
+                                        for v in values))
+            expanded += 1
+    return expanded
+
+if __name__ == '__main__':
+    if len(sys.argv) != 2:
+        print "usage: %s <checkpoint directory>" % sys.argv[0]
+        sys.exit(1)
+
+    cpt_dir = sys.argv[1]
+    cpt_file = osp.join(cpt_dir, 'm5.cpt')
+
+    cpt = ConfigParser.SafeConfigParser()
+    cpt.optionxform = str
+    cpt.readfp(open(cpt_file, 'r'))
+
+    print "expanded %d arrays" % expand_binary_arrays(cpt, cpt_dir)
+    cpt.write(open(cpt_file, 'w'))
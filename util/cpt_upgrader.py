@@ -62,6 +62,8 @@ import ConfigParser
 import glob, types, sys, os
 import os.path as osp
 
+from cpt_binary import expand_binary_arrays
+
 verbose_print = False
 
 def verboseprint(*args):
@@ -180,6 +182,12 @@ def process_file(path, **kwargs):
 
     # Apply migrations for tags not in checkpoint, respecting dependences
     to_apply = Upgrader.tag_set - tags
+
+    # Upgraders work on the text form of arrays
+    if to_apply and expand_binary_arrays(cpt, osp.dirname(path)):
+        verboseprint("expanded binary arrays")
+        change = True
+
     while to_apply:
         ready = set([ t for t in to_apply if Upgrader.get(t).ready(tags) ])
         if not ready:
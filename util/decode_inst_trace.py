@@ -44,10 +44,67 @@
 # be done manually using:
 # protoc --python_out=. inst.proto
 # The ASCII trace format uses one line per request.
+# Raw traces (InstPBTrace format='raw') are decoded without protobuf.
 
 import protolib
+import struct
 import sys
 
+# Raw trace magic numbers, see src/cpu/inst_pb_trace.hh
+raw_file_magic = 'M5INSTR\0'
+raw_block_magic = 0x4b425449
+raw_byte_order = 0x01020304
+
+def decode_raw(raw_in, ascii_out):
+    """Decode the blocks of a raw trace after its file magic, returns the
+    number of instructions"""
+    order = None
+    for o in ('<', '>'):
+        version, mark = struct.unpack(o + 'II', raw_in.read(8))
+        if mark == raw_byte_order:
+            order = o
+            break
+        raw_in.seek(-8, 1)
+    if order is None or version != 1:
+        print "Unrecognized raw trace version or byte order"
+        exit(-1)
+
+    block_header = struct.Struct(order + 'IIQQII')
+    inst_rec = struct.Struct(order + 'QQIIBBH')
+    mem_rec = struct.Struct(order + 'QII')
+
+    num_insts = 0
+    while True:
+        header = raw_in.read(block_header.size)
+        if len(header) < block_header.size:
+            break
+        magic, size, first, last, records, _ = block_header.unpack(header)
+        if magic != raw_block_magic:
+            # The index follows the last block
+            break
+        data = raw_in.read(size)
+        if len(data) < size:
+            print "Truncated block, the trace is incomplete"
+            break
+
+        pos = 0
+        for i in range(records):
+            tick, pc, inst, cpu_id, op_class, flags, num_mem = \
+                inst_rec.unpack_from(data, pos)
+            pos += inst_rec.size
+            ascii_out.write('%-20d: (%03d/%03d) %#010x @ %#016x ' %
+                            (tick, 0, cpu_id, inst, pc))
+            ascii_out.write(' : %10s' %
+                inst_pb2._INST_INSTTYPE.values_by_number[op_class].name)
+            for j in range(num_mem):
+                addr, size, mem_flags = mem_rec.unpack_from(data, pos)
+                pos += mem_rec.size
+                ascii_out.write(" %#x-%#x;" % (addr, addr + size))
+            ascii_out.write('\n')
+            num_insts += 1
+
+    return num_insts
+
 # Import the packet proto definitions
 try:
     import inst_pb2
@@ -87,6 +144,15 @@ def main():
     # Read the magic number in 4-byte Little Endian
     magic_number = proto_in.read(4)
 
+    if magic_number + proto_in.read(4) == raw_file_magic:
+        print "Parsing raw instructions"
+        num_insts = decode_raw(proto_in, ascii_out)
+        print "Parsed instructions:", num_insts
+        ascii_out.close()
+        proto_in.close()
+        return
+    proto_in.seek(4)
+
     if magic_number != "gem5":
         print "Unrecognized file", sys.argv[1]
         exit(-1)
@@ -41,6 +41,7 @@ from colours import unknownColour
 from point import Point
 import re
 import blobs
+import trace_file
 from time import time as wall_time
 import os
 
@@ -759,84 +760,95 @@ class BlobModel(object):
         else:
             print 'Opening file', file
 
-        f = open(file)
-
-        start_wall_time = wall_time()
-
-        # Skip leading events
-        still_skipping = True
-        l = f.readline()
-        while l and still_skipping:
-            match = re.match('^\s*(\d+):', l)
-            if match is not None:
-                event_time = match.groups()
-                if int(event_time[0]) >= startTime:
-                    still_skipping = False
+        def text_records(f):
+            # Yield (time, unit, line type, rest) for the lines of a
+            #   text trace from startTime on, line type is None for
+            #   lines which aren't MinorTrace output
+            # Skip leading events
+            still_skipping = True
+            l = f.readline()
+            while l and still_skipping:
+                match = re.match('^\s*(\d+):', l)
+                if match is not None:
+                    event_time = match.groups()
+                    if int(event_time[0]) >= startTime:
+                        still_skipping = False
+                    else:
+                        l = f.readline()
                 else:
                     l = f.readline()
-            else:
+
+            match_line_re = re.compile(
+                '^\s*(\d+):\s*([\w\.]+):\s*(Minor\w+:)?\s*(.*)$')
+
+            while l:
+                match = match_line_re.match(l)
+                if match is not None:
+                    event_time, unit, line_type, rest = match.groups()
+                    yield int(event_time), unit, line_type, rest
                 l = f.readline()
 
-        match_line_re = re.compile(
-            '^\s*(\d+):\s*([\w\.]+):\s*(Minor\w+:)?\s*(.*)$')
+        start_wall_time = wall_time()
+
+        # Binary traces (MinorCPU.minorTraceFile) are indexed and only the
+        #   window to load is read
+        if trace_file.is_trace_file(file):
+            f = None
+            records = trace_file.read_records(file, startTime, endTime)
+        else:
+            f = open(file)
+            records = text_records(f)
 
         # Parse each line of the events file, accumulating comments to be
         #   attached to MinorTrace events when the time changes
-        reached_end_time = False
-        while not reached_end_time and l:
-            match = match_line_re.match(l)
-            if match is not None:
-                event_time, unit, line_type, rest = match.groups()
-                event_time = int(event_time)
-
-                unit = re.sub('^' + self.unitNamePrefix + '\.?(.*)$',
-                    '\\1', unit)
-
-                # When the time changes, resolve comments
-                if event_time != time:
-                    if self.numEvents > next_progress_print_event_count:
-                        print ('Parsed to time: %d' % event_time)
-                        next_progress_print_event_count = (
-                            self.numEvents + 1000)
-                    update_comments(comments, time)
-                    comments = []
-                    time = event_time
-
-                if line_type is None:
-                    # Treat this line as just a 'comment'
-                    comments.append((unit, rest))
-                elif line_type == 'MinorTrace:':
-                    minor_trace_line_count += 1
-
-                    # Only insert this event if it's not the same as
-                    #   the last event we saw for this unit
-                    if last_time_lines.get(unit, None) != rest:
-                        event = BlobEvent(unit, event_time, {})
-                        pairs = parse.parse_pairs(rest)
-                        event.pairs = pairs
-
-                        # Try to decode the colour data for this event
-                        blobs = self.unitNameToBlobs.get(unit, [])
-                        for blob in blobs:
-                            if blob.visualDecoder is not None:
-                                event.visuals[blob.picChar] = (
-                                    blob.visualDecoder(pairs))
-
-                        self.add_unit_event(event)
-                        last_time_lines[unit] = rest
-                elif line_type == 'MinorInst:':
-                    self.add_minor_inst(rest)
-                elif line_type == 'MinorLine:':
-                    self.add_minor_line(rest)
+        for event_time, unit, line_type, rest in records:
+            unit = re.sub('^' + self.unitNamePrefix + '\.?(.*)$',
+                '\\1', unit)
+
+            # When the time changes, resolve comments
+            if event_time != time:
+                if self.numEvents > next_progress_print_event_count:
+                    print ('Parsed to time: %d' % event_time)
+                    next_progress_print_event_count = (
+                        self.numEvents + 1000)
+                update_comments(comments, time)
+                comments = []
+                time = event_time
+
+            if line_type is None:
+                # Treat this line as just a 'comment'
+                comments.append((unit, rest))
+            elif line_type == 'MinorTrace:':
+                minor_trace_line_count += 1
+
+                # Only insert this event if it's not the same as
+                #   the last event we saw for this unit
+                if last_time_lines.get(unit, None) != rest:
+                    event = BlobEvent(unit, event_time, {})
+                    pairs = parse.parse_pairs(rest)
+                    event.pairs = pairs
+
+                    # Try to decode the colour data for this event
+                    blobs = self.unitNameToBlobs.get(unit, [])
+                    for blob in blobs:
+                        if blob.visualDecoder is not None:
+                            event.visuals[blob.picChar] = (
+                                blob.visualDecoder(pairs))
 
-            if endTime is not None and time > endTime:
-                reached_end_time = True
+                    self.add_unit_event(event)
+                    last_time_lines[unit] = rest
+            elif line_type == 'MinorInst:':
+                self.add_minor_inst(rest)
+            elif line_type == 'MinorLine:':
+                self.add_minor_line(rest)
 
-            l = f.readline()
+            if endTime is not None and time > endTime:
+                break
 
         update_comments(comments, time)
         self.extract_times()
-        f.close()
+        if f is not None:
+            f.close()
 
         end_wall_time = wall_time()
 
@@ -0,0 +1,206 @@
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Reader for the binary MinorTrace files written with
+MinorCPU.minorTraceFile (see src/cpu/minor/trace_file.hh for the
+format).  Only the blocks covering the requested window are read."""
+
+import struct
+import sys
+
+file_magic = b'M5MINTR\0'
+index_magic = b'M5MINIDX'
+block_magic = 0x4b42544d
+byte_order = 0x01020304
+
+# Record kinds and the debug output line types they stand for
+kind_unit_name = 0
+line_types = {1: 'MinorTrace:', 2: 'MinorInst:', 3: 'MinorLine:'}
+
+def is_trace_file(filename):
+    """Is filename a binary MinorTrace file?"""
+    with open(filename, 'rb') as f:
+        return f.read(len(file_magic)) == file_magic
+
+def read_header(f):
+    """Check the header and return the struct byte order prefix"""
+    if f.read(len(file_magic)) != file_magic:
+        raise IOError('not a binary MinorTrace file')
+    for order in ('<', '>'):
+        version, mark = struct.unpack(order + 'II', f.read(8))
+        if mark == byte_order:
+            if version != 1:
+                raise IOError('unknown MinorTrace file version %d' % version)
+            return order
+        f.seek(-8, 1)
+    raise IOError('bad MinorTrace file byte order mark')
+
+def read_index(f, order):
+    """Return the (first tick, last tick, offset) of each block, from
+    the index if the file has one and from the block headers if not"""
+    block_header = struct.Struct(order + 'IIQQII')
+
+    f.seek(0, 2)
+    end = f.tell()
+    if end >= 16:
+        f.seek(end - 16)
+        index_offset, magic = struct.unpack(order + 'Q8s', f.read(16))
+        if magic == index_magic:
+            f.seek(index_offset)
+            count, = struct.unpack(order + 'Q', f.read(8))
+            entry = struct.Struct(order + 'QQQ')
+            data = f.read(count * entry.size)
+            return [entry.unpack_from(data, i * entry.size)
+                for i in range(count)]
+
+    # No index, walk the block headers
+    blocks = []
+    offset = len(file_magic) + 8
+    while offset + block_header.size <= end:
+        f.seek(offset)
+        magic, size, first, last, records, _ = \
+            block_header.unpack(f.read(block_header.size))
+        if magic != block_magic or offset + block_header.size + size > end:
+            break
+        blocks.append((first, last, offset))
+        offset += block_header.size + size
+    return blocks
+
+def read_varint(data, pos):
+    """Decode a LEB128 varint, returns (value, next position)"""
+    value = 0
+    shift = 0
+    while True:
+        byte = ord(data[pos:pos + 1])
+        pos += 1
+        value |= (byte & 0x7f) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+def read_block(f, order, offset):
+    """Yield the (time, unit, line type, text) records of a block"""
+    block_header = struct.Struct(order + 'IIQQII')
+    f.seek(offset)
+    magic, size, time, last, records, _ = \
+        block_header.unpack(f.read(block_header.size))
+    if magic != block_magic:
+        raise IOError('bad MinorTrace block at offset %d' % offset)
+    data = f.read(size)
+
+    units = []
+    last_trace = []
+    pos = 0
+    for i in range(records):
+        delta, pos = read_varint(data, pos)
+        time += delta
+        kind = ord(data[pos:pos + 1])
+        pos += 1
+
+        if kind == kind_unit_name:
+            length, pos = read_varint(data, pos)
+            units.append(data[pos:pos + length].decode())
+            last_trace.append('')
+            pos += length
+            continue
+
+        unit, pos = read_varint(data, pos)
+        if kind == 1:
+            prefix, pos = read_varint(data, pos)
+            length, pos = read_varint(data, pos)
+            text = last_trace[unit][:prefix] + \
+                data[pos:pos + length].decode()
+            last_trace[unit] = text
+        else:
+            length, pos = read_varint(data, pos)
+            text = data[pos:pos + length].decode()
+        pos += length
+
+        yield time, units[unit], line_types[kind], text
+
+def read_records(filename, start_time=0, end_time=None):
+    """Yield the (time, unit, line type, text) records from start_time
+    to end_time like the MinorTrace debug output lines would give them.
+    The last MinorTrace state of each unit before start_time is given at
+    start_time, as the trace only records changes."""
+    with open(filename, 'rb') as f:
+        order = read_header(f)
+        blocks = read_index(f, order)
+
+        # Start from the last block beginning at or before start_time,
+        #   every unit's state is recorded afresh in it
+        first = 0
+        for i, (block_first, block_last, offset) in enumerate(blocks):
+            if block_first <= start_time:
+                first = i
+
+        # Last MinorTrace state of each unit before start_time and the
+        #   records at start_time, which take precedence over it
+        state = {}
+        at_start = []
+
+        def flush_start():
+            for unit, line_type, text in at_start:
+                if line_type == 'MinorTrace:':
+                    state.pop(unit, None)
+            for unit, text in sorted(state.items()):
+                yield start_time, unit, 'MinorTrace:', text
+            for unit, line_type, text in at_start:
+                yield start_time, unit, line_type, text
+
+        for block_first, block_last, offset in blocks[first:]:
+            if end_time is not None and block_first > end_time:
+                break
+            for time, unit, line_type, text in \
+                read_block(f, order, offset):
+                if time < start_time:
+                    if line_type == 'MinorTrace:':
+                        state[unit] = text
+                elif time == start_time:
+                    at_start.append((unit, line_type, text))
+                elif end_time is not None and time > end_time:
+                    break
+                else:
+                    if state is not None:
+                        for record in flush_start():
+                            yield record
+                        state = None
+                    yield time, unit, line_type, text
+            else:
+                continue
+            break
+
+        if state is not None:
+            for record in flush_start():
+                yield record
+
+if __name__ == '__main__':
+    # Print a window of a binary trace as MinorTrace debug output
+    if len(sys.argv) < 2:
+        print('usage: trace_file.py <trace file> [start time [end time]]')
+        sys.exit(1)
+    start = int(sys.argv[2]) if len(sys.argv) > 2 else 0
+    end = int(sys.argv[3]) if len(sys.argv) > 3 else None
+    for time, unit, line_type, text in \
+        read_records(sys.argv[1], start, end):
+        print('%d: %s: %s %s' % (time, unit, line_type, text))
@@ -44,6 +44,8 @@ import os
 import sys
 import copy
 
+import o3_pipeview_file
+
 # Temporary storage for instructions. The queue is filled in out-of-order
 # until it reaches 'max_threshold' number of instructions. It is then
 # sorted out and instructions are printed out until their number drops to
@@ -131,7 +133,7 @@ def process_trace(trace, outfile, cycle_time, width, color, timestamps,
             if fields[1] == 'fetch':
                 if ((stop_tick > 0 and int(fields[2]) > stop_tick+insts['tick_drift']) or
                     (stop_sn > 0 and int(fields[5]) > (stop_sn+insts['max_threshold']))):
-                    print_insts(outfile, cycle_time, width, color, timestamps, 0)
+                    print_insts(outfile, cycle_time, width, color, timestamps, store_completions, 0)
                     return
                 (curr_inst['pc'], curr_inst['upc']) = fields[3:5]
                 curr_inst['sn'] = int(fields[5])
@@ -361,12 +363,17 @@ def main():
         sys.exit(1)
     # Process trace
     print 'Processing trace... ',
-    with open(args[0], 'r') as trace:
-        with open(options.outfile, 'w') as out:
-            process_trace(trace, out, options.cycle_time, options.width,
-                          options.color, options.timestamps,
-                          options.only_committed, options.store_completions,
-                          *(tick_range + inst_range))
+    if o3_pipeview_file.is_pipeview_file(args[0]):
+        # Binary trace from DerivO3CPU.pipeViewFile, read from the first
+        # tick on
+        trace = o3_pipeview_file.TextTrace(args[0], tick_range[0])
+    else:
+        trace = open(args[0], 'r')
+    with open(options.outfile, 'w') as out:
+        process_trace(trace, out, options.cycle_time, options.width,
+                      options.color, options.timestamps,
+                      options.only_committed, options.store_completions,
+                      *(tick_range + inst_range))
     print 'done!'
 
 
@@ -0,0 +1,202 @@
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Reader for the binary pipeline view files written with
+DerivO3CPU.pipeViewFile (see src/cpu/o3/pipeview_file.hh for the
+format), and converter to the O3PipeView debug output read by
+o3-pipeview.py.  Only the blocks from the requested tick on are read."""
+
+import struct
+import sys
+
+file_magic = b'M5O3PV\0\0'
+index_magic = b'M5O3PIDX'
+block_magic = 0x4b425650
+byte_order = 0x01020304
+
+# Stages recorded after fetch, in file order
+stages = ['decode', 'rename', 'dispatch', 'issue', 'complete', 'retire',
+    'store']
+
+def is_pipeview_file(filename):
+    """Is filename a binary pipeline view file?"""
+    with open(filename, 'rb') as f:
+        return f.read(len(file_magic)) == file_magic
+
+def read_header(f):
+    """Check the header and return the struct byte order prefix"""
+    if f.read(len(file_magic)) != file_magic:
+        raise IOError('not a binary pipeline view file')
+    for order in ('<', '>'):
+        version, mark = struct.unpack(order + 'II', f.read(8))
+        if mark == byte_order:
+            if version != 1:
+                raise IOError('unknown pipeline view file version %d' %
+                    version)
+            return order
+        f.seek(-8, 1)
+    raise IOError('bad pipeline view file byte order mark')
+
+def read_index(f, order):
+    """Return the (first tick, last tick, offset) of each block, from
+    the index if the file has one and from the block headers if not"""
+    block_header = struct.Struct(order + 'IIQQII')
+
+    f.seek(0, 2)
+    end = f.tell()
+    if end >= 16:
+        f.seek(end - 16)
+        index_offset, magic = struct.unpack(order + 'Q8s', f.read(16))
+        if magic == index_magic:
+            f.seek(index_offset)
+            count, = struct.unpack(order + 'Q', f.read(8))
+            entry = struct.Struct(order + 'QQQ')
+            data = f.read(count * entry.size)
+            return [entry.unpack_from(data, i * entry.size)
+                for i in range(count)]
+
+    # No index, walk the block headers
+    blocks = []
+    offset = len(file_magic) + 8
+    while offset + block_header.size <= end:
+        f.seek(offset)
+        magic, size, first, last, records, _ = \
+            block_header.unpack(f.read(block_header.size))
+        if magic != block_magic or offset + block_header.size + size > end:
+            break
+        blocks.append((first, last, offset))
+        offset += block_header.size + size
+    return blocks
+
+def read_varint(data, pos):
+    """Decode a LEB128 varint, returns (value, next position)"""
+    value = 0
+    shift = 0
+    while True:
+        byte = ord(data[pos:pos + 1])
+        pos += 1
+        value |= (byte & 0x7f) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+def read_block(f, order, offset):
+    """Yield (tick, inst) for the records of a block, inst being a dict
+    of the O3PipeView fields: the stage ticks (0 for stages which
+    weren't reached), 'pc', 'upc', 'sn' and 'disasm'"""
+    block_header = struct.Struct(order + 'IIQQII')
+    f.seek(offset)
+    magic, size, tick, last, records, _ = \
+        block_header.unpack(f.read(block_header.size))
+    if magic != block_magic:
+        raise IOError('bad pipeline view block at offset %d' % offset)
+    data = f.read(size)
+
+    disassembly = []
+    sn = 0
+    pos = 0
+    for i in range(records):
+        delta, pos = read_varint(data, pos)
+        tick += delta
+        since_fetch, pos = read_varint(data, pos)
+        sn_diff, pos = read_varint(data, pos)
+        sn += (sn_diff >> 1) ^ -(sn_diff & 1)
+
+        inst = {'fetch': tick - since_fetch, 'sn': sn}
+        inst['pc'], pos = read_varint(data, pos)
+        inst['upc'], pos = read_varint(data, pos)
+        for stage in stages:
+            value, pos = read_varint(data, pos)
+            inst[stage] = inst['fetch'] + value - 1 if value else 0
+
+        number, pos = read_varint(data, pos)
+        if number == len(disassembly):
+            length, pos = read_varint(data, pos)
+            disassembly.append(data[pos:pos + length].decode())
+            pos += length
+        inst['disasm'] = disassembly[number]
+
+        yield tick, inst
+
+def read_insts(filename, start_tick=0, stop_tick=None):
+    """Yield the instructions recorded from start_tick to stop_tick, in
+    the order they were recorded. Instructions are recorded when they
+    retire (stores when they complete), which is after they are
+    fetched, so instructions fetched from start_tick on all come from
+    here."""
+    with open(filename, 'rb') as f:
+        order = read_header(f)
+        for first, last, offset in read_index(f, order):
+            if last < start_tick:
+                continue
+            if stop_tick is not None and first > stop_tick:
+                break
+            for tick, inst in read_block(f, order, offset):
+                if tick < start_tick:
+                    continue
+                if stop_tick is not None and tick > stop_tick:
+                    return
+                yield inst
+
+def text_lines(inst):
+    """The O3PipeView debug output lines of an instruction"""
+    lines = ['O3PipeView:fetch:%d:0x%08x:%d:%d:%s\n' % (inst['fetch'],
+        inst['pc'], inst['upc'], inst['sn'], inst['disasm'])]
+    for stage in stages[:-2]:
+        lines.append('O3PipeView:%s:%d\n' % (stage, inst[stage]))
+    lines.append('O3PipeView:retire:%d:store:%d\n' %
+        (inst['retire'], inst['store']))
+    return lines
+
+class TextTrace(object):
+    """File-like object giving the O3PipeView debug output lines of the
+    instructions from read_insts"""
+    def __init__(self, filename, start_tick=0, stop_tick=None):
+        self.insts = read_insts(filename, start_tick, stop_tick)
+        self.lines = []
+
+    def readline(self):
+        while not self.lines:
+            inst = next(self.insts, None)
+            if inst is None:
+                return ''
+            self.lines = text_lines(inst)
+            self.lines.reverse()
+        return self.lines.pop()
+
+if __name__ == '__main__':
+    # Convert a binary pipeline view file to O3PipeView debug output.
+    #   Instructions are read until drift ticks after the stop tick to
+    #   catch those fetched before it but recorded later
+    if len(sys.argv) < 2:
+        print('usage: o3_pipeview_file.py <pipeview file> '
+            '[start tick [stop tick [drift ticks]]]')
+        sys.exit(1)
+    start = int(sys.argv[2]) if len(sys.argv) > 2 else 0
+    stop = int(sys.argv[3]) if len(sys.argv) > 3 else None
+    drift = int(sys.argv[4]) if len(sys.argv) > 4 else 2000000
+    for inst in read_insts(sys.argv[1], start,
+        stop + drift if stop is not None else None):
+        if inst['fetch'] >= start and (stop is None or
+            inst['fetch'] <= stop):
+            sys.stdout.writelines(text_lines(inst))